@@ -0,0 +1,96 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "aabb.hpp"
+
+#include <limits>
+
+AABB
+AABB::infinite()
+{
+  AABB aabb;
+  aabb.m_infinite = true;
+  return aabb;
+}
+
+AABB
+AABB::from_points(const glm::vec3* points, size_t count)
+{
+  AABB aabb;
+  for(size_t i = 0; i < count; ++i)
+  {
+    aabb.extend(points[i]);
+  }
+  return aabb;
+}
+
+AABB::AABB() :
+  m_min(std::numeric_limits<float>::max()),
+  m_max(-std::numeric_limits<float>::max()),
+  m_infinite(false)
+{
+}
+
+AABB::AABB(const glm::vec3& min, const glm::vec3& max) :
+  m_min(min),
+  m_max(max),
+  m_infinite(false)
+{
+}
+
+void
+AABB::extend(const glm::vec3& p)
+{
+  m_min = glm::min(m_min, p);
+  m_max = glm::max(m_max, p);
+}
+
+void
+AABB::extend(const AABB& rhs)
+{
+  if (rhs.m_infinite)
+  {
+    m_infinite = true;
+  }
+  else if (!rhs.is_empty())
+  {
+    m_min = glm::min(m_min, rhs.m_min);
+    m_max = glm::max(m_max, rhs.m_max);
+  }
+}
+
+AABB
+AABB::transform(const glm::mat4& m) const
+{
+  if (m_infinite || is_empty())
+  {
+    return *this;
+  }
+  else
+  {
+    // transform the center and project the extent onto the new axes,
+    // cheaper than transforming all eight corners
+    glm::vec3 center(m * glm::vec4(get_center(), 1.0f));
+    glm::vec3 extent = get_extent();
+    glm::vec3 new_extent(glm::abs(m[0][0]) * extent.x + glm::abs(m[1][0]) * extent.y + glm::abs(m[2][0]) * extent.z,
+                         glm::abs(m[0][1]) * extent.x + glm::abs(m[1][1]) * extent.y + glm::abs(m[2][1]) * extent.z,
+                         glm::abs(m[0][2]) * extent.x + glm::abs(m[1][2]) * extent.y + glm::abs(m[2][2]) * extent.z);
+    return AABB(center - new_extent, center + new_extent);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,63 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_AABB_HPP
+#define HEADER_AABB_HPP
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <stddef.h>
+
+/** Axis aligned bounding box. A default constructed box is empty and
+    contains nothing, infinite() contains everything and is what
+    objects with unknown extent use, so they never get culled. */
+class AABB
+{
+private:
+  glm::vec3 m_min;
+  glm::vec3 m_max;
+  bool m_infinite;
+
+public:
+  static AABB infinite();
+  static AABB from_points(const glm::vec3* points, size_t count);
+
+  AABB();
+  AABB(const glm::vec3& min, const glm::vec3& max);
+
+  bool is_empty() const { return !m_infinite && (m_min.x > m_max.x || m_min.y > m_max.y || m_min.z > m_max.z); }
+  bool is_infinite() const { return m_infinite; }
+
+  const glm::vec3& get_min() const { return m_min; }
+  const glm::vec3& get_max() const { return m_max; }
+
+  glm::vec3 get_center() const { return (m_min + m_max) * 0.5f; }
+  glm::vec3 get_extent() const { return (m_max - m_min) * 0.5f; }
+
+  /** Radius of the sphere around get_center() enclosing the box */
+  float get_radius() const { return glm::length(get_extent()); }
+
+  void extend(const glm::vec3& p);
+  void extend(const AABB& rhs);
+
+  /** Box enclosing this box after transforming it with \a m */
+  AABB transform(const glm::mat4& m) const;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,277 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "scene_node.hpp"
+
+namespace {
+
+/** Slab test, returns the distance to the entry point or a negative
+    value when the ray misses the box */
+float intersect_ray(const AABB& aabb, const glm::vec3& origin, const glm::vec3& inv_direction)
+{
+  glm::vec3 t0 = (aabb.get_min() - origin) * inv_direction;
+  glm::vec3 t1 = (aabb.get_max() - origin) * inv_direction;
+  glm::vec3 tmin = glm::min(t0, t1);
+  glm::vec3 tmax = glm::max(t0, t1);
+
+  float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+  float leave = std::min(std::min(tmax.x, tmax.y), tmax.z);
+
+  if (enter <= leave)
+  {
+    return enter;
+  }
+  else
+  {
+    return -1.0f;
+  }
+}
+
+} // namespace
+
+BVH::BVH() :
+  m_nodes(),
+  m_items(),
+  m_unbounded()
+{
+}
+
+void
+BVH::build(SceneNode* root)
+{
+  m_nodes.clear();
+  m_items.clear();
+  m_unbounded.clear();
+
+  collect(root);
+
+  if (!m_items.empty())
+  {
+    m_nodes.reserve(2 * m_items.size() / s_max_leaf_items + 1);
+    m_nodes.push_back(Node());
+    build_node(0, 0, static_cast<int>(m_items.size()));
+  }
+}
+
+void
+BVH::collect(SceneNode* node)
+{
+  if (!node->get_models().empty())
+  {
+    // empty nodes go into the tree as well, they might get meshes
+    // later on, which refit() picks up
+    if (node->get_world_bounds().is_infinite())
+    {
+      m_unbounded.push_back(node);
+    }
+    else
+    {
+      m_items.push_back(node);
+    }
+  }
+
+  for(const auto& child : node->get_children())
+  {
+    collect(child.get());
+  }
+}
+
+void
+BVH::build_node(int idx, int first, int count)
+{
+  AABB bounds;
+  AABB centers;
+  for(int i = first; i < first + count; ++i)
+  {
+    const AABB& item = m_items[i]->get_world_bounds();
+    bounds.extend(item);
+    centers.extend(item.get_center());
+  }
+  m_nodes[idx].bounds = bounds;
+
+  if (count <= s_max_leaf_items)
+  {
+    m_nodes[idx].first = first;
+    m_nodes[idx].count = count;
+  }
+  else
+  {
+    // split at the median along the longest axis of the centers
+    glm::vec3 extent = centers.get_extent();
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int half = count / 2;
+    std::nth_element(m_items.begin() + first, m_items.begin() + first + half, m_items.begin() + first + count,
+                     [axis](SceneNode* lhs, SceneNode* rhs) {
+                       return lhs->get_world_bounds().get_center()[axis] < rhs->get_world_bounds().get_center()[axis];
+                     });
+
+    // children always come after their parent, refit() depends on it
+    int child = static_cast<int>(m_nodes.size());
+    m_nodes.push_back(Node());
+    m_nodes.push_back(Node());
+    m_nodes[idx].child = child;
+
+    build_node(child, first, half);
+    build_node(child + 1, first + half, count - half);
+  }
+}
+
+void
+BVH::refit()
+{
+  for(int idx = static_cast<int>(m_nodes.size()) - 1; idx >= 0; --idx)
+  {
+    Node& node = m_nodes[idx];
+    AABB bounds;
+    if (node.child < 0)
+    {
+      for(int i = node.first; i < node.first + node.count; ++i)
+      {
+        bounds.extend(m_items[i]->get_world_bounds());
+      }
+    }
+    else
+    {
+      bounds.extend(m_nodes[node.child].bounds);
+      bounds.extend(m_nodes[node.child + 1].bounds);
+    }
+    node.bounds = bounds;
+  }
+}
+
+void
+BVH::query(const Frustum& frustum, std::vector<SceneNode*>& result) const
+{
+  result.insert(result.end(), m_unbounded.begin(), m_unbounded.end());
+
+  if (m_nodes.empty())
+  {
+    return;
+  }
+
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+
+  while(top > 0)
+  {
+    const Node& node = m_nodes[stack[--top]];
+
+    if (frustum.intersects(node.bounds))
+    {
+      if (node.child < 0)
+      {
+        for(int i = node.first; i < node.first + node.count; ++i)
+        {
+          if (node.count == 1 || frustum.intersects(m_items[i]->get_world_bounds()))
+          {
+            result.push_back(m_items[i]);
+          }
+        }
+      }
+      else
+      {
+        stack[top++] = node.child + 1;
+        stack[top++] = node.child;
+      }
+    }
+  }
+}
+
+SceneNode*
+BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const
+{
+  SceneNode* hit = nullptr;
+  distance = std::numeric_limits<float>::max();
+
+  if (m_nodes.empty())
+  {
+    return hit;
+  }
+
+  glm::vec3 inv_direction = 1.0f / direction;
+
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+
+  while(top > 0)
+  {
+    const Node& node = m_nodes[stack[--top]];
+
+    float t = intersect_ray(node.bounds, origin, inv_direction);
+    if (t >= 0.0f && t < distance)
+    {
+      if (node.child < 0)
+      {
+        for(int i = node.first; i < node.first + node.count; ++i)
+        {
+          float item_t = intersect_ray(m_items[i]->get_world_bounds(), origin, inv_direction);
+          if (item_t >= 0.0f && item_t < distance)
+          {
+            distance = item_t;
+            hit = m_items[i];
+          }
+        }
+      }
+      else
+      {
+        stack[top++] = node.child + 1;
+        stack[top++] = node.child;
+      }
+    }
+  }
+
+  return hit;
+}
+
+int
+BVH::get_depth() const
+{
+  if (m_nodes.empty())
+  {
+    return 0;
+  }
+  else
+  {
+    return get_depth(0);
+  }
+}
+
+int
+BVH::get_depth(int idx) const
+{
+  const Node& node = m_nodes[idx];
+  if (node.child < 0)
+  {
+    return 1;
+  }
+  else
+  {
+    return 1 + std::max(get_depth(node.child), get_depth(node.child + 1));
+  }
+}
+
+/* EOF */
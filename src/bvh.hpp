@@ -0,0 +1,91 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_BVH_HPP
+#define HEADER_BVH_HPP
+
+#include <vector>
+
+#include "aabb.hpp"
+#include "frustum.hpp"
+
+class SceneNode;
+
+/** Bounding volume hierarchy over the world bounds of the SceneNodes
+    that have models. build() sorts the nodes into a binary tree stored
+    in a flat array, refit() only recomputes the boxes for moved nodes
+    and keeps the tree, which is fine as long as nodes don't move
+    around too much relative to each other. Structural changes of the
+    scene need a new build(). Nodes with infinite bounds are kept
+    outside of the tree and are returned by every query. */
+class BVH
+{
+private:
+  struct Node
+  {
+    AABB bounds;
+
+    /** index of the first child, the second one follows it, -1 for
+        leafs */
+    int child;
+
+    /** range of m_items covered by a leaf */
+    int first;
+    int count;
+
+    Node() : bounds(), child(-1), first(0), count(0) {}
+  };
+
+  static const int s_max_leaf_items = 4;
+
+  std::vector<Node> m_nodes;
+  std::vector<SceneNode*> m_items;
+  std::vector<SceneNode*> m_unbounded;
+
+public:
+  BVH();
+
+  /** Collect all nodes with models below and including \a root, the
+      transforms have to be up to date */
+  void build(SceneNode* root);
+
+  /** Pull the current world bounds of all nodes into the tree */
+  void refit();
+
+  /** Append all nodes whose bounds intersect \a frustum to \a result */
+  void query(const Frustum& frustum, std::vector<SceneNode*>& result) const;
+
+  /** Find the node whose bounds the ray hits first, \a distance is
+      set to the distance along \a direction, nullptr when nothing
+      got hit. Nodes with infinite bounds are ignored. */
+  SceneNode* raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+
+  /** Number of nodes in the tree and outside of it */
+  size_t size() const { return m_items.size() + m_unbounded.size(); }
+
+  /** Depth of the tree, for statistics */
+  int get_depth() const;
+
+private:
+  void collect(SceneNode* node);
+  void build_node(int idx, int first, int count);
+  int get_depth(int idx) const;
+};
+
+#endif
+
+/* EOF */
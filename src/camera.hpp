@@ -44,6 +44,10 @@ private:
   glm::vec3 m_position;
   glm::quat m_orientation;
 
+  /** height in pixels of the viewport drawn to, used to pick the
+      level of detail, 0 when unknown */
+  int m_viewport_height;
+
 public:
   Camera() :
     m_type(kPerspective),
@@ -56,7 +60,8 @@ public:
     m_znear(0.1f),
     m_zfar(1000.0f),
     m_position(),
-    m_orientation(1.0f, 0.0f, 0.0f, 0.0f)
+    m_orientation(1.0f, 0.0f, 0.0f, 0.0f),
+    m_viewport_height(0)
   {}
 
   ~Camera()
@@ -68,6 +73,9 @@ public:
   void set_orientation(const glm::quat& q) { m_orientation = q; }
   glm::quat get_orientation() const { return m_orientation; }
 
+  void set_viewport_height(int height) { m_viewport_height = height; }
+  int get_viewport_height() const { return m_viewport_height; }
+
   void ortho(float left, float right, float bottom, float top, float znear, float zfar)
   {
     m_type = kOrtho;
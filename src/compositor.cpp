@@ -0,0 +1,94 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "compositor.hpp"
+
+#include "opengl_state.hpp"
+#include "render_context.hpp"
+
+Compositor::Compositor(int width, int height) :
+  m_program(Program::create(Shader::from_file(GL_FRAGMENT_SHADER, "src/composite.frag"),
+                            Shader::from_file(GL_VERTEX_SHADER, "src/composite.vert"))),
+  m_material(std::make_shared<Material>()),
+  m_mesh(),
+  m_node(),
+  m_camera(),
+  m_mode(),
+  m_barrel_power(0.0f)
+{
+  m_material->set_program(m_program);
+  m_material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
+  // read at draw time, so set_barrel_power() doesn't have to touch
+  // the material
+  m_material->set_uniform("barrel_power",
+                          UniformCallback(
+                            [this](ProgramPtr prog, const std::string& name, const RenderContext& ctx) {
+                              prog->set_uniform(name, m_barrel_power);
+                            }));
+  m_material->set_uniform("left_eye",  0);
+  m_material->set_uniform("right_eye", 1);
+
+  set_mode("mono");
+  resize(width, height);
+}
+
+void
+Compositor::resize(int width, int height)
+{
+  m_mesh = Mesh::create_rect(0.0f, 0.0f, width, height, -20.0f);
+  m_camera.ortho(0, width, height, 0.0f, 0.1f, 10000.0f);
+  m_camera.set_viewport_height(height);
+}
+
+void
+Compositor::set_textures(TexturePtr left, TexturePtr right)
+{
+  m_material->set_texture(0, left);
+  m_material->set_texture(1, right);
+}
+
+void
+Compositor::set_barrel_power(float barrel_power)
+{
+  m_barrel_power = barrel_power;
+}
+
+void
+Compositor::set_mode(const std::string& subroutine)
+{
+  // changing the subroutine drops the cached subroutine tables of
+  // the material, so only do it when it actually changes
+  if (m_mode != subroutine)
+  {
+    m_mode = subroutine;
+    m_material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", subroutine);
+  }
+}
+
+void
+Compositor::draw()
+{
+  OpenGLState state;
+
+  RenderContext context(m_camera, &m_node);
+  m_material->apply(context);
+  m_mesh->draw(m_program->get_id());
+
+  OpenGLState::use_program(0);
+}
+
+/* EOF */
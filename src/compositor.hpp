@@ -0,0 +1,72 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_COMPOSITOR_HPP
+#define HEADER_COMPOSITOR_HPP
+
+#include <memory>
+#include <string>
+
+#include "camera.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "scene_node.hpp"
+
+/** Draws the left and right eye images onto the screen with the
+    composite shader. The quad, material and program are created once
+    and kept, per frame only the textures, uniforms and the subroutine
+    that picks the stereo mode get updated. */
+class Compositor
+{
+private:
+  ProgramPtr m_program;
+  MaterialPtr m_material;
+  std::unique_ptr<Mesh> m_mesh;
+  SceneNode m_node;
+  Camera m_camera;
+
+  /** name of the active fragment_color subroutine */
+  std::string m_mode;
+
+  float m_barrel_power;
+
+public:
+  Compositor(int width, int height);
+
+  /** Rebuild the quad and the camera for a new screen size */
+  void resize(int width, int height);
+
+  void set_textures(TexturePtr left, TexturePtr right);
+  void set_barrel_power(float barrel_power);
+
+  /** Pick the fragment_color subroutine of composite.frag, e.g.
+      "mono", "crosseye" or "anaglyph" */
+  void set_mode(const std::string& subroutine);
+
+  void draw();
+
+  const Camera& get_camera() const { return m_camera; }
+  SceneNode* get_node() { return &m_node; }
+
+private:
+  Compositor(const Compositor&) = delete;
+  Compositor& operator=(const Compositor&) = delete;
+};
+
+#endif
+
+/* EOF */
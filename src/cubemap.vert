@@ -7,7 +7,20 @@ in vec3 position;
 out vec3 texcoord_var;
 out vec3 normal_var;
 
-uniform mat4 MVP;
+layout(std140, binding = 0) uniform FrameBlock
+{
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+};
+
+layout(std140, binding = 1) uniform ObjectBlock
+{
+  mat4 ModelMatrix;
+  mat4 ModelViewMatrix;
+  mat4 MVP;
+  mat4 ShadowMapMatrix;
+  mat3 NormalMatrix;
+};
 
 void main(void)
 {
@@ -40,11 +40,6 @@ struct MaterialInfo
 uniform LightInfo light;
 uniform MaterialInfo material;
 
-uniform mat4 ModelViewMatrix;
-uniform mat3 NormalMatrix;
-//uniform mat4 ProjectionMatrix;
-uniform mat4 MVP;
-
 in vec3 world_normal;
 in vec3 frag_normal;
 in vec3 frag_position;
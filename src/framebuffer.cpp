@@ -32,7 +32,7 @@ Framebuffer::Framebuffer(int width, int height) :
   assert_gl("framebuffer");
   glGenFramebuffers(1, &m_fbo);
   assert_gl("framebuffer");
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, m_fbo);
   assert_gl("framebuffer");
 
   m_color_buffer = Texture::create_empty(GL_TEXTURE_2D, GL_RGB16F, width, height);
@@ -54,15 +54,15 @@ Framebuffer::Framebuffer(int width, int height) :
   log_info("Depth Buffer: %s", m_depth_buffer);
   log_info("Color Buffer: %s", m_color_buffer);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
   
 Framebuffer::~Framebuffer()
 {
   assert_gl("~Framebuffer-enter()");
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, 0);
   log_info("~Framebuffer()");
-  glDeleteFramebuffers(1, &m_fbo);
+  OpenGLState::delete_framebuffers(1, &m_fbo);
   //glDeleteTextures(1, &m_depth_buffer);
   //glDeleteTextures(1, &m_color_buffer);
   assert_gl("~Framebuffer()");
@@ -73,9 +73,9 @@ Framebuffer::draw(float x, float y, float w, float h, float z)
 {
   OpenGLState state;
     
-  glEnable(GL_TEXTURE_2D);
+  OpenGLState::enable(GL_TEXTURE_2D);
 
-  glBindTexture(GL_TEXTURE_2D, m_color_buffer->get_id());
+  OpenGLState::bind_texture(GL_TEXTURE_2D, m_color_buffer->get_id());
   glBegin(GL_QUADS);
   {
     glTexCoord2f(0.0f, 0.0f);
@@ -98,9 +98,9 @@ Framebuffer::draw_depth(float x, float y, float w, float h, float z)
 {
   OpenGLState state;
     
-  glEnable(GL_TEXTURE_2D);
+  OpenGLState::enable(GL_TEXTURE_2D);
 
-  glBindTexture(GL_TEXTURE_2D, m_depth_buffer->get_id());
+  OpenGLState::bind_texture(GL_TEXTURE_2D, m_depth_buffer->get_id());
   
   GLint compare_mode;
   GLint compare_func;
@@ -141,13 +141,13 @@ Framebuffer::draw_depth(float x, float y, float w, float h, float z)
 void
 Framebuffer::bind()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, m_fbo);
 }
 
 void 
 Framebuffer::unbind()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /* EOF */
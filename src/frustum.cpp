@@ -0,0 +1,85 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "frustum.hpp"
+
+Frustum::Frustum(const glm::mat4& matrix) :
+  m_planes()
+{
+  // Gribb/Hartmann: each plane is the last row of the matrix plus or
+  // minus one of the others, glm matrices are indexed [column][row]
+  glm::vec4 row[4];
+  for(int i = 0; i < 4; ++i)
+  {
+    row[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+  }
+
+  m_planes[0] = row[3] + row[0]; // left
+  m_planes[1] = row[3] - row[0]; // right
+  m_planes[2] = row[3] + row[1]; // bottom
+  m_planes[3] = row[3] - row[1]; // top
+  m_planes[4] = row[3] + row[2]; // near
+  m_planes[5] = row[3] - row[2]; // far
+
+  for(auto& plane : m_planes)
+  {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+bool
+Frustum::intersects(const AABB& aabb) const
+{
+  if (aabb.is_infinite())
+  {
+    return true;
+  }
+  else if (aabb.is_empty())
+  {
+    return false;
+  }
+  else
+  {
+    for(const auto& plane : m_planes)
+    {
+      // the corner furthest along the plane normal
+      glm::vec3 p(plane.x > 0.0f ? aabb.get_max().x : aabb.get_min().x,
+                  plane.y > 0.0f ? aabb.get_max().y : aabb.get_min().y,
+                  plane.z > 0.0f ? aabb.get_max().z : aabb.get_min().z);
+      if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+bool
+Frustum::intersects(const glm::vec3& center, float radius) const
+{
+  for(const auto& plane : m_planes)
+  {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* EOF */
@@ -0,0 +1,48 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_FRUSTUM_HPP
+#define HEADER_FRUSTUM_HPP
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "aabb.hpp"
+
+/** The six planes of a view frustum, extracted from a combined
+    projection and view matrix like Camera::get_matrix(), the normals
+    point inwards */
+class Frustum
+{
+private:
+  glm::vec4 m_planes[6];
+
+public:
+  Frustum(const glm::mat4& matrix);
+
+  /** False when \a aabb is completely outside of the frustum. Boxes
+      close to a corner may be reported as intersecting even though
+      they are outside, which is fine for culling. */
+  bool intersects(const AABB& aabb) const;
+
+  /** Same for a sphere */
+  bool intersects(const glm::vec3& center, float radius) const;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,81 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "image.hpp"
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <stdexcept>
+#include <string.h>
+
+#include "pixel_kernels.hpp"
+
+ImagePtr
+Image::from_file(const std::string& filename)
+{
+  SDL_Surface* surface = IMG_Load(filename.c_str());
+  if (!surface)
+  {
+    throw std::runtime_error("Image: couldn't open " + filename);
+  }
+  else
+  {
+    ImagePtr image = std::make_shared<Image>(surface->w, surface->h, surface->format->BytesPerPixel);
+
+    const size_t len = image->get_pitch();
+    for(int y = 0; y < surface->h; ++y)
+    {
+      memcpy(image->get_data() + y * len,
+             static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch,
+             len);
+    }
+
+    SDL_FreeSurface(surface);
+    return image;
+  }
+}
+
+Image::Image(int width, int height, int bytes_per_pixel) :
+  m_width(width),
+  m_height(height),
+  m_bytes_per_pixel(bytes_per_pixel),
+  m_pixels(static_cast<size_t>(width) * height * bytes_per_pixel),
+  m_mipmaps()
+{
+}
+
+void
+Image::swap_rb()
+{
+  const size_t count = static_cast<size_t>(m_width) * m_height;
+  if (m_bytes_per_pixel == 3)
+  {
+    PixelKernels::get().swap_rb_rgb(m_pixels.data(), m_pixels.data(), count);
+  }
+  else if (m_bytes_per_pixel == 4)
+  {
+    PixelKernels::get().swap_rb_rgba(m_pixels.data(), m_pixels.data(), count);
+  }
+}
+
+void
+Image::vflip()
+{
+  PixelKernels::get().vflip(m_pixels.data(), get_pitch(), m_height);
+}
+
+/* EOF */
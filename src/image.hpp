@@ -0,0 +1,75 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_IMAGE_HPP
+#define HEADER_IMAGE_HPP
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Image;
+
+typedef std::shared_ptr<Image> ImagePtr;
+
+/** Pixels of a decoded image file, rows are tightly packed, no
+    OpenGL calls are made, so images can be decoded and processed on
+    any thread */
+class Image
+{
+private:
+  int m_width;
+  int m_height;
+  int m_bytes_per_pixel;
+  std::vector<uint8_t> m_pixels;
+
+  /** the smaller levels of the mip chain, empty unless set_mipmaps()
+      was called */
+  std::vector<ImagePtr> m_mipmaps;
+
+public:
+  /** Decode \a filename with SDL_image, throws std::runtime_error
+      when the file can't be loaded */
+  static ImagePtr from_file(const std::string& filename);
+
+  Image(int width, int height, int bytes_per_pixel);
+
+  /** Swap the first and the third channel of every pixel */
+  void swap_rb();
+
+  /** Turn the image upside down */
+  void vflip();
+
+  int get_width() const { return m_width; }
+  int get_height() const { return m_height; }
+  int get_bytes_per_pixel() const { return m_bytes_per_pixel; }
+  int get_pitch() const { return m_width * m_bytes_per_pixel; }
+
+  uint8_t* get_data() { return m_pixels.data(); }
+  const uint8_t* get_data() const { return m_pixels.data(); }
+  size_t get_size() const { return m_pixels.size(); }
+
+  /** Levels as returned by MipmapBuilder::build(), they are not
+      touched by swap_rb() or vflip(), so set them last */
+  void set_mipmaps(std::vector<ImagePtr> mipmaps) { m_mipmaps = std::move(mipmaps); }
+  const std::vector<ImagePtr>& get_mipmaps() const { return m_mipmaps; }
+};
+
+#endif
+
+/* EOF */
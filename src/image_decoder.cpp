@@ -0,0 +1,105 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "image_decoder.hpp"
+
+#include "mipmap_builder.hpp"
+
+namespace {
+
+std::string make_key(const std::string& filename, int flags)
+{
+  return std::to_string(flags) + ":" + filename;
+}
+
+} // namespace
+
+ImageDecoder::ImageDecoder(unsigned int threads) :
+  m_pool(threads),
+  m_mutex(),
+  m_pending()
+{
+}
+
+ImageDecoder::~ImageDecoder()
+{
+}
+
+void
+ImageDecoder::prefetch(const std::string& filename, int flags)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::string key = make_key(filename, flags);
+  if (m_pending.find(key) == m_pending.end())
+  {
+    m_pending[key] = submit(filename, flags);
+  }
+}
+
+std::shared_future<ImagePtr>
+ImageDecoder::request(const std::string& filename, int flags)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_pending.find(make_key(filename, flags));
+  if (it != m_pending.end())
+  {
+    std::shared_future<ImagePtr> result = it->second;
+    m_pending.erase(it);
+    return result;
+  }
+  else
+  {
+    return submit(filename, flags);
+  }
+}
+
+ImagePtr
+ImageDecoder::decode(const std::string& filename, int flags)
+{
+  return request(filename, flags).get();
+}
+
+void
+ImageDecoder::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pending.clear();
+}
+
+std::shared_future<ImagePtr>
+ImageDecoder::submit(const std::string& filename, int flags)
+{
+  return m_pool.submit([filename, flags]{
+      ImagePtr image = Image::from_file(filename);
+      if (flags & SwapRB)
+      {
+        image->swap_rb();
+      }
+      if (flags & FlipVertical)
+      {
+        image->vflip();
+      }
+      if (flags & Mipmaps)
+      {
+        // already on a worker, so the builder runs single threaded
+        image->set_mipmaps(MipmapBuilder().build(*image));
+      }
+      return image;
+    }).share();
+}
+
+/* EOF */
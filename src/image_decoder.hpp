@@ -0,0 +1,92 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_IMAGE_DECODER_HPP
+#define HEADER_IMAGE_DECODER_HPP
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "image.hpp"
+#include "thread_pool.hpp"
+
+/** Decodes image files on a ThreadPool, including the pixel shuffling
+    needed before the upload, so that the thread owning the GL context
+    only has to hand finished pixels to OpenGL. prefetch() starts a
+    decode early, the matching decode() later picks up the result.
+    Can be used from any thread. */
+class ImageDecoder
+{
+public:
+  enum Flags
+  {
+    None = 0,
+    FlipVertical = 1 << 0,
+    SwapRB = 1 << 1,
+
+    /** build the mip chain with MipmapBuilder, after the other flags
+        are applied */
+    Mipmaps = 1 << 2
+  };
+
+private:
+  ThreadPool m_pool;
+
+  std::mutex m_mutex;
+
+  /** decodes started by prefetch() that no decode() took yet, keyed
+      by flags and filename */
+  std::unordered_map<std::string, std::shared_future<ImagePtr> > m_pending;
+
+public:
+  /** \a threads worker threads, 0 means one per core */
+  ImageDecoder(unsigned int threads = 0);
+  ~ImageDecoder();
+
+  /** Start decoding \a filename in the background, does nothing when
+      the same file with the same flags is already on its way */
+  void prefetch(const std::string& filename, int flags);
+
+  /** Start decoding \a filename unless prefetch() already did, the
+      returned future throws if the file can't be loaded */
+  std::shared_future<ImagePtr> request(const std::string& filename, int flags);
+
+  /** Wait for the image and return it, errors are rethrown here */
+  ImagePtr decode(const std::string& filename, int flags);
+
+  /** Forget prefetched images nobody asked for */
+  void clear();
+
+  static ImageDecoder& get()
+  {
+    static ImageDecoder* instance = new ImageDecoder;
+    return *instance;
+  }
+
+private:
+  std::shared_future<ImagePtr> submit(const std::string& filename, int flags);
+
+private:
+  ImageDecoder(const ImageDecoder&) = delete;
+  ImageDecoder& operator=(const ImageDecoder&) = delete;
+};
+
+#endif
+
+/* EOF */
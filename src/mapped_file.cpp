@@ -0,0 +1,76 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "mapped_file.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "format.hpp"
+
+MappedFile::MappedFile(const std::string& filename) :
+  m_filename(filename),
+  m_fd(-1),
+  m_size(0),
+  m_data(nullptr)
+{
+  m_fd = open(filename.c_str(), O_RDONLY);
+  if (m_fd < 0)
+  {
+    throw std::runtime_error(format("%s: %s", filename, strerror(errno)));
+  }
+
+  struct stat st;
+  if (fstat(m_fd, &st) < 0)
+  {
+    int err = errno;
+    close(m_fd);
+    throw std::runtime_error(format("%s: %s", filename, strerror(err)));
+  }
+
+  m_size = static_cast<size_t>(st.st_size);
+
+  // mmap() refuses zero sized mappings, an empty file simply stays unmapped
+  if (m_size != 0)
+  {
+    m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (m_data == MAP_FAILED)
+    {
+      int err = errno;
+      close(m_fd);
+      throw std::runtime_error(format("%s: mmap failed: %s", filename, strerror(err)));
+    }
+
+    // the loaders walk the file front to back exactly once
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data)
+  {
+    munmap(m_data, m_size);
+  }
+  close(m_fd);
+}
+
+/* EOF */
@@ -0,0 +1,49 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_MAPPED_FILE_HPP
+#define HEADER_MAPPED_FILE_HPP
+
+#include <stddef.h>
+#include <string>
+
+/** Read-only memory mapping of a whole file */
+class MappedFile
+{
+private:
+  std::string m_filename;
+  int m_fd;
+  size_t m_size;
+  void* m_data;
+
+public:
+  MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  const std::string& get_filename() const { return m_filename; }
+
+  const char* begin() const { return static_cast<const char*>(m_data); }
+  const char* end() const { return static_cast<const char*>(m_data) + m_size; }
+  size_t size() const { return m_size; }
+
+private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif
+
+/* EOF */
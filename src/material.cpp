@@ -22,7 +22,9 @@
 
 #include "assert_gl.hpp"
 #include "log.hpp"
+#include "opengl_state.hpp"
 #include "render_context.hpp"
+#include "render_queue.hpp"
 
 Material::Material() :
   m_cast_shadow(true),
@@ -75,55 +77,141 @@ Material::disable(GLenum cap)
   m_capabilities[cap] = false;
 }
 
+bool
+Material::is_blended() const
+{
+  auto it = m_capabilities.find(GL_BLEND);
+  return it != m_capabilities.end() && it->second;
+}
+
+GLuint
+Material::get_sort_texture() const
+{
+  const TexturePtr* texture = nullptr;
+  int unit = 0;
+  for(const auto& it : m_textures)
+  {
+    if (!texture || it.first < unit)
+    {
+      unit = it.first;
+      texture = &std::get<0>(it.second);
+    }
+  }
+
+  if (texture && *texture)
+  {
+    return (*texture)->get_id();
+  }
+  else
+  {
+    return 0;
+  }
+}
+
 void
 Material::apply(const RenderContext& context)
+{
+  RenderStats stats;
+  apply(context, nullptr, stats);
+}
+
+void
+Material::apply(const RenderContext& context, const Material* previous, RenderStats& stats)
 {
   assert_gl("Material::apply:enter");
 
-  for(const auto& cap : m_capabilities)
+  if (previous != this)
   {
-    if (cap.second)
+    stats.materials += 1;
+
+    for(const auto& cap : m_capabilities)
     {
-      glEnable(cap.first);
+      if (previous)
+      {
+        auto it = previous->m_capabilities.find(cap.first);
+        if (it != previous->m_capabilities.end() && it->second == cap.second)
+        {
+          continue;
+        }
+      }
+
+      if (cap.second)
+      {
+        OpenGLState::enable(cap.first);
+      }
+      else
+      {
+        OpenGLState::disable(cap.first);
+      }
+      stats.states += 1;
     }
-    else
+    assert_gl("caps enable");
+
+    if (!previous || previous->m_color_mask != m_color_mask)
     {
-      glDisable(cap.first);
+      OpenGLState::color_mask(m_color_mask.r, m_color_mask.g, m_color_mask.b, m_color_mask.a);
+      stats.states += 1;
     }
-  }
-  assert_gl("caps enable");
 
-  glColorMask(m_color_mask.r, m_color_mask.g, m_color_mask.b, m_color_mask.a); 
-  glDepthMask(m_depth_mask);
-  glCullFace(m_cull_face);
+    if (!previous || previous->m_depth_mask != m_depth_mask)
+    {
+      OpenGLState::depth_mask(m_depth_mask);
+      stats.states += 1;
+    }
 
-  glBlendFunc(m_blend_sfactor, m_blend_dfactor);
-  assert_gl("GL props set");
+    if (!previous || previous->m_cull_face != m_cull_face)
+    {
+      OpenGLState::cull_face(m_cull_face);
+      stats.states += 1;
+    }
 
-  switch(context.get_stereo())
-  {
-    case Stereo::Center:
-    case Stereo::Left:
-      for(const auto& it : m_textures)
+    if (!previous ||
+        previous->m_blend_sfactor != m_blend_sfactor ||
+        previous->m_blend_dfactor != m_blend_dfactor)
+    {
+      OpenGLState::blend_func(m_blend_sfactor, m_blend_dfactor);
+      stats.states += 1;
+    }
+    assert_gl("GL props set");
+
+    auto get_texture = [&context](const std::tuple<TexturePtr, TexturePtr>& textures) -> const TexturePtr& {
+      if (context.get_stereo() == Stereo::Right)
       {
-        glActiveTexture(GL_TEXTURE0 + it.first);
-        glBindTexture(std::get<0>(it.second)->get_target(), std::get<0>(it.second)->get_id());
+        return std::get<1>(textures);
       }
-      break;
+      else
+      {
+        return std::get<0>(textures);
+      }
+    };
 
-    case Stereo::Right:
-      for(const auto& it : m_textures)
+    for(const auto& it : m_textures)
+    {
+      const TexturePtr& texture = get_texture(it.second);
+
+      if (previous)
       {
-        glActiveTexture(GL_TEXTURE0 + it.first);
-        glBindTexture(std::get<1>(it.second)->get_target(), std::get<1>(it.second)->get_id());
+        auto prev = previous->m_textures.find(it.first);
+        if (prev != previous->m_textures.end() && get_texture(prev->second) == texture)
+        {
+          continue;
+        }
       }
-      break;
+
+      OpenGLState::active_texture(GL_TEXTURE0 + it.first);
+      OpenGLState::bind_texture(texture->get_target(), texture->get_id());
+      stats.textures += 1;
+    }
+    assert_gl("textures bound");
   }
-  assert_gl("textures bound");
 
   if (m_program)
   {
-    glUseProgram(m_program->get_id());
+    if (!previous || previous->m_program != m_program)
+    {
+      OpenGLState::use_program(m_program->get_id());
+      stats.programs += 1;
+    }
     assert_gl("program bound");
 
     if (m_uniforms)
@@ -28,6 +28,7 @@
 #include "uniform_group.hpp"
 
 class RenderContext;
+struct RenderStats;
 
 class Material
 {
@@ -55,6 +56,7 @@ public:
   bool cast_shadow() const { return m_cast_shadow; }
 
   void set_program(ProgramPtr program) { m_program = program; }
+  ProgramPtr get_program() const { return m_program; }
   void set_texture(int unit, TexturePtr texture) { m_textures[unit] = std::make_tuple(texture, texture); }
   void set_texture(int unit, TexturePtr left, TexturePtr right) { m_textures[unit] = std::make_tuple(left, right); }
 
@@ -66,6 +68,14 @@ public:
   void enable(GLenum cap);
   void disable(GLenum cap);
 
+  /** True when GL_BLEND is enabled, such materials have to be drawn
+      after the opaque ones */
+  bool is_blended() const;
+
+  /** Id of the texture in the lowest unit or 0, used to group draws
+      that share a texture */
+  GLuint get_sort_texture() const;
+
   template<typename T>
   void set_uniform(const std::string& name, const T& value)
   {
@@ -79,6 +89,11 @@ public:
 
   void apply(const RenderContext& context);
 
+  /** Like apply(), but assumes that \a previous was the last material
+      applied and skips all state that it already set the same way,
+      the GL calls that are done get counted in \a stats */
+  void apply(const RenderContext& context, const Material* previous, RenderStats& stats);
+
 private:
   Material(const Material&);
   Material& operator=(const Material&);
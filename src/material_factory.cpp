@@ -16,45 +16,63 @@
 
 #include "material_factory.hpp"
 
+#include <chrono>
 #include <stdexcept>
 #include <boost/algorithm/string/predicate.hpp>
 
 #include "framebuffer.hpp"
+#include "log.hpp"
 #include "material_parser.hpp"
 #include "render_context.hpp"
+#include "texture_cache.hpp"
 
 extern glm::mat4 g_shadowmap_matrix;
 extern std::unique_ptr<Framebuffer> g_shadowmap;
 
 MaterialFactory::MaterialFactory() :
+  m_recipes(),
   m_materials()
 {
-  m_materials["basic_white"] = create_basic_white();
-  m_materials["phong"] = create_phong(glm::vec3(0.5f, 0.5f, 0.5f),
-                                      glm::vec3(1.0f, 1.0f, 1.0f),
-                                      glm::vec3(1.0f, 1.0f, 1.0f),
-                                      5.0f);
-
-  m_materials["Rim"] = create_phong(glm::vec3(0.5f, 0.5f, 0.5f),
-                                    glm::vec3(1.0f, 1.0f, 1.0f),
-                                    glm::vec3(1.0f, 1.0f, 1.0f),
-                                    1.0f);
-
-  m_materials["Wheel"] = create_phong(glm::vec3(0.1f, 0.1f, 0.1f),
-                                      glm::vec3(1.0f, 1.0f, 1.0f),
-                                      glm::vec3(1.0f, 1.0f, 1.0f),
-                                      8.0f);
-
-  m_materials["Body"] = create_phong(glm::vec3(0.5f, 0.5f, 0.8f),
-                                     glm::vec3(1.0f, 1.0f, 1.0f),
-                                     glm::vec3(0.5f, 0.5f, 0.5f),
-                                     2.5f);
-                                      
-  m_materials["skybox"] = create_skybox();
-  m_materials["textured"] = create_textured();
-  m_materials["video"] = create_video();
-  m_materials["video3d"] = create_video3d(false);
-  m_materials["video3d-flip"] = create_video3d(true);
+  add_recipe("basic_white", []{ return create_basic_white(); });
+  add_recipe("phong", []{
+      return create_phong(glm::vec3(0.5f, 0.5f, 0.5f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          5.0f);
+    });
+
+  add_recipe("Rim", []{
+      return create_phong(glm::vec3(0.5f, 0.5f, 0.5f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          1.0f);
+    });
+
+  add_recipe("Wheel", []{
+      return create_phong(glm::vec3(0.1f, 0.1f, 0.1f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          8.0f);
+    });
+
+  add_recipe("Body", []{
+      return create_phong(glm::vec3(0.5f, 0.5f, 0.8f),
+                          glm::vec3(1.0f, 1.0f, 1.0f),
+                          glm::vec3(0.5f, 0.5f, 0.5f),
+                          2.5f);
+    });
+
+  add_recipe("skybox", []{ return create_skybox(); });
+  add_recipe("textured", []{ return create_textured(); });
+  add_recipe("video", []{ return create_video(); });
+  add_recipe("video3d", []{ return create_video3d(false); });
+  add_recipe("video3d-flip", []{ return create_video3d(true); });
+}
+
+void
+MaterialFactory::add_recipe(const std::string& name, const Recipe& recipe)
+{
+  m_recipes[name] = recipe;
 }
 
 MaterialPtr
@@ -62,11 +80,6 @@ MaterialFactory::from_file(const boost::filesystem::path& filename)
 {
   MaterialPtr material = MaterialParser::from_file(filename);
 
-  material->set_uniform("ModelMatrix", UniformSymbol::ModelMatrix);
-  material->set_uniform("ModelViewMatrix", UniformSymbol::ModelViewMatrix);
-  material->set_uniform("NormalMatrix", UniformSymbol::NormalMatrix);
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
   material->set_uniform("light.diffuse",   glm::vec3(1.0f, 1.0f, 1.0f));
   material->set_uniform("light.ambient",   glm::vec3(0.25f, 0.25f, 0.25f));
   material->set_uniform("light.specular",  glm::vec3(0.6f, 0.6f, 0.6f));
@@ -77,11 +90,6 @@ MaterialFactory::from_file(const boost::filesystem::path& filename)
                                   prog->set_uniform(name, pos);
                                 }));
 
-  material->set_uniform("ShadowMapMatrix",
-                              UniformCallback(
-                                [](ProgramPtr prog, const std::string& name, const RenderContext& ctx) {
-                                  prog->set_uniform(name, g_shadowmap_matrix * ctx.get_model_matrix());
-                                }));
   material->set_texture(2, g_shadowmap->get_depth_texture());
   material->set_uniform("ShadowMap", 2);
 
@@ -92,21 +100,36 @@ MaterialPtr
 MaterialFactory::create(const std::string& name)
 {
   auto it = m_materials.find(name);
-  if (it == m_materials.end())
+  if (it != m_materials.end())
   {
-    if (name == "phong")
+    return it->second;
+  }
+  else
+  {
+    auto recipe = m_recipes.find(name);
+    if (recipe == m_recipes.end())
     {
-      throw std::runtime_error("unknown material: " + name);
+      if (name == "phong")
+      {
+        throw std::runtime_error("unknown material: " + name);
+      }
+      else
+      {
+        return create("phong");
+      }
     }
     else
     {
-      return create("phong");
+      auto start = std::chrono::steady_clock::now();
+      MaterialPtr material = recipe->second();
+      auto end = std::chrono::steady_clock::now();
+      log_info("MaterialFactory: built '%s' in %d ms", name,
+               std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+      m_materials[name] = material;
+      return material;
     }
   }
-  else
-  {
-    return it->second;
-  }
 }
 
 MaterialPtr
@@ -117,8 +140,6 @@ MaterialFactory::create_basic_white()
   material->enable(GL_CULL_FACE);
   material->enable(GL_DEPTH_TEST);
 
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
   material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER,   "src/basic_white.vert"),
                                         Shader::from_file(GL_FRAGMENT_SHADER, "src/basic_white.frag")));
   return material;
@@ -155,18 +176,9 @@ MaterialFactory::create_phong(const glm::vec3& diffuse,
   phong->set_uniform("material.specular",  specular);
   phong->set_uniform("material.shininess", shininess);
 
-  phong->set_uniform("ModelViewMatrix", UniformSymbol::ModelViewMatrix);
-  phong->set_uniform("NormalMatrix", UniformSymbol::NormalMatrix);
-  phong->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
-  phong->set_uniform("ShadowMapMatrix",
-                              UniformCallback(
-                                [](ProgramPtr prog, const std::string& name, const RenderContext& ctx) {
-                                  prog->set_uniform(name, g_shadowmap_matrix * ctx.get_model_matrix());
-                                }));
   phong->set_texture(0, g_shadowmap->get_depth_texture());
   phong->set_uniform("ShadowMap", 0);
-  phong->set_texture(1, Texture::cubemap_from_file("data/textures/miramar/"));
+  phong->set_texture(1, TextureCache::get().cubemap_from_file("data/textures/miramar/"));
   //phong->set_uniform("LightMap", 1);
   phong->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/phong.vert"),
                                               Shader::from_file(GL_FRAGMENT_SHADER, "src/phong.frag")));
@@ -182,10 +194,9 @@ MaterialFactory::create_skybox()
   material->enable(GL_BLEND);
   material->enable(GL_CULL_FACE);
   material->enable(GL_DEPTH_TEST);
-  material->set_texture(0, Texture::cubemap_from_file("data/textures/miramar/"));
+  material->set_texture(0, TextureCache::get().cubemap_from_file("data/textures/miramar/"));
   material->set_uniform("diffuse", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
   material->set_uniform("diffuse_texture", 0);
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
   material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/cubemap.vert"),
                                         Shader::from_file(GL_FRAGMENT_SHADER, "src/cubemap.frag")));
 
@@ -203,15 +214,11 @@ MaterialFactory::create_textured()
   material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/textured.vert"),
                                         Shader::from_file(GL_FRAGMENT_SHADER, "src/textured.frag")));
 
-  material->set_texture(0, Texture::from_file("data/textures/uvtest.png"));
-  material->set_texture(1, Texture::from_file("data/textures/uvtest.png"));
+  material->set_texture(0, TextureCache::get().from_file("data/textures/uvtest.png"));
+  material->set_texture(1, TextureCache::get().from_file("data/textures/uvtest.png"));
   material->set_uniform("texture_diff", 0);
   material->set_uniform("texture_spec", 1);
 
-  material->set_uniform("ModelViewMatrix", UniformSymbol::ModelViewMatrix);
-  material->set_uniform("NormalMatrix", UniformSymbol::NormalMatrix);
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
   material->set_uniform("light.diffuse",   glm::vec3(1.0f, 1.0f, 1.0f));
   material->set_uniform("light.ambient",   glm::vec3(0.25f, 0.25f, 0.25f));
   material->set_uniform("light.specular",  glm::vec3(0.6f, 0.6f, 0.6f));
@@ -227,11 +234,6 @@ MaterialFactory::create_textured()
   material->set_uniform("material.ambient",   glm::vec3(1.0f, 1.0f, 1.0f));
   material->set_uniform("material.shininess", 64.0f);
 
-  material->set_uniform("ShadowMapMatrix",
-                              UniformCallback(
-                                [](ProgramPtr prog, const std::string& name, const RenderContext& ctx) {
-                                  prog->set_uniform(name, g_shadowmap_matrix * ctx.get_model_matrix());
-                                }));
   material->set_texture(2, g_shadowmap->get_depth_texture());
   material->set_uniform("ShadowMap", 2);
 
@@ -249,12 +251,10 @@ MaterialFactory::create_video()
   material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/video.vert"),
                                         Shader::from_file(GL_FRAGMENT_SHADER, "src/video.frag")));
 
-  material->set_texture(0, Texture::from_file("data/textures/uvtest.png"));
+  material->set_texture(0, TextureCache::get().from_file("data/textures/uvtest.png"));
   material->set_uniform("texture_diff", 0);
   material->set_uniform("offset", 0.0f);
 
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
   return material;
 }
 
@@ -270,7 +270,7 @@ MaterialFactory::create_video3d(bool flip_eyes)
   auto frag_shader = Shader::from_file(GL_FRAGMENT_SHADER, "src/video3d.frag");
   material->set_program(Program::create(vert_shader, frag_shader));
 
-  material->set_texture(0, Texture::from_file("data/textures/uvtest.png"));
+  material->set_texture(0, TextureCache::get().from_file("data/textures/uvtest.png"));
   material->set_uniform("texture_diff", 0);
   if (flip_eyes)
   {
@@ -284,8 +284,6 @@ MaterialFactory::create_video3d(bool flip_eyes)
   }
   material->set_uniform("offset", 0.0f);
 
-  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
-
   return material;
 }
 
@@ -18,21 +18,40 @@
 #define HEADER_MATERIAL_FACTORY_HPP
 
 #include <boost/filesystem/path.hpp>
+#include <functional>
 #include <string>
 #include <unordered_map>
 
 #include "material.hpp"
 
+/** Built-in materials by name. They are registered as recipes and
+    only built, compiling their shaders and loading their textures, on
+    the first create() that asks for them. */
 class MaterialFactory
 {
+public:
+  typedef std::function<MaterialPtr ()> Recipe;
+
 private:
+  std::unordered_map<std::string, Recipe> m_recipes;
+
+  /** materials built so far, create() hands out the same instance
+      every time */
   std::unordered_map<std::string, MaterialPtr> m_materials;
 
 public:
   MaterialFactory();
 
   MaterialPtr from_file(const boost::filesystem::path& name);
+
+  /** Returns the material registered as \a name, unknown names give
+      "phong" */
   MaterialPtr create(const std::string& name);
+
+  /** Register \a recipe to build the material \a name, replaces a
+      previous recipe, but not a material that was already built */
+  void add_recipe(const std::string& name, const Recipe& recipe);
+
   static MaterialPtr create_phong(const glm::vec3& diffuse, 
                                   const glm::vec3& ambient, 
                                   const glm::vec3& specular,
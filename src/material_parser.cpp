@@ -11,6 +11,7 @@
 
 #include "tokenize.hpp"
 #include "assert_gl.hpp"
+#include "texture_cache.hpp"
 
 namespace {
 
@@ -58,6 +59,10 @@ std::string to_string(T beg, T end)
 MaterialPtr
 MaterialParser::from_file(const boost::filesystem::path& filename)
 {
+  // the textures of a material decode in parallel, not one after
+  // another while parsing
+  prefetch(filename);
+
   std::ifstream in(filename.string());
   if (!in)
   {
@@ -71,6 +76,32 @@ MaterialParser::from_file(const boost::filesystem::path& filename)
   }
 }
 
+void
+MaterialParser::prefetch(const boost::filesystem::path& filename)
+{
+  std::ifstream in(filename.string());
+  std::string line;
+  while(std::getline(in, line))
+  {
+    try
+    {
+      std::vector<std::string> args = argument_parse(line);
+      if (!args.empty() &&
+          (args[0] == "material.diffuse_texture" || args[0] == "material.specular_texture"))
+      {
+        for(auto it = args.begin() + 1; it != args.end(); ++it)
+        {
+          TextureCache::get().prefetch(*it);
+        }
+      }
+    }
+    catch(const std::exception&)
+    {
+      // reported by parse()
+    }
+  }
+}
+
 MaterialPtr
 MaterialParser::from_stream(std::istream& in)
 {
@@ -124,13 +155,13 @@ MaterialParser::parse(std::istream& in)
           has_diffuse_texture = true;
           if (args.size() == 2)
           {
-            m_material->set_texture(current_texture_unit, Texture::from_file(to_string(args.begin()+1, args.end())));
+            m_material->set_texture(current_texture_unit, TextureCache::get().from_file(to_string(args.begin()+1, args.end())));
           }
           else if (args.size() == 3)
           {
             m_material->set_texture(current_texture_unit, 
-                                    Texture::from_file(args[1]),
-                                    Texture::from_file(args[2]));
+                                    TextureCache::get().from_file(args[1]),
+                                    TextureCache::get().from_file(args[2]));
           }
           else
           {
@@ -148,7 +179,7 @@ MaterialParser::parse(std::istream& in)
         else if (args[0] == "material.specular_texture")
         {
           has_specular_texture = true;
-          m_material->set_texture(current_texture_unit, Texture::from_file(to_string(args.begin()+1, args.end())));
+          m_material->set_texture(current_texture_unit, TextureCache::get().from_file(to_string(args.begin()+1, args.end())));
           m_material->set_uniform("material.specular_texture", current_texture_unit);
           current_texture_unit += 1;
         }
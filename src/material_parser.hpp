@@ -17,6 +17,10 @@ public:
   static MaterialPtr from_file(const boost::filesystem::path& filename);
   static MaterialPtr from_stream(std::istream& in);
 
+  /** Start decoding the textures used by the material file on the
+      ImageDecoder, errors are left for from_file() to report */
+  static void prefetch(const boost::filesystem::path& filename);
+
   MaterialParser(const std::string& filename);
   void parse(std::istream& in);
   MaterialPtr get_material() { return m_material; }
@@ -20,82 +20,46 @@
 #include <glm/ext.hpp>
 #include <GL/glew.h>
 #include <iostream>
+#include <string.h>
 
 #include "log.hpp"
+#include "mesh_generator.hpp"
+#include "mesh_packing.hpp"
 #include "opengl_state.hpp"
 
 namespace {
 
 } // namespace
 
-std::unique_ptr<Mesh> 
-Mesh::create_skybox(float size)
+std::unique_ptr<Mesh>
+Mesh::create(GLenum primitive_type, const MeshData& data)
 {
-  NormalLst   vn;
-  TexCoordLst vt;
-  VertexLst   vp;
-  
-  float d = size;
-  float t = 1.0f;
-  float n = 1.0f;
-
-  // top
-  vn.emplace_back(-n,  n, -n); 
-  vt.emplace_back(-t,  t, -t); 
-  vp.emplace_back(-d,  d, -d);
-
-  vn.emplace_back( n,  n, -n); 
-  vt.emplace_back( t,  t, -t); 
-  vp.emplace_back( d,  d, -d);
-
-  vn.emplace_back( n,  n,  n); 
-  vt.emplace_back( t,  t,  t);
-  vp.emplace_back( d,  d,  d);
-
-  vn.emplace_back(-n,  n,  n); 
-  vt.emplace_back(-t,  t,  t); 
-  vp.emplace_back(-d,  d,  d);
-
-  // bottom
-  vn.emplace_back(-n, -n, -n);
-  vt.emplace_back(-t, -t, -t);
-  vp.emplace_back(-d, -d, -d);
-
-  vn.emplace_back(-n, -n,  n);
-  vt.emplace_back(-t, -t,  t);
-  vp.emplace_back(-d, -d,  d);
-
-  vn.emplace_back( n, -n,  n);
-  vt.emplace_back( t, -t,  t);
-  vp.emplace_back( d, -d,  d);
-
-  vn.emplace_back( n, -n, -n);
-  vt.emplace_back( t, -t, -t);
-  vp.emplace_back( d, -d, -d);
-
-  // skybox
-  int faces[] = {
-    0, 1, 2, 3, // top
-    4, 5, 6, 7, // bottom
-    3, 2, 6, 5, // front
-    1, 0, 4, 7, // back
-    2, 1, 7, 6, // left 
-    0, 3, 5, 4  // right 
-  };
-
-  // flip front/back faces
-  // std::reverse(faces, faces + sizeof(faces)/sizeof(faces[0]));
+  std::unique_ptr<Mesh> mesh(new Mesh(primitive_type));
 
-  std::unique_ptr<Mesh> mesh(new Mesh(GL_QUADS));
+  mesh->attach_float_array("normal", data.normal);
+  mesh->attach_float_array("texcoord", data.texcoord);
+  mesh->attach_float_array("position", data.position);
+  mesh->set_bounds(AABB::from_points(data.position.data(), data.position.size()));
 
-  mesh->attach_float_array("normal", vn);
-  mesh->attach_float_array("texcoord", vt);
-  mesh->attach_float_array("position", vp);
-  mesh->attach_element_array(FaceLst(faces, faces + sizeof(faces)/sizeof(faces[0])));
+  std::vector<uint16_t> short_index;
+  if (pack_indices(data.index.data(), data.index.size(), short_index))
+  {
+    mesh->attach_element_array(short_index);
+  }
+  else
+  {
+    mesh->attach_element_array(data.index);
+  }
 
   return mesh;
 }
 
+std::unique_ptr<Mesh>
+Mesh::create_skybox(float size)
+{
+  return create(GL_TRIANGLES, generate_skybox(size));
+}
+
 std::unique_ptr<Mesh>
 Mesh::create_plane(float size, glm::vec3 center)
 {
@@ -123,6 +87,7 @@ Mesh::create_plane(float size, glm::vec3 center)
   mesh->attach_float_array("normal", vn);
   mesh->attach_float_array("texcoord", vt);
   mesh->attach_float_array("position", vp);
+  mesh->set_bounds(AABB::from_points(vp.data(), vp.size()));
 
   return mesh;  
 }
@@ -147,6 +112,7 @@ Mesh::create_rect(float x1, float y1, float x2, float y2, float z)
 
   mesh->attach_float_array("texcoord", vt);
   mesh->attach_float_array("position", vp);
+  mesh->set_bounds(AABB::from_points(vp.data(), vp.size()));
 
   return mesh;  
 }
@@ -162,162 +128,164 @@ Mesh::create_cube(float size)
 std::unique_ptr<Mesh>
 Mesh::create_curved_screen(float size, float hfov, float vfov, int rings, int segments, int offset_x, int offset_y, bool flip_uv_x, bool flip_uv_y)
 {
-  std::unique_ptr<Mesh> mesh(new Mesh(GL_QUADS));
-
-  NormalLst   vn;
-  TexCoordLst vt;
-  VertexLst   vp;
-
-  // hfov = 2.0f * glm::pi<float>()
-  // vfov = glm::pi<float>()
-
-  // FIXME: should use indexed array instead to save some vertices
-  auto add_point = [&](int ring, int seg) {
-    float r = static_cast<float>(ring + offset_y) / rings;
-    float s = static_cast<float>(seg + offset_x)  / segments;
-
-    float f = sinf((r-0.5f) * vfov + glm::half_pi<float>());
-    glm::vec3 p(cosf((s-0.5f) * hfov - glm::half_pi<float>()) * f, 
-                cosf((r-0.5f) * vfov + glm::half_pi<float>()),
-                sinf((s-0.5f) * hfov - glm::half_pi<float>()) * f);
-
-    vn.push_back(-p);
-    vt.emplace_back(!flip_uv_x ? s : 1.0f - s, !flip_uv_y ? r : 1.0f - r, 0.0f);
-    vp.push_back(p * size);
-  };
-
-  for(int ring = 0; ring < rings; ++ring)
-  {
-    for(int seg = 0; seg < segments; ++seg)
-    {
-      add_point(ring+1, seg  );
-      add_point(ring+1, seg+1);
-      add_point(ring,   seg+1);
-      add_point(ring,   seg  );
-    }
-  }
-
-  mesh->attach_float_array("normal", vn);
-  mesh->attach_float_array("texcoord", vt);
-  mesh->attach_float_array("position", vp);
-
-  return mesh;  
+  return create(GL_TRIANGLES, generate_curved_screen(size, hfov, vfov, rings, segments,
+                                                     offset_x, offset_y, flip_uv_x, flip_uv_y));
 }
 
 std::unique_ptr<Mesh>
 Mesh::create_sphere(float size, int rings, int segments)
 {
-  std::unique_ptr<Mesh> mesh(new Mesh(GL_QUADS));
-
-  NormalLst   vn;
-  TexCoordLst vt;
-  VertexLst   vp;
-
-  // FIXME: should use indexed array instead to save some vertices
-  auto add_point = [&](int ring, int seg) {
-    float r = static_cast<float>(ring) / rings;
-    float s = static_cast<float>(seg)  / segments;
-
-    float f = sinf(r * glm::pi<float>());
-    glm::vec3 p(cosf(s * 2.0f * glm::pi<float>()) * f, 
-                cosf(r * glm::pi<float>()), 
-                sinf(s * 2.0f * glm::pi<float>()) * f);
-
-    vn.push_back(p);
-    vt.emplace_back(r, s, 0.0f);
-    vp.push_back(p * size);
-  };
-
-  for(int ring = 0; ring < rings; ++ring)
-  {
-    for(int seg = 0; seg < segments; ++seg)
-    {
-      add_point(ring,   seg  );
-      add_point(ring,   seg+1);
-      add_point(ring+1, seg+1);
-      add_point(ring+1, seg  );
-    }
-  }
-
-  mesh->attach_float_array("normal", vn);
-  mesh->attach_float_array("texcoord", vt);
-  mesh->attach_float_array("position", vp);
-
-  return mesh;  
+  return create(GL_TRIANGLES, generate_sphere(size, rings, segments));
 }
 
 Mesh::Mesh(GLenum primitive_type) :
   m_primitive_type(primitive_type),
   m_attribute_arrays(),
+  m_vbos(),
   m_element_array_vbo(0),
-  m_element_count(-1)
+  m_element_type(GL_UNSIGNED_INT),
+  m_element_count(-1),
+  m_gpu_bytes(0),
+  m_vaos(),
+  m_vaos_generation(OpenGLState::get_program_generation()),
+  m_bounds(AABB::infinite())
 {
 }
 
 Mesh::~Mesh()
 {
-  for(const auto& array : m_attribute_arrays)
-  {
-    glDeleteBuffers(1, &array.second.vbo);
-  }
-  glDeleteBuffers(1, &m_element_array_vbo);
+  clear_vaos();
+  OpenGLState::delete_buffers(m_vbos.size(), m_vbos.data());
+  OpenGLState::delete_buffers(1, &m_element_array_vbo);
 }
 
 void
-Mesh::draw() 
+Mesh::attach_interleaved_arrays(const std::vector<Interleaved>& arrays, size_t count)
 {
-  OpenGLState state;
-
-  GLint program;
-  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
-
-  assert_gl("Mesh::draw1");
-  //log_debug("Mesh::draw: %d", program);
+  GLsizei stride = 0;
+  for(const auto& array : arrays)
+  {
+    stride += array.element_size;
+  }
 
-  // activate attribute arrays
-  for(const auto& array : m_attribute_arrays)
+  std::vector<char> buffer(stride * count);
+  size_t offset = 0;
+  for(const auto& array : arrays)
   {
-    int loc = glGetAttribLocation(program, array.first.c_str());
-    if (loc == -1)
+    const char* src = static_cast<const char*>(array.data);
+    for(size_t i = 0; i < count; ++i)
     {
-      //log_error("%s: attribute not found", array.first);
+      memcpy(&buffer[i * stride + offset], src + i * array.element_size, array.element_size);
     }
-    else
-    {
-      glBindBuffer(GL_ARRAY_BUFFER, array.second.vbo);
+    offset += array.element_size;
+  }
+
+  GLuint vbo = build_vbo(GL_ARRAY_BUFFER, buffer.data(), buffer.size());
+
+  offset = 0;
+  for(const auto& array : arrays)
+  {
+    attach_array(array.name,
+                 Array(array.type, array.size, array.component_type, array.normalized, vbo, stride, offset),
+                 count);
+    offset += array.element_size;
+  }
+}
+
+GLuint
+Mesh::get_vao(GLuint program)
+{
+  if (m_vaos_generation != OpenGLState::get_program_generation())
+  {
+    clear_vaos();
+    m_vaos_generation = OpenGLState::get_program_generation();
+  }
 
-      if (array.second.type == Array::Integer)
+  auto it = m_vaos.find(program);
+  if (it != m_vaos.end())
+  {
+    return it->second;
+  }
+  else
+  {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    OpenGLState::bind_vertex_array(vao);
+
+    for(const auto& array : m_attribute_arrays)
+    {
+      int loc = glGetAttribLocation(program, array.first.c_str());
+      if (loc == -1)
       {
-        glVertexAttribIPointer(loc, array.second.size, GL_INT, 0, nullptr);
+        //log_error("%s: attribute not found", array.first);
       }
-      else // if (array.second.type == Array::Float)
+      else
       {
-        glVertexAttribPointer(loc, array.second.size, GL_FLOAT, GL_FALSE, 0, nullptr);
+        const Array& arr = array.second;
+        const GLvoid* offset = reinterpret_cast<const GLvoid*>(arr.offset);
+
+        OpenGLState::bind_buffer(GL_ARRAY_BUFFER, arr.vbo);
+        if (arr.type == Array::Integer)
+        {
+          glVertexAttribIPointer(loc, arr.size, arr.component_type, arr.stride, offset);
+        }
+        else // if (arr.type == Array::Float)
+        {
+          glVertexAttribPointer(loc, arr.size, arr.component_type, arr.normalized, arr.stride, offset);
+        }
+        glEnableVertexAttribArray(loc);
       }
+    }
 
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-      glEnableVertexAttribArray(loc);
+    if (m_element_array_vbo)
+    {
+      OpenGLState::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_element_array_vbo);
     }
+
+    OpenGLState::bind_vertex_array(0);
+    OpenGLState::bind_buffer(GL_ARRAY_BUFFER, 0);
+    OpenGLState::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    assert_gl("Mesh::get_vao");
+
+    m_vaos[program] = vao;
+    return vao;
   }
-  assert_gl("Mesh::draw2");
+}
+
+void
+Mesh::clear_vaos()
+{
+  for(const auto& it : m_vaos)
+  {
+    OpenGLState::delete_vertex_arrays(1, &it.second);
+  }
+  m_vaos.clear();
+}
+
+void
+Mesh::draw()
+{
+  draw(OpenGLState::get_program());
+}
+
+void
+Mesh::draw(GLuint program)
+{
+  // all the attribute and element array state lives in the VAO
+  OpenGLState::bind_vertex_array(get_vao(program));
 
-  // activate element array and draw the mesh
   if (m_element_array_vbo)
   {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_element_array_vbo);
-    assert_gl("Mesh::draw: glBindBuffer");
-    glDrawElements(m_primitive_type, m_element_count, GL_UNSIGNED_INT, 0);
-    assert_gl("Mesh::draw: glDrawElements");
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDrawElements(m_primitive_type, m_element_count, m_element_type, 0);
   }
   else
   {
     glDrawArrays(m_primitive_type, 0, m_element_count);
-    assert_gl("Mesh::draw: glDrawArrays");
   }
 
-  // FIXME: missing glDisableVertexAttribArray()
+  // the VAO stays bound, so consecutive draws of the same mesh don't
+  // rebind it, code that touches vertex array state without a VAO of
+  // its own has to bind 0 first
 }
 
 /* EOF */
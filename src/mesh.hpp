@@ -21,17 +21,17 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <memory>
+#include <stdint.h>
+#include <string>
 #include <unordered_map>
 
+#include "aabb.hpp"
+#include "mesh_data.hpp"
 #include "opengl_state.hpp"
 
-typedef std::vector<glm::vec3>  NormalLst;
-typedef std::vector<glm::vec3>  VertexLst;
-typedef std::vector<glm::vec3>  TexCoordLst;
-typedef std::vector<int>        FaceLst;
-typedef std::vector<glm::vec4>  BoneWeights;
-typedef std::vector<glm::ivec4> BoneIndices;
-typedef std::vector<int>        BoneCounts;
+class Mesh;
+
+typedef std::shared_ptr<Mesh> MeshPtr;
 
 template<typename C> 
 inline size_t glm_vec_length() 
@@ -43,33 +43,132 @@ inline size_t glm_vec_length()
 template<> inline size_t glm_vec_length<glm::vec2>() { return 2; }
 template<> inline size_t glm_vec_length<glm::vec3>() { return 3; }
 template<> inline size_t glm_vec_length<glm::vec4>() { return 4; }
+template<> inline size_t glm_vec_length<glm::ivec2>() { return 2; }
+template<> inline size_t glm_vec_length<glm::ivec3>() { return 3; }
+template<> inline size_t glm_vec_length<glm::ivec4>() { return 4; }
 
 class Mesh
 {
 private:
   struct Array
   {
+    /** Integer arrays are read as ivec in the shader, Float arrays
+        as vec, converted from \a component_type */
     enum Type { Integer, Float } type;
     int size;
+
+    /** GL_FLOAT, GL_INT, GL_HALF_FLOAT, GL_UNSIGNED_SHORT,
+        GL_INT_2_10_10_10_REV, ... */
+    GLenum component_type;
+    GLboolean normalized;
+
     GLuint vbo;
+    GLsizei stride;
+    size_t offset;
+
+    Array() : type(), size(), component_type(), normalized(), vbo(), stride(), offset()
+    {}
 
-    Array() : type(), size(), vbo()
+    Array(Type type_, int size_, GLuint vbo_, GLsizei stride_ = 0, size_t offset_ = 0) :
+      type(type_),
+      size(size_),
+      component_type(type_ == Integer ? GL_INT : GL_FLOAT),
+      normalized(GL_FALSE),
+      vbo(vbo_),
+      stride(stride_),
+      offset(offset_)
+    {}
+
+    Array(Type type_, int size_, GLenum component_type_, GLboolean normalized_,
+          GLuint vbo_, GLsizei stride_ = 0, size_t offset_ = 0) :
+      type(type_),
+      size(size_),
+      component_type(component_type_),
+      normalized(normalized_),
+      vbo(vbo_),
+      stride(stride_),
+      offset(offset_)
     {}
+  };
+
+public:
+  /** One attribute of an interleaved vertex buffer, see
+      attach_interleaved_arrays() */
+  struct Interleaved
+  {
+    std::string name;
+    Array::Type type;
+    int size;
+    GLenum component_type;
+    GLboolean normalized;
+    size_t element_size;
+    const void* data;
 
-    Array(Type type_, int size_, GLuint vbo_) :
+    Interleaved(const std::string& name_, Array::Type type_, int size_,
+                GLenum component_type_, GLboolean normalized_,
+                size_t element_size_, const void* data_) :
+      name(name_),
       type(type_),
       size(size_),
-      vbo(vbo_)
+      component_type(component_type_),
+      normalized(normalized_),
+      element_size(element_size_),
+      data(data_)
     {}
+
+    Interleaved(const Interleaved&) = default;
+    Interleaved& operator=(const Interleaved&) = default;
   };
 
+  template<typename T>
+  static Interleaved interleaved_float(const std::string& name, const T* data)
+  {
+    return Interleaved(name, Array::Float, glm_vec_length<T>(), GL_FLOAT, GL_FALSE, sizeof(T), data);
+  }
+
+  template<typename T>
+  static Interleaved interleaved_int(const std::string& name, const T* data)
+  {
+    return Interleaved(name, Array::Integer, glm_vec_length<T>(), GL_INT, GL_FALSE, sizeof(T), data);
+  }
+
+  /** An attribute with \a size components of \a component_type packed
+      into each T, e.g. a GL_INT_2_10_10_10_REV normal in an uint32_t,
+      it is read as vec in the shader */
+  template<typename T>
+  static Interleaved interleaved_packed(const std::string& name, int size,
+                                        GLenum component_type, GLboolean normalized, const T* data)
+  {
+    return Interleaved(name, Array::Float, size, component_type, normalized, sizeof(T), data);
+  }
+
 private:
   GLenum m_primitive_type;
   std::unordered_map<std::string, Array> m_attribute_arrays;
+  std::vector<GLuint> m_vbos;
   GLuint m_element_array_vbo;
+  GLenum m_element_type;
   int m_element_count;
+
+  /** size of all buffers owned by this mesh */
+  size_t m_gpu_bytes;
+
+  /** vertex array objects by program id, attribute locations differ
+      between programs, so each program gets its own */
+  std::unordered_map<GLuint, GLuint> m_vaos;
+
+  /** OpenGLState::get_program_generation() when m_vaos was filled,
+      program ids in m_vaos may have been reused since it changed */
+  unsigned int m_vaos_generation;
+
+  /** object space bounds of the positions, infinite when unknown */
+  AABB m_bounds;
   
 public:
+  /** Upload \a data as an indexed mesh, with 16 bit indices when
+      possible */
+  static std::unique_ptr<Mesh> create(GLenum primitive_type, const MeshData& data);
+
   /** Create a cube with cubemap texture coordinates */
   static std::unique_ptr<Mesh> create_skybox(float size);
   static std::unique_ptr<Mesh> create_plane(float size, glm::vec3 center = glm::vec3(0.0f, 0.0f, 0.0f));
@@ -84,8 +183,24 @@ public:
   Mesh(GLenum primitive_type);
   ~Mesh();
 
+  /** Draw with the currently active program */
   void draw();
 
+  /** Draw with \a program, which must be the active program */
+  void draw(GLuint program);
+
+  /** Upload all \a arrays, each holding \a count elements, into a
+      single VBO with the attributes interleaved per vertex */
+  void attach_interleaved_arrays(const std::vector<Interleaved>& arrays, size_t count);
+
+  /** Bytes of vertex and index data uploaded for this mesh */
+  size_t get_gpu_bytes() const { return m_gpu_bytes; }
+
+  /** The mesh doesn't look at the arrays it gets, whoever attaches the
+      positions is expected to set the bounds for culling */
+  void set_bounds(const AABB& bounds) { m_bounds = bounds; }
+  const AABB& get_bounds() const { return m_bounds; }
+
   void attach_array(const std::string& name, const Array& array, int element_count)
   {
     if (m_attribute_arrays.find(name) != m_attribute_arrays.end())
@@ -100,36 +215,91 @@ public:
     {
       m_element_count = element_count;
       m_attribute_arrays[name] = array;
+      clear_vaos();
     }
   }
 
   void attach_float_array(const std::string& name, const std::vector<float>& vec)
   {
-    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, vec);
-    attach_array(name, Array(Array::Float, 1, vbo), vec.size());
+    attach_float_array(name, vec.data(), vec.size());
   }
 
   template<typename T>  
   void attach_float_array(const std::string& name, const std::vector<T>& vec)
   {
-    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, vec);
-    attach_array(name, Array(Array::Float, glm_vec_length<T>(), vbo), vec.size());
+    attach_float_array(name, vec.data(), vec.size());
+  }
+
+  void attach_float_array(const std::string& name, const float* data, size_t count)
+  {
+    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, data, count);
+    attach_array(name, Array(Array::Float, 1, vbo), count);
+  }
+
+  template<typename T>  
+  void attach_float_array(const std::string& name, const T* data, size_t count)
+  {
+    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, data, count);
+    attach_array(name, Array(Array::Float, glm_vec_length<T>(), vbo), count);
   }
 
   void attach_int_array(const std::string& name, const std::vector<int>& vec)
   {
-    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, vec);
-    attach_array(name, Array(Array::Integer, 1, vbo), vec.size());
+    attach_int_array(name, vec.data(), vec.size());
   }
 
   template<typename T>  
   void attach_int_array(const std::string& name, const std::vector<T>& vec)
   {
-    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, vec);
-    attach_array(name, Array(Array::Integer, glm_vec_length<T>(), vbo), vec.size());
+    attach_int_array(name, vec.data(), vec.size());
+  } 
+
+  void attach_int_array(const std::string& name, const int* data, size_t count)
+  {
+    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, data, count);
+    attach_array(name, Array(Array::Integer, 1, vbo), count);
+  }
+
+  template<typename T>  
+  void attach_int_array(const std::string& name, const T* data, size_t count)
+  {
+    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, data, count);
+    attach_array(name, Array(Array::Integer, glm_vec_length<T>(), vbo), count);
   } 
 
+  /** Attach \a count elements of T, each holding an attribute with
+      \a size components of \a component_type, see interleaved_packed() */
+  template<typename T>
+  void attach_packed_array(const std::string& name, int size, GLenum component_type, GLboolean normalized,
+                           const T* data, size_t count)
+  {
+    GLuint vbo = build_vbo(GL_ARRAY_BUFFER, data, count);
+    attach_array(name, Array(Array::Float, size, component_type, normalized, vbo), count);
+  }
+
   void attach_element_array(const std::vector<int>& vec)
+  {
+    attach_element_array(vec.data(), vec.size());
+  }
+
+  void attach_element_array(const int* data, size_t count)
+  {
+    attach_element_array(GL_UNSIGNED_INT, data, count);
+  }
+
+  void attach_element_array(const std::vector<uint16_t>& vec)
+  {
+    attach_element_array(vec.data(), vec.size());
+  }
+
+  void attach_element_array(const uint16_t* data, size_t count)
+  {
+    attach_element_array(GL_UNSIGNED_SHORT, data, count);
+  }
+
+private:
+  template<typename T>
+  void attach_element_array(GLenum type, const T* data, size_t count)
   {
     if (m_element_array_vbo != 0)
     {
@@ -137,20 +307,37 @@ public:
     }
     else
     {
-      m_element_array_vbo = build_vbo(GL_ELEMENT_ARRAY_BUFFER, vec);
-      m_element_count = vec.size();
+      m_element_array_vbo = build_vbo(GL_ELEMENT_ARRAY_BUFFER, data, count);
+      m_element_type = type;
+      m_element_count = count;
+      clear_vaos();
     }
   }
 
-private:
+
+  GLuint get_vao(GLuint program);
+  void clear_vaos();
+
   template<typename T>
-  GLuint build_vbo(GLenum target, const std::vector<T>& vec)
+  GLuint build_vbo(GLenum target, const T* data, size_t count)
   {
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+      // the element array binding is part of the VAO, don't change
+      // the one a previous draw left bound
+      OpenGLState::bind_vertex_array(0);
+    }
+
     GLuint vbo;
     glGenBuffers(1, &vbo);
-    glBindBuffer(target, vbo);
-    glBufferData(target, sizeof(T) * vec.size(), vec.data(), GL_STATIC_DRAW);
-    glBindBuffer(target, 0);
+    OpenGLState::bind_buffer(target, vbo);
+    glBufferData(target, sizeof(T) * count, data, GL_STATIC_DRAW);
+    OpenGLState::bind_buffer(target, 0);
+    m_gpu_bytes += sizeof(T) * count;
+    if (target == GL_ARRAY_BUFFER)
+    {
+      m_vbos.push_back(vbo);
+    }
     return vbo;
   }
 
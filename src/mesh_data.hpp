@@ -0,0 +1,70 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_MESH_DATA_HPP
+#define HEADER_MESH_DATA_HPP
+
+#include <vector>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+typedef std::vector<glm::vec3>  NormalLst;
+typedef std::vector<glm::vec3>  VertexLst;
+typedef std::vector<glm::vec3>  TexCoordLst;
+typedef std::vector<int>        FaceLst;
+typedef std::vector<glm::vec4>  BoneWeights;
+typedef std::vector<glm::ivec4> BoneIndices;
+typedef std::vector<int>        BoneCounts;
+
+/** CPU side vertex and index data of a single mesh, no OpenGL
+    resources are involved, so it can be filled from any thread */
+struct MeshData
+{
+  VertexLst   position;
+  NormalLst   normal;
+  TexCoordLst texcoord;
+  FaceLst     index;
+  BoneWeights bone_weight;
+  BoneIndices bone_index;
+
+  MeshData() :
+    position(),
+    normal(),
+    texcoord(),
+    index(),
+    bone_weight(),
+    bone_index()
+  {}
+
+  bool has_bones() const
+  {
+    return !bone_weight.empty() && !bone_index.empty();
+  }
+
+  void clear()
+  {
+    position.clear();
+    normal.clear();
+    texcoord.clear();
+    index.clear();
+    bone_weight.clear();
+    bone_index.clear();
+  }
+};
+
+#endif
+
+/* EOF */
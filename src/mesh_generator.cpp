@@ -0,0 +1,208 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "mesh_generator.hpp"
+
+#define GLM_FORCE_RADIANS
+#include <glm/ext.hpp>
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+/** Index of the vertex at \a ring and \a seg in a grid with \a
+    segments + 1 vertices per ring */
+int grid_index(int ring, int seg, int segments)
+{
+  return ring * (segments + 1) + seg;
+}
+
+void add_triangle(MeshData& mesh, int a, int b, int c)
+{
+  mesh.index.push_back(a);
+  mesh.index.push_back(b);
+  mesh.index.push_back(c);
+}
+
+} // namespace
+
+MeshData
+generate_skybox(float size)
+{
+  MeshData mesh;
+
+  float d = size;
+  float t = 1.0f;
+  float n = 1.0f;
+
+  const glm::vec3 corners[] = {
+    // top
+    glm::vec3(-1,  1, -1), glm::vec3( 1,  1, -1), glm::vec3( 1,  1,  1), glm::vec3(-1,  1,  1),
+    // bottom
+    glm::vec3(-1, -1, -1), glm::vec3(-1, -1,  1), glm::vec3( 1, -1,  1), glm::vec3( 1, -1, -1)
+  };
+
+  for(const auto& c : corners)
+  {
+    mesh.normal.push_back(c * n);
+    mesh.texcoord.push_back(c * t);
+    mesh.position.push_back(c * d);
+  }
+
+  const int faces[] = {
+    0, 1, 2, 3, // top
+    4, 5, 6, 7, // bottom
+    3, 2, 6, 5, // front
+    1, 0, 4, 7, // back
+    2, 1, 7, 6, // left
+    0, 3, 5, 4  // right
+  };
+
+  for(size_t i = 0; i < sizeof(faces) / sizeof(faces[0]); i += 4)
+  {
+    add_triangle(mesh, faces[i], faces[i+1], faces[i+2]);
+    add_triangle(mesh, faces[i], faces[i+2], faces[i+3]);
+  }
+
+  return mesh;
+}
+
+MeshData
+generate_sphere(float size, int rings, int segments)
+{
+  MeshData mesh;
+
+  for(int ring = 0; ring <= rings; ++ring)
+  {
+    for(int seg = 0; seg <= segments; ++seg)
+    {
+      float r = static_cast<float>(ring) / rings;
+      float s = static_cast<float>(seg)  / segments;
+
+      float f = sinf(r * glm::pi<float>());
+      glm::vec3 p(cosf(s * 2.0f * glm::pi<float>()) * f,
+                  cosf(r * glm::pi<float>()),
+                  sinf(s * 2.0f * glm::pi<float>()) * f);
+
+      mesh.normal.push_back(p);
+      mesh.texcoord.emplace_back(r, s, 0.0f);
+      mesh.position.push_back(p * size);
+    }
+  }
+
+  for(int ring = 0; ring < rings; ++ring)
+  {
+    for(int seg = 0; seg < segments; ++seg)
+    {
+      int a = grid_index(ring,   seg,   segments);
+      int b = grid_index(ring,   seg+1, segments);
+      int c = grid_index(ring+1, seg+1, segments);
+      int d = grid_index(ring+1, seg,   segments);
+
+      // the quads touching the poles collapse into a single triangle
+      if (ring != 0)
+      {
+        add_triangle(mesh, a, b, c);
+      }
+      if (ring != rings - 1)
+      {
+        add_triangle(mesh, a, c, d);
+      }
+    }
+  }
+
+  return mesh;
+}
+
+MeshData
+generate_curved_screen(float size, float hfov, float vfov, int rings, int segments,
+                       int offset_x, int offset_y,
+                       bool flip_uv_x, bool flip_uv_y)
+{
+  MeshData mesh;
+
+  // radius of the ring, zero at the poles
+  auto ring_radius = [&](int ring) {
+    float r = static_cast<float>(ring + offset_y) / rings;
+    return sinf((r-0.5f) * vfov + glm::half_pi<float>());
+  };
+
+  for(int ring = 0; ring <= rings; ++ring)
+  {
+    for(int seg = 0; seg <= segments; ++seg)
+    {
+      float r = static_cast<float>(ring + offset_y) / rings;
+      float s = static_cast<float>(seg + offset_x)  / segments;
+
+      float f = ring_radius(ring);
+      glm::vec3 p(cosf((s-0.5f) * hfov - glm::half_pi<float>()) * f,
+                  cosf((r-0.5f) * vfov + glm::half_pi<float>()),
+                  sinf((s-0.5f) * hfov - glm::half_pi<float>()) * f);
+
+      mesh.normal.push_back(-p);
+      mesh.texcoord.emplace_back(!flip_uv_x ? s : 1.0f - s, !flip_uv_y ? r : 1.0f - r, 0.0f);
+      mesh.position.push_back(p * size);
+    }
+  }
+
+  for(int ring = 0; ring < rings; ++ring)
+  {
+    for(int seg = 0; seg < segments; ++seg)
+    {
+      int a = grid_index(ring+1, seg,   segments);
+      int b = grid_index(ring+1, seg+1, segments);
+      int c = grid_index(ring,   seg+1, segments);
+      int d = grid_index(ring,   seg,   segments);
+
+      // the quads touching a pole collapse into a single triangle
+      if (fabsf(ring_radius(ring+1)) > 1e-6f)
+      {
+        add_triangle(mesh, a, b, c);
+      }
+      if (fabsf(ring_radius(ring)) > 1e-6f)
+      {
+        add_triangle(mesh, a, c, d);
+      }
+    }
+  }
+
+  return mesh;
+}
+
+int
+lod_segments(float pixel_radius, float tolerance, int min_segments, int max_segments)
+{
+  if (pixel_radius <= tolerance)
+  {
+    return min_segments;
+  }
+  else
+  {
+    // a chord spanning an angle of 2*pi/n is at most r*(1-cos(pi/n))
+    // away from the circle
+    float n = glm::pi<float>() / acosf(1.0f - tolerance / pixel_radius);
+
+    int segments = min_segments;
+    while(segments < n && segments < max_segments)
+    {
+      segments *= 2;
+    }
+    return std::min(segments, max_segments);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,49 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_MESH_GENERATOR_HPP
+#define HEADER_MESH_GENERATOR_HPP
+
+#include "mesh_data.hpp"
+
+/** Indexed triangle lists for the builtin shapes, neighbouring quads
+    share their vertices, only the texture seam is duplicated. No
+    OpenGL calls are made, see Mesh::create_sphere() and friends for
+    the uploaded versions. */
+
+/** Cube with cubemap texture coordinates */
+MeshData generate_skybox(float size);
+
+MeshData generate_sphere(float size, int rings, int segments);
+
+/** Part of a sphere seen from the inside, \a hfov and \a vfov give
+    the covered angles, \a offset_x and \a offset_y shift it by whole
+    segments and rings */
+MeshData generate_curved_screen(float size, float hfov, float vfov, int rings, int segments,
+                                int offset_x, int offset_y,
+                                bool flip_uv_x, bool flip_uv_y);
+
+/** Number of segments a sphere with a projected radius of \a
+    pixel_radius needs so its silhouette deviates by no more than \a
+    tolerance pixels from the real one, rounded up to a power of two
+    and clamped to [min_segments, max_segments] */
+int lod_segments(float pixel_radius, float tolerance = 0.5f,
+                 int min_segments = 8, int max_segments = 128);
+
+#endif
+
+/* EOF */
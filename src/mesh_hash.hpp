@@ -0,0 +1,138 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_MESH_HASH_HPP
+#define HEADER_MESH_HASH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mesh_data.hpp"
+
+/** 64 bit content hash over the arrays of a mesh, used to find meshes
+    with identical vertex data. The arrays have to be added in the same
+    order for the hashes to be comparable. A second, independent 64 bit
+    hash and the total size go into get_key(), which is what caches
+    should compare instead of the data itself. */
+class MeshHash
+{
+public:
+  struct Key
+  {
+    uint64_t hash;
+    uint64_t hash2;
+    size_t bytes;
+
+    bool operator==(const Key& rhs) const
+    {
+      return hash == rhs.hash && hash2 == rhs.hash2 && bytes == rhs.bytes;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+  };
+
+private:
+  uint64_t m_hash;
+  uint64_t m_hash2;
+  size_t m_bytes;
+
+public:
+  MeshHash() :
+    m_hash(14695981039346656037ull),
+    m_hash2(0x9e3779b97f4a7c15ull),
+    m_bytes(0)
+  {}
+
+  template<typename T>
+  void add(const T* data, size_t count)
+  {
+    add_bytes(data, sizeof(T) * count);
+  }
+
+  uint64_t get() const { return m_hash; }
+
+  Key get_key() const
+  {
+    Key key;
+    key.hash = m_hash;
+    key.hash2 = m_hash2;
+    key.bytes = m_bytes;
+    return key;
+  }
+
+  /** Total size of the arrays, which is what the mesh takes on the GPU */
+  size_t get_bytes() const { return m_bytes; }
+
+private:
+  void add_bytes(const void* data, size_t len)
+  {
+    // the length goes in too, so the split between arrays matters
+    mix(len);
+
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i + 8 <= len; i += 8)
+    {
+      uint64_t word;
+      memcpy(&word, p + i, 8);
+      mix(word);
+    }
+
+    if (len % 8 != 0)
+    {
+      uint64_t tail = 0;
+      memcpy(&tail, p + len / 8 * 8, len % 8);
+      mix(tail);
+    }
+
+    m_bytes += len;
+  }
+
+  void mix(uint64_t word)
+  {
+    m_hash = (m_hash ^ word) * 1099511628211ull;
+    m_hash ^= m_hash >> 32;
+
+    // different multiplier and rotation, so the two don't collide on
+    // the same inputs
+    m_hash2 = (m_hash2 + word) * 0xc2b2ae3d27d4eb4full;
+    m_hash2 = (m_hash2 << 31) | (m_hash2 >> 33);
+  }
+};
+
+/** Hashes the arrays in the order Scene uploads them */
+inline MeshHash hash_mesh(const MeshData& data)
+{
+  MeshHash hash;
+  hash.add(data.position.data(), data.position.size());
+  hash.add(data.texcoord.data(), data.texcoord.size());
+  hash.add(data.normal.data(), data.normal.size());
+  hash.add(data.index.data(), data.index.size());
+  if (data.has_bones())
+  {
+    hash.add(data.bone_weight.data(), data.bone_weight.size());
+    hash.add(data.bone_index.data(), data.bone_index.size());
+  }
+  return hash;
+}
+
+#endif
+
+/* EOF */
@@ -0,0 +1,447 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+#include <string.h>
+#include <unordered_map>
+
+#include "format.hpp"
+#include "mesh_hash.hpp"
+
+namespace {
+
+/** Refers to a vertex in a MeshData, so the map doesn't need copies */
+struct VertexRef
+{
+  const MeshData* mesh;
+  size_t index;
+
+  VertexRef(const MeshData* mesh_, size_t index_) :
+    mesh(mesh_),
+    index(index_)
+  {}
+
+  VertexRef(const VertexRef&) = default;
+  VertexRef& operator=(const VertexRef&) = default;
+};
+
+template<typename T>
+bool same(const std::vector<T>& vec, size_t a, size_t b)
+{
+  return memcmp(&vec[a], &vec[b], sizeof(T)) == 0;
+}
+
+struct VertexRefHash
+{
+  size_t operator()(const VertexRef& v) const
+  {
+    const MeshData& mesh = *v.mesh;
+    MeshHash hash;
+    hash.add(&mesh.position[v.index], 1);
+    hash.add(&mesh.normal[v.index], 1);
+    hash.add(&mesh.texcoord[v.index], 1);
+    if (mesh.has_bones())
+    {
+      hash.add(&mesh.bone_weight[v.index], 1);
+      hash.add(&mesh.bone_index[v.index], 1);
+    }
+    return static_cast<size_t>(hash.get());
+  }
+};
+
+struct VertexRefEqual
+{
+  bool operator()(const VertexRef& lhs, const VertexRef& rhs) const
+  {
+    const MeshData& mesh = *lhs.mesh;
+    return
+      same(mesh.position, lhs.index, rhs.index) &&
+      same(mesh.normal, lhs.index, rhs.index) &&
+      same(mesh.texcoord, lhs.index, rhs.index) &&
+      (!mesh.has_bones() ||
+       (same(mesh.bone_weight, lhs.index, rhs.index) &&
+        same(mesh.bone_index, lhs.index, rhs.index)));
+  }
+};
+
+// tuning values from Forsyth's article
+const int   g_forsyth_cache_size = 32;
+const float g_forsyth_cache_decay_power = 1.5f;
+const float g_forsyth_last_tri_score = 0.75f;
+const float g_forsyth_valence_boost_scale = 2.0f;
+const float g_forsyth_valence_boost_power = 0.5f;
+
+float forsyth_vertex_score(int cache_position, int remaining_triangles)
+{
+  if (remaining_triangles == 0)
+  {
+    // no triangle needs this vertex anymore
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cache_position < 0)
+  {
+    // not in the cache
+  }
+  else if (cache_position < 3)
+  {
+    // used by the last triangle, fixed score so the triangle order
+    // doesn't depend on the order of its vertices
+    score = g_forsyth_last_tri_score;
+  }
+  else
+  {
+    const float scale = 1.0f / (g_forsyth_cache_size - 3);
+    score = powf(1.0f - static_cast<float>(cache_position - 3) * scale, g_forsyth_cache_decay_power);
+  }
+
+  // favor vertices with few triangles left, to get rid of lone triangles
+  score += g_forsyth_valence_boost_scale * powf(static_cast<float>(remaining_triangles),
+                                                -g_forsyth_valence_boost_power);
+  return score;
+}
+
+bool check_triangles(const MeshData& mesh)
+{
+  if (mesh.index.size() % 3 != 0)
+  {
+    return false;
+  }
+
+  check_vertex_indices(mesh.index, mesh.position.size());
+  return true;
+}
+
+template<typename T>
+void reorder(std::vector<T>& vec, const std::vector<int>& remap)
+{
+  if (!vec.empty())
+  {
+    std::vector<T> result(vec.size());
+    for(size_t i = 0; i < vec.size(); ++i)
+    {
+      result[remap[i]] = vec[i];
+    }
+    vec.swap(result);
+  }
+}
+
+} // namespace
+
+size_t
+weld_vertices(MeshData& mesh)
+{
+  const size_t count = mesh.position.size();
+
+  if (mesh.normal.size() != count ||
+      mesh.texcoord.size() != count ||
+      (mesh.has_bones() && (mesh.bone_weight.size() != count || mesh.bone_index.size() != count)))
+  {
+    return count;
+  }
+
+  // remap[i] is the new index of vertex i, unique[i] whether vertex i
+  // is the first of its kind
+  std::vector<int> remap(count);
+  std::vector<bool> unique(count);
+  std::unordered_map<VertexRef, int, VertexRefHash, VertexRefEqual> vertices(count);
+
+  int next = 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    auto it = vertices.insert(std::make_pair(VertexRef(&mesh, i), next));
+    remap[i] = it.first->second;
+    if (it.second)
+    {
+      unique[i] = true;
+      next += 1;
+    }
+  }
+
+  if (static_cast<size_t>(next) == count)
+  {
+    return count;
+  }
+
+  check_vertex_indices(mesh.index, count);
+
+  // new indices are handed out in order of first occurrence, so
+  // remap[i] <= i and the arrays can be compacted in place
+  for(size_t i = 0; i < count; ++i)
+  {
+    if (unique[i])
+    {
+      const size_t dst = remap[i];
+      mesh.position[dst] = mesh.position[i];
+      mesh.normal[dst] = mesh.normal[i];
+      mesh.texcoord[dst] = mesh.texcoord[i];
+      if (mesh.has_bones())
+      {
+        mesh.bone_weight[dst] = mesh.bone_weight[i];
+        mesh.bone_index[dst] = mesh.bone_index[i];
+      }
+    }
+  }
+
+  for(auto& idx : mesh.index)
+  {
+    idx = remap[idx];
+  }
+
+  mesh.position.resize(next);
+  mesh.normal.resize(next);
+  mesh.texcoord.resize(next);
+  if (mesh.has_bones())
+  {
+    mesh.bone_weight.resize(next);
+    mesh.bone_index.resize(next);
+  }
+
+  return next;
+}
+
+void
+check_vertex_indices(const FaceLst& index, size_t vertex_count)
+{
+  for(const auto& idx : index)
+  {
+    if (idx < 0 || static_cast<size_t>(idx) >= vertex_count)
+    {
+      throw std::runtime_error(format("vertex index out of range: %d", idx));
+    }
+  }
+}
+
+VertexCacheStats
+analyze_vertex_cache(const FaceLst& index, size_t vertex_count, int cache_size)
+{
+  VertexCacheStats stats;
+  if (index.size() < 3 || vertex_count == 0)
+  {
+    return stats;
+  }
+
+  check_vertex_indices(index, vertex_count);
+
+  // FIFO cache, timestamp[v] is the transform count at which v entered it
+  std::vector<int> timestamp(vertex_count, -cache_size - 1);
+  int transforms = 0;
+  for(const auto& idx : index)
+  {
+    if (transforms - timestamp[idx] > cache_size)
+    {
+      timestamp[idx] = transforms;
+      transforms += 1;
+    }
+  }
+
+  stats.acmr = static_cast<float>(transforms) / static_cast<float>(index.size() / 3);
+  stats.atvr = static_cast<float>(transforms) / static_cast<float>(vertex_count);
+  return stats;
+}
+
+void
+optimize_vertex_cache(MeshData& mesh)
+{
+  if (!check_triangles(mesh) || mesh.index.empty())
+  {
+    return;
+  }
+
+  const size_t vertex_count = mesh.position.size();
+  const size_t triangle_count = mesh.index.size() / 3;
+
+  // triangles using each vertex, the first remaining[v] entries of a
+  // vertex are the ones not yet emitted
+  std::vector<int> remaining(vertex_count, 0);
+  for(const auto& idx : mesh.index)
+  {
+    remaining[idx] += 1;
+  }
+
+  std::vector<int> offsets(vertex_count + 1, 0);
+  for(size_t v = 0; v < vertex_count; ++v)
+  {
+    offsets[v + 1] = offsets[v] + remaining[v];
+  }
+
+  std::vector<int> adjacency(mesh.index.size());
+  {
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for(size_t i = 0; i < mesh.index.size(); ++i)
+    {
+      adjacency[fill[mesh.index[i]]++] = static_cast<int>(i / 3);
+    }
+  }
+
+  std::vector<int> cache_position(vertex_count, -1);
+  std::vector<float> vertex_score(vertex_count);
+  for(size_t v = 0; v < vertex_count; ++v)
+  {
+    vertex_score[v] = forsyth_vertex_score(-1, remaining[v]);
+  }
+
+  std::vector<float> triangle_score(triangle_count);
+  std::vector<bool> emitted(triangle_count, false);
+  for(size_t t = 0; t < triangle_count; ++t)
+  {
+    triangle_score[t] =
+      vertex_score[mesh.index[3*t + 0]] +
+      vertex_score[mesh.index[3*t + 1]] +
+      vertex_score[mesh.index[3*t + 2]];
+  }
+
+  FaceLst result;
+  result.reserve(mesh.index.size());
+
+  std::vector<int> cache;
+  std::vector<int> new_cache;
+  cache.reserve(g_forsyth_cache_size + 3);
+  new_cache.reserve(g_forsyth_cache_size + 3);
+
+  int best = static_cast<int>(std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+  size_t scan_start = 0;
+
+  while(best >= 0)
+  {
+    emitted[best] = true;
+
+    const int* tri = &mesh.index[3 * best];
+    new_cache.assign(tri, tri + 3);
+    for(int i = 0; i < 3; ++i)
+    {
+      result.push_back(tri[i]);
+
+      // drop the triangle from the vertex's remaining ones
+      int v = tri[i];
+      int* begin = &adjacency[offsets[v]];
+      int* end = begin + remaining[v];
+      std::iter_swap(std::find(begin, end, best), end - 1);
+      remaining[v] -= 1;
+    }
+
+    for(const auto& v : cache)
+    {
+      if (v != tri[0] && v != tri[1] && v != tri[2])
+      {
+        new_cache.push_back(v);
+      }
+    }
+
+    // rescore everything that moved in the cache, including the
+    // vertices that just dropped out of it
+    for(size_t i = 0; i < new_cache.size(); ++i)
+    {
+      int v = new_cache[i];
+      cache_position[v] = (static_cast<int>(i) < g_forsyth_cache_size) ? static_cast<int>(i) : -1;
+      vertex_score[v] = forsyth_vertex_score(cache_position[v], remaining[v]);
+    }
+
+    best = -1;
+    float best_score = -1.0f;
+    for(const auto& v : new_cache)
+    {
+      for(int j = offsets[v]; j < offsets[v] + remaining[v]; ++j)
+      {
+        int t = adjacency[j];
+        triangle_score[t] =
+          vertex_score[mesh.index[3*t + 0]] +
+          vertex_score[mesh.index[3*t + 1]] +
+          vertex_score[mesh.index[3*t + 2]];
+
+        if (triangle_score[t] > best_score)
+        {
+          best_score = triangle_score[t];
+          best = t;
+        }
+      }
+    }
+
+    if (new_cache.size() > static_cast<size_t>(g_forsyth_cache_size))
+    {
+      new_cache.resize(g_forsyth_cache_size);
+    }
+    cache.swap(new_cache);
+
+    if (best < 0)
+    {
+      // nothing in the cache has triangles left, continue with the
+      // next unconnected piece of the mesh
+      while(scan_start < triangle_count && emitted[scan_start])
+      {
+        scan_start += 1;
+      }
+      if (scan_start < triangle_count)
+      {
+        best = static_cast<int>(scan_start);
+      }
+    }
+  }
+
+  mesh.index.swap(result);
+}
+
+void
+optimize_vertex_fetch(MeshData& mesh)
+{
+  if (!check_triangles(mesh))
+  {
+    return;
+  }
+
+  const size_t vertex_count = mesh.position.size();
+
+  if ((!mesh.normal.empty() && mesh.normal.size() != vertex_count) ||
+      (!mesh.texcoord.empty() && mesh.texcoord.size() != vertex_count) ||
+      (!mesh.bone_weight.empty() && mesh.bone_weight.size() != vertex_count) ||
+      (!mesh.bone_index.empty() && mesh.bone_index.size() != vertex_count))
+  {
+    return;
+  }
+
+  std::vector<int> remap(vertex_count, -1);
+  int next = 0;
+  for(auto& idx : mesh.index)
+  {
+    if (remap[idx] < 0)
+    {
+      remap[idx] = next++;
+    }
+    idx = remap[idx];
+  }
+
+  for(auto& r : remap)
+  {
+    if (r < 0)
+    {
+      r = next++;
+    }
+  }
+
+  reorder(mesh.position, remap);
+  reorder(mesh.normal, remap);
+  reorder(mesh.texcoord, remap);
+  reorder(mesh.bone_weight, remap);
+  reorder(mesh.bone_index, remap);
+}
+
+/* EOF */
@@ -0,0 +1,63 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_MESH_OPTIMIZER_HPP
+#define HEADER_MESH_OPTIMIZER_HPP
+
+#include <stddef.h>
+
+#include "mesh_data.hpp"
+
+/** Merge vertices that are identical in all their attributes and
+    rewrite the index list accordingly. Meshes whose attribute arrays
+    differ in length are left alone. Returns the new vertex count. */
+size_t weld_vertices(MeshData& mesh);
+
+/** Result of running an index list through a simulated FIFO
+    post-transform vertex cache */
+struct VertexCacheStats
+{
+  /** average cache miss ratio: transformed vertices per triangle,
+      between 0.5 (ideal) and 3.0 (no reuse at all) */
+  float acmr;
+
+  /** average transform to vertex ratio: transformed vertices per
+      vertex, 1.0 is ideal */
+  float atvr;
+
+  VertexCacheStats() : acmr(), atvr() {}
+};
+
+/** Throws std::runtime_error when an index doesn't refer to one of
+    the \a vertex_count vertices */
+void check_vertex_indices(const FaceLst& index, size_t vertex_count);
+
+/** Returns empty stats for less than one triangle */
+VertexCacheStats analyze_vertex_cache(const FaceLst& index, size_t vertex_count, int cache_size = 16);
+
+/** Reorder the triangles for post-transform vertex cache reuse, using
+    Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" */
+void optimize_vertex_cache(MeshData& mesh);
+
+/** Reorder the vertices in the order they are first referenced by the
+    index list, so vertex fetches walk through memory linearly.
+    Unreferenced vertices are moved to the end. */
+void optimize_vertex_fetch(MeshData& mesh);
+
+#endif
+
+/* EOF */
@@ -0,0 +1,156 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "mesh_packing.hpp"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+uint32_t pack_snorm10(float v)
+{
+  int i = static_cast<int>(roundf(glm::clamp(v, -1.0f, 1.0f) * 511.0f));
+  return static_cast<uint32_t>(i) & 0x3ff;
+}
+
+float unpack_snorm10(uint32_t v)
+{
+  // sign extend from 10 bits
+  int i = static_cast<int>(v << 22) >> 22;
+  return std::max(static_cast<float>(i) / 511.0f, -1.0f);
+}
+
+/** beyond this the step between two half floats is 1/32 of the
+    texture or more */
+const float s_max_half_texcoord = 32.0f;
+
+uint32_t pack_bone_weight(const glm::vec4& weight)
+{
+  glm::vec4 w = glm::clamp(weight, 0.0f, 1.0f);
+
+  int bytes[4];
+  int sum = 0;
+  int largest = 0;
+  for(int k = 0; k < 4; ++k)
+  {
+    bytes[k] = static_cast<int>(roundf(w[k] * 255.0f));
+    sum += bytes[k];
+    if (bytes[k] > bytes[largest])
+    {
+      largest = k;
+    }
+  }
+
+  int total = static_cast<int>(roundf((w.x + w.y + w.z + w.w) * 255.0f));
+  bytes[largest] = glm::clamp(bytes[largest] + total - sum, 0, 255);
+
+  return
+    (static_cast<uint32_t>(bytes[0]) <<  0) |
+    (static_cast<uint32_t>(bytes[1]) <<  8) |
+    (static_cast<uint32_t>(bytes[2]) << 16) |
+    (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+} // namespace
+
+uint32_t
+pack_normal(const glm::vec3& normal)
+{
+  return
+    (pack_snorm10(normal.x) <<  0) |
+    (pack_snorm10(normal.y) << 10) |
+    (pack_snorm10(normal.z) << 20);
+}
+
+glm::vec3
+unpack_normal(uint32_t packed)
+{
+  return glm::vec3(unpack_snorm10(packed >>  0),
+                   unpack_snorm10(packed >> 10),
+                   unpack_snorm10(packed >> 20));
+}
+
+TexcoordEncoding
+pack_texcoords(const glm::vec3* texcoord, size_t count, std::vector<uint32_t>& out)
+{
+  bool unorm = std::all_of(texcoord, texcoord + count, [](const glm::vec3& uv){
+      return
+        0.0f <= uv.x && uv.x <= 1.0f &&
+        0.0f <= uv.y && uv.y <= 1.0f;
+    });
+
+  bool half = unorm || std::all_of(texcoord, texcoord + count, [](const glm::vec3& uv){
+      return
+        fabsf(uv.x) <= s_max_half_texcoord &&
+        fabsf(uv.y) <= s_max_half_texcoord;
+    });
+
+  if (!half)
+  {
+    out.clear();
+    return TexcoordEncoding::Float;
+  }
+  else
+  {
+    out.resize(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+      glm::vec2 uv(texcoord[i].x, texcoord[i].y);
+      out[i] = unorm ? glm::packUnorm2x16(uv) : glm::packHalf2x16(uv);
+    }
+
+    return unorm ? TexcoordEncoding::Unorm16 : TexcoordEncoding::Half;
+  }
+}
+
+void
+pack_normals(const glm::vec3* normal, size_t count, std::vector<uint32_t>& out)
+{
+  out.resize(count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = pack_normal(normal[i]);
+  }
+}
+
+void
+pack_bone_weights(const glm::vec4* weight, size_t count, std::vector<uint32_t>& out)
+{
+  out.resize(count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = pack_bone_weight(weight[i]);
+  }
+}
+
+bool
+pack_indices(const int* index, size_t count, std::vector<uint16_t>& out)
+{
+  out.clear();
+  if (std::any_of(index, index + count, [](int i){ return i < 0 || i > 0xffff; }))
+  {
+    return false;
+  }
+  else
+  {
+    out.assign(index, index + count);
+    return true;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,68 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_MESH_PACKING_HPP
+#define HEADER_MESH_PACKING_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/** Compact encodings of vertex attributes as they are handed to
+    glVertexAttribPointer(), no OpenGL calls are made here */
+
+/** Pack a normal into GL_INT_2_10_10_10_REV, three signed normalized
+    10 bit components, the 2 bit w component is left at zero */
+uint32_t pack_normal(const glm::vec3& normal);
+glm::vec3 unpack_normal(uint32_t packed);
+
+enum class TexcoordEncoding
+{
+  /** two unsigned normalized shorts, GL_UNSIGNED_SHORT */
+  Unorm16,
+
+  /** two half floats, GL_HALF_FLOAT */
+  Half,
+
+  /** not packed, the texcoords have to stay 32 bit floats */
+  Float
+};
+
+/** Pack the x and y components of the texcoords into two unsigned
+    normalized shorts each when they all lie within [0,1], otherwise
+    into two half floats. Half floats get too coarse for texcoords
+    far outside of [0,1], in that case \a out is left empty and Float
+    is returned. The z component is dropped. */
+TexcoordEncoding pack_texcoords(const glm::vec3* texcoord, size_t count, std::vector<uint32_t>& out);
+
+/** Pack the normals into GL_INT_2_10_10_10_REV */
+void pack_normals(const glm::vec3* normal, size_t count, std::vector<uint32_t>& out);
+
+/** Pack the bone weights into four unsigned normalized bytes, the
+    rounding error goes to the largest weight, so weights that sum up
+    to 1 still do after packing */
+void pack_bone_weights(const glm::vec4* weight, size_t count, std::vector<uint32_t>& out);
+
+/** Convert the index list to 16 bit, returns false and leaves \a out
+    empty when an index doesn't fit */
+bool pack_indices(const int* index, size_t count, std::vector<uint16_t>& out);
+
+#endif
+
+/* EOF */
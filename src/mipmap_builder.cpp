@@ -0,0 +1,368 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "mipmap_builder.hpp"
+
+#include <algorithm>
+#include <future>
+#include <math.h>
+
+#include "thread_pool.hpp"
+
+namespace {
+
+/** rows per task, smaller levels are not worth splitting */
+const int s_rows_per_task = 64;
+
+/** Weights of the source texels that make up one destination texel */
+struct Contribution
+{
+  int first;
+  int count;
+
+  /** index into the shared weight array */
+  size_t offset;
+
+  Contribution() : first(), count(), offset() {}
+};
+
+struct Weights
+{
+  std::vector<Contribution> contributions;
+  std::vector<float> weights;
+
+  Weights() : contributions(), weights() {}
+};
+
+float bessel_i0(float x)
+{
+  // power series, converges quickly for the small arguments used here
+  float sum = 1.0f;
+  float term = 1.0f;
+  for(int k = 1; k < 20; ++k)
+  {
+    term *= (x / (2.0f * static_cast<float>(k))) * (x / (2.0f * static_cast<float>(k)));
+    sum += term;
+  }
+  return sum;
+}
+
+/** \a x in destination texels */
+float kaiser(float x)
+{
+  const float width = 3.0f;
+  const float alpha = 4.0f;
+
+  if (fabsf(x) >= width)
+  {
+    return 0.0f;
+  }
+  else
+  {
+    float sinc = (x == 0.0f) ? 1.0f : sinf(static_cast<float>(M_PI) * x) / (static_cast<float>(M_PI) * x);
+    float t = x / width;
+    return sinc * bessel_i0(alpha * sqrtf(1.0f - t * t)) / bessel_i0(alpha);
+  }
+}
+
+Weights make_weights(int src_size, int dst_size, MipmapFilter filter)
+{
+  Weights result;
+  result.contributions.resize(dst_size);
+
+  const float scale = static_cast<float>(src_size) / static_cast<float>(dst_size);
+  std::vector<float> tmp(src_size);
+
+  for(int i = 0; i < dst_size; ++i)
+  {
+    // source range covered by destination texel i
+    float lo = static_cast<float>(i) * scale;
+    float hi = static_cast<float>(i + 1) * scale;
+
+    int first;
+    int last;
+    if (filter == MipmapFilter::Box)
+    {
+      first = static_cast<int>(floorf(lo));
+      last = std::min(src_size - 1, static_cast<int>(ceilf(hi)) - 1);
+    }
+    else
+    {
+      first = static_cast<int>(floorf(lo - 3.0f * scale));
+      last = static_cast<int>(ceilf(hi + 3.0f * scale));
+    }
+
+    // taps outside of the image are clamped to the edge
+    std::fill(tmp.begin(), tmp.end(), 0.0f);
+    int used_first = src_size;
+    int used_last = -1;
+    for(int j = first; j <= last; ++j)
+    {
+      float w;
+      if (filter == MipmapFilter::Box)
+      {
+        w = std::min(hi, static_cast<float>(j + 1)) - std::max(lo, static_cast<float>(j));
+      }
+      else
+      {
+        w = kaiser((static_cast<float>(j) + 0.5f - (lo + hi) * 0.5f) / scale);
+      }
+
+      if (w != 0.0f)
+      {
+        int k = std::max(0, std::min(src_size - 1, j));
+        tmp[k] += w;
+        used_first = std::min(used_first, k);
+        used_last = std::max(used_last, k);
+      }
+    }
+
+    float sum = 0.0f;
+    for(int k = used_first; k <= used_last; ++k)
+    {
+      sum += tmp[k];
+    }
+
+    Contribution& c = result.contributions[i];
+    c.first = used_first;
+    c.count = used_last - used_first + 1;
+    c.offset = result.weights.size();
+    for(int k = used_first; k <= used_last; ++k)
+    {
+      result.weights.push_back(tmp[k] / sum);
+    }
+  }
+
+  return result;
+}
+
+float srgb_to_linear(float c)
+{
+  return (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linear_to_srgb(float c)
+{
+  return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+/** Conversion between 8 bit texels and the float values that get
+    filtered */
+class Encoding
+{
+private:
+  static const int s_encode_size = 4096;
+
+  int m_bytes_per_pixel;
+  int m_alpha_channel;
+  float m_decode[256];
+  uint8_t m_encode[s_encode_size + 1];
+  bool m_srgb;
+
+public:
+  Encoding(int bytes_per_pixel, bool srgb) :
+    m_bytes_per_pixel(bytes_per_pixel),
+    m_alpha_channel(bytes_per_pixel == 4 ? 3 : (bytes_per_pixel == 2 ? 1 : -1)),
+    m_decode(),
+    m_encode(),
+    m_srgb(srgb)
+  {
+    for(int i = 0; i < 256; ++i)
+    {
+      m_decode[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+    }
+    for(int i = 0; i <= s_encode_size; ++i)
+    {
+      float c = linear_to_srgb(static_cast<float>(i) / static_cast<float>(s_encode_size));
+      m_encode[i] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, c * 255.0f + 0.5f)));
+    }
+  }
+
+  /** \a count values, a multiple of the bytes per pixel */
+  void decode(const uint8_t* src, float* dst, size_t count) const
+  {
+    for(size_t i = 0; i < count; i += m_bytes_per_pixel)
+    {
+      for(int ch = 0; ch < m_bytes_per_pixel; ++ch)
+      {
+        if (m_srgb && ch != m_alpha_channel)
+        {
+          dst[i + ch] = m_decode[src[i + ch]];
+        }
+        else
+        {
+          dst[i + ch] = static_cast<float>(src[i + ch]) / 255.0f;
+        }
+      }
+    }
+  }
+
+  void encode(const float* src, uint8_t* dst, size_t count) const
+  {
+    for(size_t i = 0; i < count; i += m_bytes_per_pixel)
+    {
+      for(int ch = 0; ch < m_bytes_per_pixel; ++ch)
+      {
+        float c = std::max(0.0f, std::min(1.0f, src[i + ch]));
+        if (m_srgb && ch != m_alpha_channel)
+        {
+          dst[i + ch] = m_encode[static_cast<int>(c * s_encode_size + 0.5f)];
+        }
+        else
+        {
+          dst[i + ch] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+        }
+      }
+    }
+  }
+
+private:
+  Encoding(const Encoding&) = delete;
+  Encoding& operator=(const Encoding&) = delete;
+};
+
+/** Run func(begin, end) over [0, count) rows, split over \a pool if
+    given and worth it */
+template<typename F>
+void for_rows(ThreadPool* pool, int count, F func)
+{
+  if (!pool || count < 2 * s_rows_per_task)
+  {
+    func(0, count);
+  }
+  else
+  {
+    std::vector<std::future<void> > results;
+    for(int row = 0; row < count; row += s_rows_per_task)
+    {
+      int end = std::min(count, row + s_rows_per_task);
+      results.push_back(pool->submit([&func, row, end]{ func(row, end); }));
+    }
+    for(auto& result : results)
+    {
+      result.get();
+    }
+  }
+}
+
+} // namespace
+
+MipmapBuilder::MipmapBuilder(MipmapFilter filter, bool srgb, ThreadPool* pool) :
+  m_filter(filter),
+  m_srgb(srgb),
+  m_pool(pool)
+{
+}
+
+int
+MipmapBuilder::get_level_count(int width, int height)
+{
+  int levels = 1;
+  while(width > 1 || height > 1)
+  {
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+    levels += 1;
+  }
+  return levels;
+}
+
+std::vector<ImagePtr>
+MipmapBuilder::build(const Image& image) const
+{
+  const int bpp = image.get_bytes_per_pixel();
+  const Encoding encoding(bpp, m_srgb);
+
+  std::vector<ImagePtr> levels;
+
+  // levels are filtered from the float version of the previous one,
+  // so rounding errors don't add up
+  int src_w = image.get_width();
+  int src_h = image.get_height();
+  std::vector<float> src(image.get_size());
+  for_rows(m_pool, src_h, [&](int begin, int end){
+      encoding.decode(image.get_data() + begin * image.get_pitch(),
+                      src.data() + begin * image.get_pitch(),
+                      (end - begin) * image.get_pitch());
+    });
+
+  std::vector<float> tmp;
+  std::vector<float> dst;
+  while(src_w > 1 || src_h > 1)
+  {
+    const int dst_w = std::max(1, src_w / 2);
+    const int dst_h = std::max(1, src_h / 2);
+    const Weights horizontal = make_weights(src_w, dst_w, m_filter);
+    const Weights vertical = make_weights(src_h, dst_h, m_filter);
+
+    // horizontal pass: src_w x src_h -> dst_w x src_h
+    tmp.assign(static_cast<size_t>(dst_w) * src_h * bpp, 0.0f);
+    for_rows(m_pool, src_h, [&](int begin, int end){
+        for(int y = begin; y < end; ++y)
+        {
+          const float* src_row = src.data() + static_cast<size_t>(y) * src_w * bpp;
+          float* tmp_row = tmp.data() + static_cast<size_t>(y) * dst_w * bpp;
+          for(int x = 0; x < dst_w; ++x)
+          {
+            const Contribution& c = horizontal.contributions[x];
+            const float* w = horizontal.weights.data() + c.offset;
+            float* out = tmp_row + x * bpp;
+            for(int k = 0; k < c.count; ++k)
+            {
+              const float* in = src_row + (c.first + k) * bpp;
+              for(int ch = 0; ch < bpp; ++ch)
+              {
+                out[ch] += w[k] * in[ch];
+              }
+            }
+          }
+        }
+      });
+
+    // vertical pass: dst_w x src_h -> dst_w x dst_h, whole rows at once
+    const size_t row_len = static_cast<size_t>(dst_w) * bpp;
+    dst.assign(row_len * dst_h, 0.0f);
+    ImagePtr level = std::make_shared<Image>(dst_w, dst_h, bpp);
+    for_rows(m_pool, dst_h, [&](int begin, int end){
+        for(int y = begin; y < end; ++y)
+        {
+          const Contribution& c = vertical.contributions[y];
+          const float* w = vertical.weights.data() + c.offset;
+          float* out = dst.data() + y * row_len;
+          for(int k = 0; k < c.count; ++k)
+          {
+            const float* in = tmp.data() + (c.first + k) * row_len;
+            const float wk = w[k];
+            for(size_t i = 0; i < row_len; ++i)
+            {
+              out[i] += wk * in[i];
+            }
+          }
+          encoding.encode(out, level->get_data() + y * row_len, row_len);
+        }
+      });
+
+    levels.push_back(level);
+    src.swap(dst);
+    src_w = dst_w;
+    src_h = dst_h;
+  }
+
+  return levels;
+}
+
+/* EOF */
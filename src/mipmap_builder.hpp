@@ -0,0 +1,68 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_MIPMAP_BUILDER_HPP
+#define HEADER_MIPMAP_BUILDER_HPP
+
+#include <vector>
+
+#include "image.hpp"
+
+class ThreadPool;
+
+enum class MipmapFilter
+{
+  /** average of the covered texels, cheap, a bit blurry */
+  Box,
+
+  /** Kaiser windowed sinc over three texels of the smaller level on
+      each side, sharper, but costs more */
+  Kaiser
+};
+
+/** Builds the mip chain of an Image on the CPU, so that it can run on
+    the decode threads instead of in gluBuild2DMipmaps() on the GL
+    thread. Every level halves the size of the previous one, rounded
+    down, non-power-of-two sizes are filtered directly instead of
+    being rescaled first. Filtering is separable and runs on whole
+    rows of float pixels, which the compiler vectorises, and rows can
+    be split over a ThreadPool. With sRGB enabled, color channels are
+    filtered in linear space, alpha is always linear. */
+class MipmapBuilder
+{
+private:
+  MipmapFilter m_filter;
+  bool m_srgb;
+  ThreadPool* m_pool;
+
+public:
+  MipmapBuilder(MipmapFilter filter = MipmapFilter::Box, bool srgb = true, ThreadPool* pool = nullptr);
+
+  /** All levels below \a image, down to 1x1 */
+  std::vector<ImagePtr> build(const Image& image) const;
+
+  /** Number of levels including the base level */
+  static int get_level_count(int width, int height);
+
+private:
+  MipmapBuilder(const MipmapBuilder&) = delete;
+  MipmapBuilder& operator=(const MipmapBuilder&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -16,13 +16,16 @@
 
 #include "model.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/format.hpp>
 
 #include "log.hpp"
+#include "mesh_generator.hpp"
 #include "render_context.hpp"
 
 void 
@@ -54,14 +57,99 @@ Model::draw(const RenderContext& context)
     {
       material->apply(context);
 
-      for (MeshLst::iterator i = m_meshes.begin(); i != m_meshes.end(); ++i)
-      {
-        (*i)->draw();
-      }
+      ProgramPtr program = material->get_program();
+      draw_meshes(context, program ? program->get_id() : 0);
+    }
+
+    OpenGLState::use_program(0);
+  }
+}
+
+void
+Model::draw_meshes(const RenderContext& context, GLuint program)
+{
+  auto draw_mesh = [program](Mesh& mesh) {
+    if (program)
+    {
+      mesh.draw(program);
+    }
+    else
+    {
+      mesh.draw();
     }
+  };
+
+  for (MeshLst::iterator i = m_meshes.begin(); i != m_meshes.end(); ++i)
+  {
+    draw_mesh(**i);
+  }
 
-    glUseProgram(0);
+  if (m_lod_generator)
+  {
+    draw_mesh(*get_lod_mesh(context));
+  }
+}
+
+AABB
+Model::get_bounds() const
+{
+  AABB bounds;
+  for(const auto& mesh : m_meshes)
+  {
+    bounds.extend(mesh->get_bounds());
+  }
+
+  if (m_lod_generator)
+  {
+    bounds.extend(AABB(glm::vec3(-m_lod_radius), glm::vec3(m_lod_radius)));
+  }
+
+  return bounds;
+}
+
+MeshPtr
+Model::get_lod_mesh(const RenderContext& context)
+{
+  glm::mat4 model = context.get_model_matrix();
+  glm::mat4 projection = context.get_projection_matrix();
+
+  float scale = std::max(glm::length(glm::vec3(model[0])),
+                         std::max(glm::length(glm::vec3(model[1])),
+                                  glm::length(glm::vec3(model[2]))));
+  float radius = m_lod_radius * scale;
+
+  // comes from the Camera, querying GL_VIEWPORT here would stall the
+  // pipeline on every draw
+  const float viewport_height = static_cast<float>(context.get_viewport_height());
+
+  int segments;
+  if (viewport_height == 0.0f)
+  { // size on screen unknown
+    segments = lod_segments(std::numeric_limits<float>::max());
+  }
+  else if (projection[3][3] == 1.0f)
+  { // orthographic
+    segments = lod_segments(radius * projection[1][1] * viewport_height * 0.5f);
+  }
+  else
+  {
+    float distance = -(context.get_view_matrix() * model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)).z;
+    if (distance <= radius)
+    { // camera is inside
+      segments = lod_segments(std::numeric_limits<float>::max());
+    }
+    else
+    {
+      segments = lod_segments(radius / distance * projection[1][1] * viewport_height * 0.5f);
+    }
+  }
+
+  MeshPtr& mesh = m_lod_meshes[segments];
+  if (!mesh)
+  {
+    mesh = m_lod_generator(segments);
   }
+  return mesh;
 }
 
 /* EOF */
@@ -17,6 +17,8 @@
 #ifndef HEADER_MODEL_HPP
 #define HEADER_MODEL_HPP
 
+#include <functional>
+#include <map>
 #include <memory>
 
 #include "mesh.hpp"
@@ -29,25 +31,57 @@ typedef std::shared_ptr<Model> ModelPtr;
 
 class Model
 {
+public:
+  /** Creates the mesh with the given number of segments */
+  typedef std::function<MeshPtr (int segments)> LODGenerator;
+
 private:
-  typedef std::vector<std::unique_ptr<Mesh> > MeshLst;
+  typedef std::vector<MeshPtr> MeshLst;
   MeshLst m_meshes;
 
   MaterialPtr m_material;
+
+  float m_lod_radius;
+  LODGenerator m_lod_generator;
+  std::map<int, MeshPtr> m_lod_meshes;
   
 public:
   Model() :
     m_meshes(),
-    m_material()
+    m_material(),
+    m_lod_radius(),
+    m_lod_generator(),
+    m_lod_meshes()
   {}
 
   void draw(const RenderContext& context);
 
+  /** Draw the meshes with the given, already applied, program */
+  void draw_meshes(const RenderContext& context, GLuint program);
+
   void set_material(MaterialPtr material) { m_material = material; }
-  void add_mesh(std::unique_ptr<Mesh> mesh)
+  MaterialPtr get_material() const { return m_material; }
+
+  /** Object space bounds of all meshes, including the LOD mesh */
+  AABB get_bounds() const;
+  void add_mesh(MeshPtr mesh)
   {
     m_meshes.push_back(std::move(mesh));
   }
+
+  /** Draw a mesh from \a generator in addition to the ones added
+      with add_mesh(), its segment count is picked each frame from
+      the projected size of a sphere of \a radius around the origin,
+      see lod_segments(). Each level is generated on first use. */
+  void set_lod(float radius, const LODGenerator& generator)
+  {
+    m_lod_radius = radius;
+    m_lod_generator = generator;
+    m_lod_meshes.clear();
+  }
+
+private:
+  MeshPtr get_lod_mesh(const RenderContext& context);
 };
 
 #endif
@@ -1,5 +1,403 @@
 #include "opengl_state.hpp"
 
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+template<typename T>
+struct Known
+{
+  bool valid;
+  T value;
+
+  Known() : valid(false), value() {}
+
+  /** Store \a v and return true when it differs from the old value,
+      i.e. when the GL call has to be made */
+  bool set(const T& v, OpenGLState::Counter& counter)
+  {
+    if (valid && value == v)
+    {
+      counter.redundant += 1;
+      return false;
+    }
+    else
+    {
+      valid = true;
+      value = v;
+      counter.issued += 1;
+      return true;
+    }
+  }
+};
+
+template<typename Map>
+bool set_entry(Map& map, const typename Map::key_type& key, const typename Map::mapped_type& v,
+               OpenGLState::Counter& counter)
+{
+  auto it = map.find(key);
+  if (it != map.end() && it->second == v)
+  {
+    counter.redundant += 1;
+    return false;
+  }
+  else
+  {
+    map[key] = v;
+    counter.issued += 1;
+    return true;
+  }
+}
+
+/** Drop all entries bound to one of the given names */
+template<typename Map, typename Pred>
+void erase_if(Map& map, Pred pred)
+{
+  for(auto it = map.begin(); it != map.end();)
+  {
+    if (pred(it->second))
+    {
+      it = map.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+bool contains(GLsizei n, const GLuint* names, GLuint name)
+{
+  for(GLsizei i = 0; i < n; ++i)
+  {
+    if (names[i] == name)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct Cache
+{
+  std::unordered_map<GLenum, bool> capabilities;
+  Known<std::tuple<bool, bool, bool, bool> > color_mask;
+  Known<bool> depth_mask;
+  Known<GLenum> cull_face;
+  Known<std::pair<GLenum, GLenum> > blend_func;
+
+  Known<GLenum> active_texture;
+
+  /** (unit, target) -> texture */
+  std::map<std::pair<GLenum, GLenum>, GLuint> textures;
+
+  Known<GLuint> program;
+  Known<GLuint> draw_framebuffer;
+  Known<GLuint> read_framebuffer;
+
+  std::unordered_map<GLenum, GLuint> buffers;
+
+  /** (target, index) -> (buffer, offset, size) */
+  std::map<std::pair<GLenum, GLuint>, std::tuple<GLuint, GLintptr, GLsizeiptr> > buffer_ranges;
+
+  Known<GLuint> vertex_array;
+
+  OpenGLState::Stats stats;
+
+  Cache() :
+    capabilities(),
+    color_mask(),
+    depth_mask(),
+    cull_face(),
+    blend_func(),
+    active_texture(),
+    textures(),
+    program(),
+    draw_framebuffer(),
+    read_framebuffer(),
+    buffers(),
+    buffer_ranges(),
+    vertex_array(),
+    stats()
+  {}
+};
+
+Cache g_cache;
+
+/** not part of the Cache, invalidate() doesn't delete any programs */
+unsigned int g_program_generation = 0;
+
+} // namespace
+
+void
+OpenGLState::enable(GLenum cap)
+{
+  if (set_entry(g_cache.capabilities, cap, true, g_cache.stats.state))
+  {
+    glEnable(cap);
+  }
+}
+
+void
+OpenGLState::disable(GLenum cap)
+{
+  if (set_entry(g_cache.capabilities, cap, false, g_cache.stats.state))
+  {
+    glDisable(cap);
+  }
+}
+
+void
+OpenGLState::color_mask(bool r, bool g, bool b, bool a)
+{
+  if (g_cache.color_mask.set(std::make_tuple(r, g, b, a), g_cache.stats.state))
+  {
+    glColorMask(r, g, b, a);
+  }
+}
+
+void
+OpenGLState::depth_mask(bool flag)
+{
+  if (g_cache.depth_mask.set(flag, g_cache.stats.state))
+  {
+    glDepthMask(flag);
+  }
+}
+
+void
+OpenGLState::cull_face(GLenum mode)
+{
+  if (g_cache.cull_face.set(mode, g_cache.stats.state))
+  {
+    glCullFace(mode);
+  }
+}
+
+void
+OpenGLState::blend_func(GLenum sfactor, GLenum dfactor)
+{
+  if (g_cache.blend_func.set(std::make_pair(sfactor, dfactor), g_cache.stats.state))
+  {
+    glBlendFunc(sfactor, dfactor);
+  }
+}
+
+void
+OpenGLState::active_texture(GLenum unit)
+{
+  if (g_cache.active_texture.set(unit, g_cache.stats.texture))
+  {
+    glActiveTexture(unit);
+  }
+}
+
+void
+OpenGLState::bind_texture(GLenum target, GLuint texture)
+{
+  if (!g_cache.active_texture.valid)
+  {
+    // without knowing the unit the binding can't be tracked and
+    // any unit may have been changed
+    for(auto it = g_cache.textures.begin(); it != g_cache.textures.end();)
+    {
+      if (it->first.second == target)
+      {
+        it = g_cache.textures.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    g_cache.stats.texture.issued += 1;
+    glBindTexture(target, texture);
+  }
+  else if (set_entry(g_cache.textures, std::make_pair(g_cache.active_texture.value, target), texture,
+                     g_cache.stats.texture))
+  {
+    glBindTexture(target, texture);
+  }
+}
+
+void
+OpenGLState::use_program(GLuint program)
+{
+  if (g_cache.program.set(program, g_cache.stats.program))
+  {
+    glUseProgram(program);
+  }
+}
+
+GLuint
+OpenGLState::get_program()
+{
+  if (!g_cache.program.valid)
+  {
+    GLint program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    g_cache.program.valid = true;
+    g_cache.program.value = static_cast<GLuint>(program);
+  }
+  return g_cache.program.value;
+}
+
+void
+OpenGLState::bind_framebuffer(GLenum target, GLuint framebuffer)
+{
+  switch(target)
+  {
+    case GL_DRAW_FRAMEBUFFER:
+      if (g_cache.draw_framebuffer.set(framebuffer, g_cache.stats.framebuffer))
+      {
+        glBindFramebuffer(target, framebuffer);
+      }
+      break;
+
+    case GL_READ_FRAMEBUFFER:
+      if (g_cache.read_framebuffer.set(framebuffer, g_cache.stats.framebuffer))
+      {
+        glBindFramebuffer(target, framebuffer);
+      }
+      break;
+
+    default: // GL_FRAMEBUFFER binds both
+      if (g_cache.draw_framebuffer.valid && g_cache.draw_framebuffer.value == framebuffer &&
+          g_cache.read_framebuffer.valid && g_cache.read_framebuffer.value == framebuffer)
+      {
+        g_cache.stats.framebuffer.redundant += 1;
+      }
+      else
+      {
+        g_cache.draw_framebuffer.valid = true;
+        g_cache.draw_framebuffer.value = framebuffer;
+        g_cache.read_framebuffer = g_cache.draw_framebuffer;
+        g_cache.stats.framebuffer.issued += 1;
+        glBindFramebuffer(target, framebuffer);
+      }
+      break;
+  }
+}
+
+void
+OpenGLState::bind_buffer(GLenum target, GLuint buffer)
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER && !g_cache.vertex_array.valid)
+  {
+    // the element array binding belongs to the vertex array
+    g_cache.stats.buffer.issued += 1;
+    glBindBuffer(target, buffer);
+  }
+  else if (set_entry(g_cache.buffers, target, buffer, g_cache.stats.buffer))
+  {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void
+OpenGLState::bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+  if (set_entry(g_cache.buffer_ranges, std::make_pair(target, index), std::make_tuple(buffer, offset, size),
+                g_cache.stats.buffer))
+  {
+    glBindBufferRange(target, index, buffer, offset, size);
+    // also binds the generic binding point
+    g_cache.buffers[target] = buffer;
+  }
+}
+
+void
+OpenGLState::bind_vertex_array(GLuint array)
+{
+  if (g_cache.vertex_array.set(array, g_cache.stats.buffer))
+  {
+    glBindVertexArray(array);
+    g_cache.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void
+OpenGLState::delete_textures(GLsizei n, const GLuint* textures)
+{
+  glDeleteTextures(n, textures);
+  erase_if(g_cache.textures, [n, textures](GLuint name){ return contains(n, textures, name); });
+}
+
+void
+OpenGLState::delete_buffers(GLsizei n, const GLuint* buffers)
+{
+  glDeleteBuffers(n, buffers);
+  erase_if(g_cache.buffers, [n, buffers](GLuint name){ return contains(n, buffers, name); });
+  erase_if(g_cache.buffer_ranges,
+           [n, buffers](const std::tuple<GLuint, GLintptr, GLsizeiptr>& range){
+             return contains(n, buffers, std::get<0>(range));
+           });
+}
+
+void
+OpenGLState::delete_framebuffers(GLsizei n, const GLuint* framebuffers)
+{
+  glDeleteFramebuffers(n, framebuffers);
+  if (contains(n, framebuffers, g_cache.draw_framebuffer.value))
+  {
+    g_cache.draw_framebuffer.valid = false;
+  }
+  if (contains(n, framebuffers, g_cache.read_framebuffer.value))
+  {
+    g_cache.read_framebuffer.valid = false;
+  }
+}
+
+void
+OpenGLState::delete_vertex_arrays(GLsizei n, const GLuint* arrays)
+{
+  glDeleteVertexArrays(n, arrays);
+  if (contains(n, arrays, g_cache.vertex_array.value))
+  {
+    g_cache.vertex_array.valid = false;
+    g_cache.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void
+OpenGLState::delete_program(GLuint program)
+{
+  glDeleteProgram(program);
+  if (g_cache.program.value == program)
+  {
+    g_cache.program.valid = false;
+  }
+  g_program_generation += 1;
+}
+
+unsigned int
+OpenGLState::get_program_generation()
+{
+  return g_program_generation;
+}
+
+void
+OpenGLState::invalidate()
+{
+  Stats stats = g_cache.stats;
+  g_cache = Cache();
+  g_cache.stats = stats;
+}
+
+const OpenGLState::Stats&
+OpenGLState::get_stats()
+{
+  return g_cache.stats;
+}
+
+void
+OpenGLState::reset_stats()
+{
+  g_cache.stats = Stats();
+}
+
 OpenGLState::OpenGLState()
 {
   assert_gl("OpenGLState");
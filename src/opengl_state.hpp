@@ -19,8 +19,84 @@
 
 #include "assert_gl.hpp"
 
+#include <stddef.h>
+
+/** Shadow copy of the GL state that the viewer changes, the static
+    functions only pass a call on to GL when it would change the
+    state, as far as known. All code has to go through them for the
+    cache to stay correct, code that doesn't has to call
+    invalidate() afterwards. Objects of this class only mark scopes
+    that are expected to leave the GL without errors. */
 class OpenGLState
 {
+public:
+  struct Counter
+  {
+    /** calls passed on to GL */
+    int issued;
+
+    /** calls dropped as they wouldn't have changed anything */
+    int redundant;
+
+    Counter() : issued(), redundant() {}
+  };
+
+  struct Stats
+  {
+    /** capabilities, color/depth mask, cull face and blend func */
+    Counter state;
+    Counter texture;
+    Counter program;
+    Counter framebuffer;
+
+    /** buffers, indexed buffer ranges and vertex arrays */
+    Counter buffer;
+
+    Stats() : state(), texture(), program(), framebuffer(), buffer() {}
+  };
+
+public:
+  static void enable(GLenum cap);
+  static void disable(GLenum cap);
+  static void color_mask(bool r, bool g, bool b, bool a);
+  static void depth_mask(bool flag);
+  static void cull_face(GLenum mode);
+  static void blend_func(GLenum sfactor, GLenum dfactor);
+
+  /** \a unit is GL_TEXTURE0 + n like for glActiveTexture() */
+  static void active_texture(GLenum unit);
+
+  /** Bind to the active texture unit */
+  static void bind_texture(GLenum target, GLuint texture);
+
+  static void use_program(GLuint program);
+
+  /** The program in use, only asks GL when the cache doesn't know */
+  static GLuint get_program();
+  static void bind_framebuffer(GLenum target, GLuint framebuffer);
+  static void bind_buffer(GLenum target, GLuint buffer);
+  static void bind_buffer_range(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+  static void bind_vertex_array(GLuint array);
+
+  /** glDelete*() that also drop the deleted names from the cache, as
+      GL unbinds them and may hand out the same name again */
+  static void delete_textures(GLsizei n, const GLuint* textures);
+  static void delete_buffers(GLsizei n, const GLuint* buffers);
+  static void delete_framebuffers(GLsizei n, const GLuint* framebuffers);
+  static void delete_vertex_arrays(GLsizei n, const GLuint* arrays);
+  static void delete_program(GLuint program);
+
+  /** Incremented by every delete_program(), GL may hand out a deleted
+      program id again, so anything cached by program id has to be
+      dropped when this changes */
+  static unsigned int get_program_generation();
+
+  /** Forget everything, the next call of each kind goes to GL */
+  static void invalidate();
+
+  static const Stats& get_stats();
+  static void reset_stats();
+
 public:
   OpenGLState();
   ~OpenGLState();
@@ -8,14 +8,23 @@ out vec3 frag_normal;
 out vec3 frag_position;
 
 // ---------------------------------------------------------------------------
-uniform mat4 ShadowMapMatrix;
 out vec4 shadow_position;
 // ---------------------------------------------------------------------------
 
-uniform mat4 ModelViewMatrix;
-uniform mat3 NormalMatrix;
-uniform mat4 ProjectionMatrix;
-uniform mat4 MVP;
+layout(std140, binding = 0) uniform FrameBlock
+{
+  mat4 ViewMatrix;
+  mat4 ProjectionMatrix;
+};
+
+layout(std140, binding = 1) uniform ObjectBlock
+{
+  mat4 ModelMatrix;
+  mat4 ModelViewMatrix;
+  mat4 MVP;
+  mat4 ShadowMapMatrix;
+  mat3 NormalMatrix;
+};
 
 void main(void)
 {
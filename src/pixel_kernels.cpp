@@ -0,0 +1,455 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "pixel_kernels.hpp"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#  define PIXEL_KERNELS_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// scalar, the reference for all the others
+
+void swap_rb_rgb_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    uint8_t r = src[3*i+0];
+    uint8_t g = src[3*i+1];
+    uint8_t b = src[3*i+2];
+    dst[3*i+0] = b;
+    dst[3*i+1] = g;
+    dst[3*i+2] = r;
+  }
+}
+
+void swap_rb_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    uint8_t r = src[4*i+0];
+    uint8_t g = src[4*i+1];
+    uint8_t b = src[4*i+2];
+    uint8_t a = src[4*i+3];
+    dst[4*i+0] = b;
+    dst[4*i+1] = g;
+    dst[4*i+2] = r;
+    dst[4*i+3] = a;
+  }
+}
+
+void rgb_to_rgba_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    dst[4*i+0] = src[3*i+0];
+    dst[4*i+1] = src[3*i+1];
+    dst[4*i+2] = src[3*i+2];
+    dst[4*i+3] = 255;
+  }
+}
+
+void rgba_to_rgb_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    dst[3*i+0] = src[4*i+0];
+    dst[3*i+1] = src[4*i+1];
+    dst[3*i+2] = src[4*i+2];
+  }
+}
+
+/** c * a / 255, rounded, without a division */
+inline uint8_t mul_div255(unsigned int c, unsigned int a)
+{
+  unsigned int t = c * a + 128;
+  return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void premultiply_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    uint8_t a = src[4*i+3];
+    dst[4*i+0] = mul_div255(src[4*i+0], a);
+    dst[4*i+1] = mul_div255(src[4*i+1], a);
+    dst[4*i+2] = mul_div255(src[4*i+2], a);
+    dst[4*i+3] = a;
+  }
+}
+
+void unpremultiply_scalar(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    unsigned int a = src[4*i+3];
+    for(int c = 0; c < 3; ++c)
+    {
+      if (a != 0)
+      {
+        dst[4*i+c] = static_cast<uint8_t>(std::min(255u, src[4*i+c] * 255u / a));
+      }
+      else
+      {
+        dst[4*i+c] = src[4*i+c];
+      }
+    }
+    dst[4*i+3] = static_cast<uint8_t>(a);
+  }
+}
+
+void swap_rows_scalar(uint8_t* lhs, uint8_t* rhs, size_t len)
+{
+  std::swap_ranges(lhs, lhs + len, rhs);
+}
+
+#ifdef PIXEL_KERNELS_X86
+
+//-----------------------------------------------------------------------------
+// SSE2, part of every x86_64 CPU, lacks byte shuffles, so only the
+// kernels that work on whole 32 bit pixels get a vector version
+
+inline __m128i load128(const uint8_t* p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store128(uint8_t* p, __m128i v)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+void swap_rb_rgba_sse2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  const __m128i ga_mask = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+  const __m128i c_mask = _mm_set1_epi32(0x000000ff);
+
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i v = load128(src + 4*i);
+    __m128i ga = _mm_and_si128(v, ga_mask);
+    __m128i r = _mm_and_si128(v, c_mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), c_mask);
+    store128(dst + 4*i, _mm_or_si128(ga, _mm_or_si128(b, _mm_slli_epi32(r, 16))));
+  }
+  swap_rb_rgba_scalar(src + 4*i, dst + 4*i, count - i);
+}
+
+/** 16 bit color channels times 16 bit alpha, divided by 255 */
+inline __m128i mul_div255_epi16(__m128i c, __m128i a)
+{
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/** alpha of every pixel in all four of its 16 bit lanes, but 255 in
+    the alpha lane itself, so that alpha stays as it is */
+inline __m128i broadcast_alpha_epi16(__m128i v)
+{
+  __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xff), 0xff);
+  const __m128i alpha_lane = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+  return _mm_or_si128(_mm_andnot_si128(alpha_lane, a),
+                      _mm_and_si128(alpha_lane, _mm_set1_epi16(255)));
+}
+
+void premultiply_sse2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  const __m128i zero = _mm_setzero_si128();
+
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i v = load128(src + 4*i);
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    lo = mul_div255_epi16(lo, broadcast_alpha_epi16(lo));
+    hi = mul_div255_epi16(hi, broadcast_alpha_epi16(hi));
+    store128(dst + 4*i, _mm_packus_epi16(lo, hi));
+  }
+  premultiply_scalar(src + 4*i, dst + 4*i, count - i);
+}
+
+void swap_rows_sse2(uint8_t* lhs, uint8_t* rhs, size_t len)
+{
+  size_t i = 0;
+  for(; i + 16 <= len; i += 16)
+  {
+    __m128i a = load128(lhs + i);
+    __m128i b = load128(rhs + i);
+    store128(lhs + i, b);
+    store128(rhs + i, a);
+  }
+  swap_rows_scalar(lhs + i, rhs + i, len - i);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2, compiled for that target only, get() checks the CPU before
+// any of these run
+
+#define PIXEL_KERNELS_AVX2 __attribute__((target("avx2")))
+
+PIXEL_KERNELS_AVX2
+inline __m256i load256(const uint8_t* p)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+PIXEL_KERNELS_AVX2
+inline void store256(uint8_t* p, __m256i v)
+{
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+PIXEL_KERNELS_AVX2
+void swap_rb_rgb_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  // five whole pixels per 16 bytes, the last byte stays as it is and
+  // gets overwritten by the next round
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+
+  size_t i = 0;
+  for(; 3*i + 16 <= 3*count; i += 5)
+  {
+    store128(dst + 3*i, _mm_shuffle_epi8(load128(src + 3*i), shuffle));
+  }
+  swap_rb_rgb_scalar(src + 3*i, dst + 3*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void swap_rb_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                           2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  size_t i = 0;
+  for(; i + 8 <= count; i += 8)
+  {
+    store256(dst + 4*i, _mm256_shuffle_epi8(load256(src + 4*i), shuffle));
+  }
+  swap_rb_rgba_scalar(src + 4*i, dst + 4*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void rgb_to_rgba_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  // four pixels from the first 12 of 16 loaded bytes
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+  size_t i = 0;
+  for(; 3*i + 16 <= 3*count; i += 4)
+  {
+    store128(dst + 4*i, _mm_or_si128(_mm_shuffle_epi8(load128(src + 3*i), shuffle), alpha));
+  }
+  rgb_to_rgba_scalar(src + 3*i, dst + 4*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void rgba_to_rgb_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  // four pixels into the first 12 of 16 stored bytes, the rest gets
+  // overwritten by the next round
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+  size_t i = 0;
+  for(; 3*i + 16 <= 3*count; i += 4)
+  {
+    store128(dst + 3*i, _mm_shuffle_epi8(load128(src + 4*i), shuffle));
+  }
+  rgba_to_rgb_scalar(src + 4*i, dst + 3*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void premultiply_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  const __m256i alpha_shuffle = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1,
+                                                 6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+  const __m256i alpha_lane = _mm256_set1_epi64x(static_cast<long long>(0x00ff000000000000ull));
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i bias = _mm256_set1_epi16(128);
+
+  size_t i = 0;
+  for(; i + 8 <= count; i += 8)
+  {
+    __m256i v = load256(src + 4*i);
+    __m256i halves[] = { _mm256_unpacklo_epi8(v, zero), _mm256_unpackhi_epi8(v, zero) };
+    for(__m256i& c : halves)
+    {
+      __m256i a = _mm256_or_si256(_mm256_shuffle_epi8(c, alpha_shuffle), alpha_lane);
+      __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), bias);
+      c = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    }
+    store256(dst + 4*i, _mm256_packus_epi16(halves[0], halves[1]));
+  }
+  premultiply_scalar(src + 4*i, dst + 4*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void unpremultiply_avx2(const uint8_t* src, uint8_t* dst, size_t count)
+{
+  const __m256 max = _mm256_set1_ps(255.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 alpha_lane = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+  const __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  // two pixels per round, one in each 128 bit lane
+  size_t i = 0;
+  for(; i + 2 <= count; i += 2)
+  {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 4*i));
+    __m256 c = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    __m256 a = _mm256_permute_ps(c, 0xff);
+
+    // c * 255 / a is exact enough in float for the truncation to match
+    // the integer division
+    __m256 q = _mm256_min_ps(_mm256_div_ps(_mm256_mul_ps(c, max), a), max);
+    __m256 keep = _mm256_or_ps(_mm256_cmp_ps(a, zero, _CMP_EQ_OQ), alpha_lane);
+    __m256 r = _mm256_blendv_ps(q, c, keep);
+
+    __m256i p = _mm256_shuffle_epi8(_mm256_cvttps_epi32(r), pack);
+    uint32_t lo = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(p)));
+    uint32_t hi = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_extracti128_si256(p, 1)));
+    std::copy(reinterpret_cast<const uint8_t*>(&lo), reinterpret_cast<const uint8_t*>(&lo) + 4, dst + 4*i);
+    std::copy(reinterpret_cast<const uint8_t*>(&hi), reinterpret_cast<const uint8_t*>(&hi) + 4, dst + 4*i + 4);
+  }
+  unpremultiply_scalar(src + 4*i, dst + 4*i, count - i);
+}
+
+PIXEL_KERNELS_AVX2
+void swap_rows_avx2(uint8_t* lhs, uint8_t* rhs, size_t len)
+{
+  size_t i = 0;
+  for(; i + 32 <= len; i += 32)
+  {
+    __m256i a = load256(lhs + i);
+    __m256i b = load256(rhs + i);
+    store256(lhs + i, b);
+    store256(rhs + i, a);
+  }
+  swap_rows_scalar(lhs + i, rhs + i, len - i);
+}
+
+#undef PIXEL_KERNELS_AVX2
+
+#endif
+
+const PixelKernels s_scalar = {
+  "scalar",
+  swap_rb_rgb_scalar,
+  swap_rb_rgba_scalar,
+  rgb_to_rgba_scalar,
+  rgba_to_rgb_scalar,
+  premultiply_scalar,
+  unpremultiply_scalar,
+  swap_rows_scalar
+};
+
+#ifdef PIXEL_KERNELS_X86
+const PixelKernels s_sse2 = {
+  "sse2",
+  swap_rb_rgb_scalar,
+  swap_rb_rgba_sse2,
+  rgb_to_rgba_scalar,
+  rgba_to_rgb_scalar,
+  premultiply_sse2,
+  unpremultiply_scalar,
+  swap_rows_sse2
+};
+
+const PixelKernels s_avx2 = {
+  "avx2",
+  swap_rb_rgb_avx2,
+  swap_rb_rgba_avx2,
+  rgb_to_rgba_avx2,
+  rgba_to_rgb_avx2,
+  premultiply_avx2,
+  unpremultiply_avx2,
+  swap_rows_avx2
+};
+#endif
+
+const PixelKernels&
+select_kernels()
+{
+  if (const PixelKernels* avx2 = PixelKernels::avx2())
+  {
+    return *avx2;
+  }
+  else if (const PixelKernels* sse2 = PixelKernels::sse2())
+  {
+    return *sse2;
+  }
+  else
+  {
+    return PixelKernels::scalar();
+  }
+}
+
+} // namespace
+
+void
+PixelKernels::vflip(uint8_t* pixels, size_t pitch, int height) const
+{
+  for(int y = 0; y < height / 2; ++y)
+  {
+    swap_rows(pixels + y * pitch, pixels + (height - y - 1) * pitch, pitch);
+  }
+}
+
+const PixelKernels&
+PixelKernels::get()
+{
+  // the ImageDecoder workers get here concurrently, a function local
+  // static is initialized exactly once
+  static const PixelKernels& kernels = select_kernels();
+  return kernels;
+}
+
+const PixelKernels&
+PixelKernels::scalar()
+{
+  return s_scalar;
+}
+
+const PixelKernels*
+PixelKernels::sse2()
+{
+#ifdef PIXEL_KERNELS_X86
+  return &s_sse2;
+#else
+  return nullptr;
+#endif
+}
+
+const PixelKernels*
+PixelKernels::avx2()
+{
+#ifdef PIXEL_KERNELS_X86
+  return __builtin_cpu_supports("avx2") ? &s_avx2 : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+/* EOF */
@@ -0,0 +1,71 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_PIXEL_KERNELS_HPP
+#define HEADER_PIXEL_KERNELS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Conversions over runs of 8 bit pixels, one table of functions per
+    instruction set. get() picks the best one the CPU supports at
+    runtime, all of them give exactly the same results as scalar().
+
+    \a count is always in pixels, \a src and \a dst may be the same
+    buffer when source and destination have the same pixel size. */
+struct PixelKernels
+{
+  const char* name;
+
+  /** Swap the first and third channel, RGB <-> BGR */
+  void (*swap_rb_rgb)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Swap the first and third channel, RGBA <-> BGRA */
+  void (*swap_rb_rgba)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Append an alpha of 255 to every pixel */
+  void (*rgb_to_rgba)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Drop the alpha channel */
+  void (*rgba_to_rgb)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Multiply the color channels with alpha, rounded */
+  void (*premultiply)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Divide the color channels by alpha, truncated and clamped to 255,
+      pixels with an alpha of 0 are left alone */
+  void (*unpremultiply)(const uint8_t* src, uint8_t* dst, size_t count);
+
+  /** Exchange the content of two non-overlapping rows of \a len bytes */
+  void (*swap_rows)(uint8_t* lhs, uint8_t* rhs, size_t len);
+
+  /** Turn \a height rows of \a pitch bytes upside down */
+  void vflip(uint8_t* pixels, size_t pitch, int height) const;
+
+  /** The fastest table for this CPU */
+  static const PixelKernels& get();
+
+  static const PixelKernels& scalar();
+
+  /** nullptr when not supported by the compiler or the CPU */
+  static const PixelKernels* sse2();
+  static const PixelKernels* avx2();
+};
+
+#endif
+
+/* EOF */
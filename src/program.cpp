@@ -4,6 +4,7 @@
 
 #include "assert_gl.hpp"
 #include "log.hpp"
+#include "opengl_state.hpp"
 
 ProgramPtr
 Program::create(ShaderPtr shader)
@@ -12,8 +13,6 @@ Program::create(ShaderPtr shader)
   program->attach(shader);
   program->link();
 
-  program->inspect();
-
   return program;
 }
 
@@ -25,8 +24,6 @@ Program::create(ShaderPtr shader1, ShaderPtr shader2)
   program->attach(shader2);
   program->link();
 
-  program->inspect();
-
   return program;
 }
 
@@ -39,20 +36,19 @@ Program::create(ShaderPtr shader1, ShaderPtr shader2, ShaderPtr shader3)
   program->attach(shader3);
   program->link();
 
-  program->inspect();
-
   return program;
 }
 
 Program::Program() :
-  m_program()
+  m_program(),
+  m_uniforms()
 {
   m_program = glCreateProgram();
 }
 
 Program::~Program()
 {
-  glDeleteProgram(m_program);
+  OpenGLState::delete_program(m_program);
 }
 
 void
@@ -65,6 +61,13 @@ void
 Program::link()
 {
   glLinkProgram(m_program);
+
+  // locations change with every link
+  m_uniforms.clear();
+  if (get_link_status())
+  {
+    inspect();
+  }
 }
 
 void
@@ -108,51 +111,60 @@ Program::get_validate_status() const
   return validate_status == GL_TRUE;
 }
 
-/*
-	GL_BOOL,
-	GL_BOOL_VEC2,
-	GL_BOOL_VEC3,
-	GL_BOOL_VEC4,
-	GL_FLOAT,
-	GL_FLOAT_MAT2,
-	GL_FLOAT_MAT2,
-	GL_FLOAT_MAT2x3,
-	GL_FLOAT_MAT2x3,
-	GL_FLOAT_MAT2x4,
-	GL_FLOAT_MAT2x4,
-	GL_FLOAT_MAT3,
-	GL_FLOAT_MAT3,
-	GL_FLOAT_MAT3x2,
-	GL_FLOAT_MAT3x2,
-	GL_FLOAT_MAT3x4,
-	GL_FLOAT_MAT3x4,
-	GL_FLOAT_MAT4,
-	GL_FLOAT_MAT4,
-	GL_FLOAT_MAT4x2,
-	GL_FLOAT_MAT4x2,
-	GL_FLOAT_MAT4x3 
-	GL_FLOAT_MAT4x3,
-	GL_FLOAT_VEC2,
-	GL_FLOAT_VEC2,
-	GL_FLOAT_VEC3,
-	GL_FLOAT_VEC3,
-	GL_FLOAT_VEC4,
-	GL_FLOAT_VEC4,
-	GL_INT,
-	GL_INT_VEC2,
-	GL_INT_VEC3,
-	GL_INT_VEC4,
-	GL_SAMPLER_1D,
-	GL_SAMPLER_1D_SHADOW
-	GL_SAMPLER_2D,
-	GL_SAMPLER_2D_SHADOW
-	GL_SAMPLER_3D,
-	GL_SAMPLER_CUBE,
-        GL_FLOAT,
-*/
+bool
+Program::is_sampler(GLenum type)
+{
+  switch(type)
+  {
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_1D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_RECT:
+    case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case GL_INT_SAMPLER_1D:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_3D:
+    case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY:
+    case GL_INT_SAMPLER_2D_ARRAY:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D_RECT:
+    case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_1D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE:
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+      return true;
+
+    default:
+      return false;
+  }
+}
 
 void
-Program::inspect() const
+Program::inspect()
 {
   { // handle attributes
     GLint active_attributes;
@@ -191,6 +203,21 @@ Program::inspect() const
       glGetActiveUniform(m_program, i, name.size(), &length, &size, &type, name.data());
 
       //log_info("Uniform: %s type:%d size:%d", std::string(name.data(), length), type, size);
+
+      std::string uniform_name(name.data(), length);
+      GLint loc = glGetUniformLocation(m_program, uniform_name.c_str());
+      if (loc != -1) // uniforms in uniform blocks have no location
+      {
+        m_uniforms[uniform_name] = UniformInfo(loc, type, size);
+
+        // arrays are reported as "name[0]", make them reachable as
+        // "name" too, like glGetUniformLocation() does
+        if (uniform_name.size() > 3 &&
+            uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0)
+        {
+          m_uniforms[uniform_name.substr(0, uniform_name.size() - 3)] = UniformInfo(loc, type, size);
+        }
+      }
     }    
   }
 
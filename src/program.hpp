@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <GL/glew.h>
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -18,9 +19,27 @@ typedef std::shared_ptr<Program> ProgramPtr;
 
 class Program
 {
+public:
+  /** An active uniform as reported by glGetActiveUniform() */
+  struct UniformInfo
+  {
+    GLint location;
+    GLenum type;
+    GLint size;
+
+    UniformInfo() : location(-1), type(), size() {}
+    UniformInfo(GLint location_, GLenum type_, GLint size_) :
+      location(location_), type(type_), size(size_)
+    {}
+  };
+
 private:
   GLuint m_program;
 
+  /** active uniforms by name, filled by inspect() after linking, so
+      set_uniform() doesn't need to ask the driver */
+  std::unordered_map<std::string, UniformInfo> m_uniforms;
+
 public:
   static ProgramPtr create(ShaderPtr shader);
   static ProgramPtr create(ShaderPtr shader1, ShaderPtr shader2);
@@ -40,13 +59,49 @@ public:
   
   GLuint get_id() const { return m_program; }
 
-  void inspect() const;
+  /** Read the active attributes and uniforms, called by link() */
+  void inspect();
+
+  const UniformInfo* get_uniform_info(const std::string& name) const
+  {
+    auto it = m_uniforms.find(name);
+    if (it == m_uniforms.end())
+    {
+      return nullptr;
+    }
+    else
+    {
+      return &it->second;
+    }
+  }
+
+  /** Location of the uniform \a name for a value of type T, -1 when
+      the program has no such uniform or when its type doesn't match
+      T, the latter is reported as error */
+  template<typename T>
+  GLint resolve_uniform(const std::string& name) const
+  {
+    const UniformInfo* info = get_uniform_info(name);
+    if (!info)
+    {
+      return -1;
+    }
+    else if (!is_compatible(info->type, static_cast<const T*>(nullptr)))
+    {
+      log_error("uniform '%s' has type 0x%04x, which doesn't match the given value", name, info->type);
+      return -1;
+    }
+    else
+    {
+      return info->location;
+    }
+  }
 
   template<typename T>
   void set_uniform(const std::string& name, const T& v)
   {
     assert_gl("set_uniform:enter");
-    int loc = glGetUniformLocation(m_program, name.c_str());
+    GLint loc = resolve_uniform<T>(name);
     if (loc == -1)
     {
       //log_debug("uniform location '%s' not found, ignoring", name);
@@ -64,7 +119,7 @@ public:
   void set_uniform(GLint loc, const glm::vec4& v) { glProgramUniform4f(m_program, loc, v.x, v.y, v.z, v.w); }
 
   void set_uniform(GLint loc, int v) { glProgramUniform1i(m_program, loc, v); }
-  void set_uniform(GLint loc, unsigned int v) { glProgramUniform1i(m_program, loc, v); }
+  void set_uniform(GLint loc, unsigned int v) { glProgramUniform1ui(m_program, loc, v); }
   void set_uniform(GLint loc, const glm::ivec2& v) { glProgramUniform2i(m_program, loc, v.x, v.y); }
   void set_uniform(GLint loc, const glm::ivec3& v) { glProgramUniform3i(m_program, loc, v.x, v.y, v.z); }
   void set_uniform(GLint loc, const glm::ivec4& v) { glProgramUniform4i(m_program, loc, v.x, v.y, v.z, v.w); }
@@ -72,6 +127,30 @@ public:
   void set_uniform(GLint loc, const glm::mat3& v) { glProgramUniformMatrix3fv(m_program, loc, 1, GL_FALSE, glm::value_ptr(v)); }
   void set_uniform(GLint loc, const glm::mat4& v) { glProgramUniformMatrix4fv(m_program, loc, 1, GL_FALSE, glm::value_ptr(v)); }
 
+private:
+  static bool is_sampler(GLenum type);
+
+  static bool is_compatible(GLenum type, const float*) { return type == GL_FLOAT || type == GL_BOOL; }
+  static bool is_compatible(GLenum type, const glm::vec2*) { return type == GL_FLOAT_VEC2 || type == GL_BOOL_VEC2; }
+  static bool is_compatible(GLenum type, const glm::vec3*) { return type == GL_FLOAT_VEC3 || type == GL_BOOL_VEC3; }
+  static bool is_compatible(GLenum type, const glm::vec4*) { return type == GL_FLOAT_VEC4 || type == GL_BOOL_VEC4; }
+
+  static bool is_compatible(GLenum type, const int*)
+  {
+    return type == GL_INT || type == GL_BOOL || is_sampler(type);
+  }
+  static bool is_compatible(GLenum type, const unsigned int*)
+  {
+    // glProgramUniform1ui() fails on int and sampler uniforms
+    return type == GL_UNSIGNED_INT || type == GL_BOOL;
+  }
+  static bool is_compatible(GLenum type, const glm::ivec2*) { return type == GL_INT_VEC2 || type == GL_BOOL_VEC2; }
+  static bool is_compatible(GLenum type, const glm::ivec3*) { return type == GL_INT_VEC3 || type == GL_BOOL_VEC3; }
+  static bool is_compatible(GLenum type, const glm::ivec4*) { return type == GL_INT_VEC4 || type == GL_BOOL_VEC4; }
+
+  static bool is_compatible(GLenum type, const glm::mat3*) { return type == GL_FLOAT_MAT3; }
+  static bool is_compatible(GLenum type, const glm::mat4*) { return type == GL_FLOAT_MAT4; }
+
 private:
   Program(const Program&);
   Program& operator=(const Program&);
@@ -40,6 +40,11 @@ public:
   {
     return m_camera.get_projection_matrix();
   }
+
+  int get_viewport_height() const
+  {
+    return m_camera.get_viewport_height();
+  }
   
   void set_geometry_pass()
   {
@@ -0,0 +1,142 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#include "assert_gl.hpp"
+#include "material.hpp"
+#include "model.hpp"
+#include "opengl_state.hpp"
+#include "render_context.hpp"
+#include "uniform_buffer.hpp"
+
+uint64_t
+RenderQueue::make_key(Layer layer, bool blended, GLuint program, GLuint texture,
+                      unsigned int material, float depth)
+{
+  // the bit pattern of a non-negative float sorts like the float
+  // itself, the upper 20 bits of it are precise enough for ordering
+  uint32_t depth_bits = 0;
+  if (depth > 0.0f)
+  {
+    memcpy(&depth_bits, &depth, sizeof(depth_bits));
+    depth_bits >>= 11;
+  }
+
+  uint64_t key = static_cast<uint64_t>(layer & 0x1) << 63;
+  if (!blended)
+  {
+    key |= static_cast<uint64_t>(program & 0xffff) << 46;
+    key |= static_cast<uint64_t>(texture & 0x3fff) << 32;
+    key |= static_cast<uint64_t>(material & 0xfff) << 20;
+    key |= depth_bits;
+  }
+  else
+  {
+    key |= static_cast<uint64_t>(1) << 62;
+    key |= static_cast<uint64_t>(~depth_bits & 0xfffff) << 42;
+    key |= static_cast<uint64_t>(program & 0xffff) << 26;
+    key |= static_cast<uint64_t>(texture & 0x3fff) << 12;
+    key |= material & 0xfff;
+  }
+  return key;
+}
+
+RenderQueue::RenderQueue() :
+  m_items(),
+  m_material_ids(),
+  m_stats()
+{
+}
+
+void
+RenderQueue::clear()
+{
+  m_items.clear();
+  m_material_ids.clear();
+}
+
+void
+RenderQueue::add(Layer layer, const Camera& camera, SceneNode* node, Model* model, Material* material,
+                 size_t object, float depth)
+{
+  auto it = m_material_ids.insert(std::make_pair(material, m_material_ids.size())).first;
+
+  ProgramPtr program = material->get_program();
+
+  Item item;
+  item.key = make_key(layer, material->is_blended(),
+                      program ? program->get_id() : 0,
+                      material->get_sort_texture(),
+                      it->second, depth);
+  item.layer = layer;
+  item.camera = &camera;
+  item.node = node;
+  item.model = model;
+  item.material = material;
+  item.object = object;
+  m_items.push_back(item);
+}
+
+void
+RenderQueue::submit(const UniformBuffer& frame_uniforms, const UniformBuffer& object_uniforms, Stereo stereo)
+{
+  // stable, so that items with the same key stay in scene order
+  std::stable_sort(m_items.begin(), m_items.end(),
+                   [](const Item& lhs, const Item& rhs) {
+                     return lhs.key < rhs.key;
+                   });
+
+  const Material* previous = nullptr;
+  int layer = -1;
+  size_t object = 0;
+
+  for(const auto& item : m_items)
+  {
+    if (item.layer != layer)
+    {
+      layer = item.layer;
+      frame_uniforms.bind(layer);
+      m_stats.buffers += 1;
+    }
+
+    if (!previous || item.object != object)
+    {
+      object = item.object;
+      object_uniforms.bind(object);
+      m_stats.buffers += 1;
+    }
+
+    RenderContext context(*item.camera, item.node);
+    context.set_stereo(stereo);
+
+    item.material->apply(context, previous, m_stats);
+    previous = item.material;
+
+    ProgramPtr program = item.material->get_program();
+    item.model->draw_meshes(context, program ? program->get_id() : 0);
+    m_stats.draws += 1;
+  }
+
+  OpenGLState::use_program(0);
+  assert_gl("RenderQueue::submit");
+}
+
+/* EOF */
@@ -0,0 +1,143 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_RENDER_QUEUE_HPP
+#define HEADER_RENDER_QUEUE_HPP
+
+#include <GL/glew.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "stereo.hpp"
+
+class Camera;
+class Material;
+class Model;
+class SceneNode;
+class UniformBuffer;
+
+/** Number of draws and GL state changes requested by a RenderQueue,
+    OpenGLState may still drop some of them as redundant */
+struct RenderStats
+{
+  int draws;
+
+  /** materials applied, each one may cause the changes below */
+  int materials;
+
+  /** glUseProgram() calls */
+  int programs;
+
+  /** glBindTexture() calls */
+  int textures;
+
+  /** glEnable(), glDisable(), glColorMask(), glDepthMask(),
+      glCullFace() and glBlendFunc() calls */
+  int states;
+
+  /** glBindBufferRange() calls for the uniform blocks */
+  int buffers;
+
+  RenderStats() :
+    draws(), materials(), programs(), textures(), states(), buffers()
+  {}
+
+  RenderStats& operator+=(const RenderStats& rhs)
+  {
+    draws += rhs.draws;
+    materials += rhs.materials;
+    programs += rhs.programs;
+    textures += rhs.textures;
+    states += rhs.states;
+    buffers += rhs.buffers;
+    return *this;
+  }
+};
+
+/** Collects the models of a scene and draws them sorted by a key, so
+    that draws sharing a program, texture or material follow each
+    other and the state changes between them can be skipped.
+
+    Opaque models are sorted by program, texture, material and then
+    front to back, blended ones are drawn after them back to front.
+    Everything attached to the view is drawn after the world. */
+class RenderQueue
+{
+public:
+  enum Layer { World = 0, View = 1 };
+
+  struct Item
+  {
+    uint64_t key;
+    Layer layer;
+    const Camera* camera;
+    SceneNode* node;
+    Model* model;
+    Material* material;
+
+    /** index of the ObjectUniforms of the node */
+    size_t object;
+
+    Item() :
+      key(), layer(World), camera(nullptr), node(nullptr),
+      model(nullptr), material(nullptr), object()
+    {}
+
+    Item(const Item&) = default;
+    Item& operator=(const Item&) = default;
+  };
+
+  /** \a depth is the view space distance to the camera, \a material
+      a small per frame id of the material */
+  static uint64_t make_key(Layer layer, bool blended, GLuint program, GLuint texture,
+                           unsigned int material, float depth);
+
+private:
+  std::vector<Item> m_items;
+  std::unordered_map<const Material*, unsigned int> m_material_ids;
+  RenderStats m_stats;
+
+public:
+  RenderQueue();
+
+  /** Drop all items, the stats are kept */
+  void clear();
+
+  /** Queue \a model of \a node to be drawn with \a material, which
+      may differ from the model's own in the geometry pass */
+  void add(Layer layer, const Camera& camera, SceneNode* node, Model* model, Material* material,
+           size_t object, float depth);
+
+  /** Sort and draw all items, the FrameUniforms of a layer are
+      expected at the index of the layer in \a frame_uniforms */
+  void submit(const UniformBuffer& frame_uniforms, const UniformBuffer& object_uniforms, Stereo stereo);
+
+  const std::vector<Item>& get_items() const { return m_items; }
+
+  /** Stats summed up over all submit() calls since reset_stats() */
+  const RenderStats& get_stats() const { return m_stats; }
+  void reset_stats() { m_stats = RenderStats(); }
+
+private:
+  RenderQueue(const RenderQueue&) = delete;
+  RenderQueue& operator=(const RenderQueue&) = delete;
+};
+
+#endif
+
+/* EOF */
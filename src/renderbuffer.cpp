@@ -35,7 +35,7 @@ Renderbuffer::Renderbuffer(int width, int height) :
   assert_gl("renderbuffer");
   glGenFramebuffers(1, &m_fbo);
   assert_gl("renderbuffer");
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, m_fbo);
   assert_gl("renderbuffer");
 
   glGenRenderbuffers(1, &m_color_buffer);
@@ -66,7 +66,7 @@ Renderbuffer::Renderbuffer(int width, int height) :
 
   glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, m_fbo);
   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color_buffer);
   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, m_depth_buffer);
 
@@ -77,12 +77,12 @@ Renderbuffer::Renderbuffer(int width, int height) :
   }
   assert_gl("framebuffer");
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 Renderbuffer::~Renderbuffer()
 {
-  glDeleteFramebuffers(1, &m_fbo);
+  OpenGLState::delete_framebuffers(1, &m_fbo);
 
   glDeleteRenderbuffers(1, &m_depth_buffer);
   glDeleteRenderbuffers(1, &m_color_buffer);
@@ -107,9 +107,9 @@ Renderbuffer::blit(Framebuffer& target_fbo,
   // http://www.opengl.org/wiki/GLAPI/glBlitFramebuffer
 
   assert_gl("enter: BlitFramebuffer");
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_fbo.get_id());
+  OpenGLState::bind_framebuffer(GL_DRAW_FRAMEBUFFER, target_fbo.get_id());
   assert_gl("enter: BlitFramebuffer1");
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+  OpenGLState::bind_framebuffer(GL_READ_FRAMEBUFFER, m_fbo);
   glReadBuffer(GL_COLOR_ATTACHMENT0);
   assert_gl("enter: BlitFramebuffer2");
   glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1,
@@ -117,8 +117,8 @@ Renderbuffer::blit(Framebuffer& target_fbo,
                     mask, filter);
   assert_gl("done: BlitFramebuffer");
 
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
 }
                                                
 void
@@ -132,13 +132,13 @@ Renderbuffer::blit(Framebuffer& target_fbo)
 void
 Renderbuffer::bind()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, m_fbo); 
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, m_fbo); 
 }
 
 void
 Renderbuffer::unbind()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  OpenGLState::bind_framebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /* EOF */
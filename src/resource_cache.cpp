@@ -0,0 +1,115 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "resource_cache.hpp"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <iterator>
+
+#include "log.hpp"
+#include "material_factory.hpp"
+
+ResourceCache::ResourceCache() :
+  m_meshes(),
+  m_materials(),
+  m_stats(),
+  m_prune_size(64)
+{
+}
+
+MeshPtr
+ResourceCache::get_mesh(const MeshHash& hash, const std::function<MeshPtr ()>& create)
+{
+  std::weak_ptr<Mesh>& entry = m_meshes[hash.get_key()];
+  MeshPtr mesh = entry.lock();
+  if (mesh)
+  {
+    m_stats.mesh_hits += 1;
+    m_stats.bytes_saved += mesh->get_gpu_bytes();
+    return mesh;
+  }
+  else
+  {
+    m_stats.mesh_misses += 1;
+    mesh = create();
+    entry = mesh;
+    prune();
+    return mesh;
+  }
+}
+
+MaterialPtr
+ResourceCache::get_material(const boost::filesystem::path& filename)
+{
+  boost::system::error_code ec;
+  boost::filesystem::path path = boost::filesystem::canonical(filename, ec);
+  if (ec)
+  {
+    // let the MaterialParser report the error
+    path = filename;
+  }
+
+  std::weak_ptr<Material>& entry = m_materials[path.string()];
+  MaterialPtr material = entry.lock();
+  if (material)
+  {
+    m_stats.material_hits += 1;
+    return material;
+  }
+  else
+  {
+    m_stats.material_misses += 1;
+    material = MaterialFactory::get().from_file(path);
+    entry = material;
+    prune();
+    return material;
+  }
+}
+
+void
+ResourceCache::prune()
+{
+  if (m_meshes.size() + m_materials.size() < m_prune_size)
+  {
+    return;
+  }
+
+  for(auto it = m_meshes.begin(); it != m_meshes.end();)
+  {
+    it = it->second.expired() ? m_meshes.erase(it) : std::next(it);
+  }
+
+  for(auto it = m_materials.begin(); it != m_materials.end();)
+  {
+    it = it->second.expired() ? m_materials.erase(it) : std::next(it);
+  }
+
+  // sweep again once the live entries have doubled, so the cost
+  // stays constant per insertion
+  m_prune_size = std::max<size_t>(64, 2 * (m_meshes.size() + m_materials.size()));
+}
+
+void
+ResourceCache::print_stats() const
+{
+  log_info("ResourceCache: meshes: %d hits, %d misses, %d bytes saved; materials: %d hits, %d misses",
+           m_stats.mesh_hits, m_stats.mesh_misses, m_stats.bytes_saved,
+           m_stats.material_hits, m_stats.material_misses);
+}
+
+/* EOF */
@@ -0,0 +1,103 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_RESOURCE_CACHE_HPP
+#define HEADER_RESOURCE_CACHE_HPP
+
+#include <boost/filesystem/path.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "material.hpp"
+#include "mesh.hpp"
+#include "mesh_hash.hpp"
+
+/** Shares meshes with identical content and materials loaded from the
+    same file between all loaded scenes. Entries are only weakly
+    referenced, so they go away together with the last scene using
+    them. Must only be used from the thread owning the GL context. */
+class ResourceCache
+{
+public:
+  struct Stats
+  {
+    int mesh_hits;
+    int mesh_misses;
+    int material_hits;
+    int material_misses;
+
+    /** GPU memory of the meshes that didn't have to be uploaded */
+    size_t bytes_saved;
+
+    Stats() :
+      mesh_hits(),
+      mesh_misses(),
+      material_hits(),
+      material_misses(),
+      bytes_saved()
+    {}
+  };
+
+private:
+  /** keyed by two independent 64 bit hashes and the size of the
+      arrays, a false hit would need both hashes to collide */
+  std::unordered_map<MeshHash::Key, std::weak_ptr<Mesh>, MeshHash::KeyHash> m_meshes;
+  std::unordered_map<std::string, std::weak_ptr<Material> > m_materials;
+  Stats m_stats;
+
+  /** entry count at which expired entries get dropped next */
+  size_t m_prune_size;
+
+public:
+  ResourceCache();
+
+  /** Returns the mesh with the given content, calls \a create to
+      build it when it isn't in the cache */
+  MeshPtr get_mesh(const MeshHash& hash, const std::function<MeshPtr ()>& create);
+
+  /** Returns the material loaded from \a filename, different paths to
+      the same file give the same material */
+  MaterialPtr get_material(const boost::filesystem::path& filename);
+
+  const Stats& get_stats() const { return m_stats; }
+  void print_stats() const;
+
+  static ResourceCache& get()
+  {
+    static ResourceCache* instance = 0;
+    if (!instance)
+    {
+      instance = new ResourceCache;
+    }
+    return *instance;
+  }
+
+private:
+  /** Drop the entries whose resources are gone, once the maps have
+      grown enough since the last time */
+  void prune();
+
+private:
+  ResourceCache(const ResourceCache&);
+  ResourceCache& operator=(const ResourceCache&);
+};
+
+#endif
+
+/* EOF */
@@ -1,30 +1,290 @@
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
 #include <fstream>
 #include <stdexcept>
 
+#include "mapped_file.hpp"
+#include "scene_binary.hpp"
 #include "scene_node.hpp"
+#include "scene_object.hpp"
+#include "scene_parser.hpp"
 #include "material_factory.hpp"
+#include "log.hpp"
+#include "mesh_hash.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_packing.hpp"
+#include "resource_cache.hpp"
+#include "thread_pool.hpp"
 
 #include "scene.hpp"
 
-std::unique_ptr<SceneNode>
-Scene::from_file(const std::string& filename)
+namespace {
+
+/** The arrays of a mesh, either from a MeshData or pointing into a
+    mmap()'ed .modb file */
+struct MeshArrays
+{
+  const glm::vec3* position;
+  const glm::vec3* texcoord;
+  const glm::vec3* normal;
+  size_t position_count;
+  size_t texcoord_count;
+  size_t normal_count;
+
+  const glm::vec4* bone_weight;
+  const glm::ivec4* bone_index;
+  size_t bone_count;
+
+  const int* index;
+  size_t index_count;
+
+  MeshArrays(const MeshData& data) :
+    position(data.position.data()),
+    texcoord(data.texcoord.data()),
+    normal(data.normal.data()),
+    position_count(data.position.size()),
+    texcoord_count(data.texcoord.size()),
+    normal_count(data.normal.size()),
+    bone_weight(data.bone_weight.data()),
+    bone_index(data.bone_index.data()),
+    bone_count(data.has_bones() ? data.bone_weight.size() : 0),
+    index(data.index.data()),
+    index_count(data.index.size())
+  {}
+
+  MeshArrays(const BinaryObject& obj) :
+    position(obj.position),
+    texcoord(obj.texcoord),
+    normal(obj.normal),
+    position_count(obj.position_count),
+    texcoord_count(obj.texcoord_count),
+    normal_count(obj.normal_count),
+    bone_weight(obj.bone_weight),
+    bone_index(obj.bone_index),
+    bone_count(obj.bone_count),
+    index(obj.index),
+    index_count(obj.index_count)
+  {}
+
+  MeshArrays(const MeshArrays&) = default;
+  MeshArrays& operator=(const MeshArrays&) = default;
+};
+
+// same order as hash_mesh(const MeshData&), so .mod and .modb files
+// share cache entries
+MeshHash hash_mesh(const MeshArrays& arrays)
+{
+  MeshHash hash;
+  hash.add(arrays.position, arrays.position_count);
+  hash.add(arrays.texcoord, arrays.texcoord_count);
+  hash.add(arrays.normal, arrays.normal_count);
+  hash.add(arrays.index, arrays.index_count);
+  if (arrays.bone_count != 0)
+  {
+    hash.add(arrays.bone_weight, arrays.bone_count);
+    hash.add(arrays.bone_index, arrays.bone_count);
+  }
+  return hash;
+}
+
+/** Size of the arrays as uploaded without any compact encoding */
+size_t get_uncompressed_bytes(const MeshArrays& arrays)
+{
+  return
+    sizeof(glm::vec3) * (arrays.position_count + arrays.texcoord_count + arrays.normal_count) +
+    (sizeof(glm::vec4) + sizeof(glm::ivec4)) * arrays.bone_count +
+    sizeof(int) * arrays.index_count;
+}
+
+/** The compact encodings of the arrays, see mesh_packing.hpp */
+struct PackedArrays
 {
-  std::ifstream in(filename.c_str());
-  if(!in)
+  /** empty when texcoord_type is GL_FLOAT */
+  std::vector<uint32_t> texcoord;
+  GLenum texcoord_type;
+  std::vector<uint32_t> normal;
+  std::vector<uint32_t> bone_weight;
+  std::vector<uint16_t> index;
+  bool short_index;
+
+  PackedArrays(const MeshArrays& arrays) :
+    texcoord(),
+    texcoord_type(),
+    normal(),
+    bone_weight(),
+    index(),
+    short_index()
+  {
+    switch(pack_texcoords(arrays.texcoord, arrays.texcoord_count, texcoord))
+    {
+      case TexcoordEncoding::Unorm16: texcoord_type = GL_UNSIGNED_SHORT; break;
+      case TexcoordEncoding::Half:    texcoord_type = GL_HALF_FLOAT; break;
+      case TexcoordEncoding::Float:   texcoord_type = GL_FLOAT; break;
+    }
+    pack_normals(arrays.normal, arrays.normal_count, normal);
+    pack_bone_weights(arrays.bone_weight, arrays.bone_count, bone_weight);
+    short_index = pack_indices(arrays.index, arrays.index_count, index);
+  }
+
+private:
+  PackedArrays(const PackedArrays&) = delete;
+  PackedArrays& operator=(const PackedArrays&) = delete;
+};
+
+MeshPtr create_mesh(const MeshArrays& arrays, const SceneLoadOptions& opts)
+{
+  MeshPtr mesh = std::make_shared<Mesh>(GL_TRIANGLES);
+
+  std::unique_ptr<PackedArrays> packed;
+  if (opts.get_compact())
   {
-    throw std::runtime_error(format("%s: File not found", filename));
+    packed.reset(new PackedArrays(arrays));
+  }
+
+  if (opts.get_interleaved() &&
+      arrays.texcoord_count == arrays.position_count &&
+      arrays.normal_count == arrays.position_count &&
+      (arrays.bone_count == 0 || arrays.bone_count == arrays.position_count))
+  {
+    std::vector<Mesh::Interleaved> interleaved_arrays;
+    interleaved_arrays.push_back(Mesh::interleaved_float("position", arrays.position));
+    if (packed && packed->texcoord_type != GL_FLOAT)
+    {
+      interleaved_arrays.push_back(Mesh::interleaved_packed("texcoord", 2, packed->texcoord_type,
+                                                            packed->texcoord_type == GL_UNSIGNED_SHORT,
+                                                            packed->texcoord.data()));
+    }
+    else
+    {
+      interleaved_arrays.push_back(Mesh::interleaved_float("texcoord", arrays.texcoord));
+    }
+
+    if (packed)
+    {
+      interleaved_arrays.push_back(Mesh::interleaved_packed("normal", 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+                                                            packed->normal.data()));
+    }
+    else
+    {
+      interleaved_arrays.push_back(Mesh::interleaved_float("normal", arrays.normal));
+    }
+
+    if (arrays.bone_count != 0)
+    {
+      if (packed)
+      {
+        interleaved_arrays.push_back(Mesh::interleaved_packed("bone_weight", 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                                                              packed->bone_weight.data()));
+      }
+      else
+      {
+        interleaved_arrays.push_back(Mesh::interleaved_float("bone_weight", arrays.bone_weight));
+      }
+      interleaved_arrays.push_back(Mesh::interleaved_int("bone_index", arrays.bone_index));
+    }
+
+    mesh->attach_interleaved_arrays(interleaved_arrays, arrays.position_count);
   }
   else
   {
-    Scene scene;
-    scene.set_directory(boost::filesystem::path(filename).parent_path());
-    scene.parse_istream(in);
-    return scene.get_node();
+    mesh->attach_float_array("position", arrays.position, arrays.position_count);
+    if (packed && packed->texcoord_type != GL_FLOAT)
+    {
+      mesh->attach_packed_array("texcoord", 2, packed->texcoord_type, packed->texcoord_type == GL_UNSIGNED_SHORT,
+                                packed->texcoord.data(), packed->texcoord.size());
+    }
+    else
+    {
+      mesh->attach_float_array("texcoord", arrays.texcoord, arrays.texcoord_count);
+    }
+
+    if (packed)
+    {
+      mesh->attach_packed_array("normal", 4, GL_INT_2_10_10_10_REV, GL_TRUE,
+                                packed->normal.data(), packed->normal.size());
+    }
+    else
+    {
+      mesh->attach_float_array("normal", arrays.normal, arrays.normal_count);
+    }
+
+    if (arrays.bone_count != 0)
+    {
+      if (packed)
+      {
+        mesh->attach_packed_array("bone_weight", 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                                  packed->bone_weight.data(), packed->bone_weight.size());
+      }
+      else
+      {
+        mesh->attach_float_array("bone_weight", arrays.bone_weight, arrays.bone_count);
+      }
+      mesh->attach_int_array("bone_index", arrays.bone_index, arrays.bone_count);
+    }
+  }
+
+  if (packed && packed->short_index)
+  {
+    mesh->attach_element_array(packed->index);
+  }
+  else
+  {
+    mesh->attach_element_array(arrays.index, arrays.index_count);
   }
+
+  // skinned meshes get deformed in the vertex shader, so the bind
+  // pose says little about where they end up
+  if (arrays.bone_count == 0)
+  {
+    mesh->set_bounds(AABB::from_points(arrays.position, arrays.position_count));
+  }
+
+  return mesh;
+}
+
+/** Create the mesh or take it from the ResourceCache, the encoding
+    options are part of the cache key, created meshes are added to
+    \a stats */
+MeshPtr get_mesh(const MeshArrays& arrays, const SceneLoadOptions& opts, Scene::MeshStats& stats)
+{
+  auto create = [&arrays, &opts, &stats]{
+    MeshPtr mesh = create_mesh(arrays, opts);
+    stats.meshes += 1;
+    stats.gpu_bytes += mesh->get_gpu_bytes();
+    stats.uncompressed_bytes += get_uncompressed_bytes(arrays);
+    return mesh;
+  };
+
+  if (opts.get_cache())
+  {
+    MeshHash hash = hash_mesh(arrays);
+    const bool format[] = { opts.get_interleaved(), opts.get_compact() };
+    hash.add(format, 2);
+    return ResourceCache::get().get_mesh(hash, create);
+  }
+  else
+  {
+    return create();
+  }
+}
+
+} // namespace
+
+std::unique_ptr<SceneNode>
+Scene::from_file(const std::string& filename, const SceneLoadOptions& opts)
+{
+  Scene scene(opts);
+  scene.set_directory(boost::filesystem::path(filename).parent_path());
+  scene.parse_file(filename);
+  return scene.get_node();
+}
+
+std::unique_ptr<SceneNode>
+Scene::from_binary_file(const std::string& filename, const SceneLoadOptions& opts)
+{
+  Scene scene(opts);
+  scene.set_directory(boost::filesystem::path(filename).parent_path());
+  scene.parse_binary_file(filename);
+  return scene.get_node();
 }
 
 std::unique_ptr<SceneNode>
@@ -34,10 +294,26 @@ Scene::from_istream(std::istream& in)
   scene.parse_istream(in);
   return scene.get_node();
 }
-
-Scene::Scene() :
+
+Scene::Scene(const SceneLoadOptions& opts) :
+  m_options(opts),
+  m_directory(),
+  m_node(new SceneNode),
+  m_root(m_node.get()),
+  m_nodes(),
+  m_unattached_children(),
+  m_mesh_stats()
+{
+}
+
+Scene::Scene(const SceneLoadOptions& opts, SceneNode* root) :
+  m_options(opts),
   m_directory(),
-  m_node(new SceneNode)
+  m_node(),
+  m_root(root),
+  m_nodes(),
+  m_unattached_children(),
+  m_mesh_stats()
 {
 }
 
@@ -50,295 +326,250 @@ Scene::set_directory(const boost::filesystem::path& path)
 void
 Scene::parse_istream(std::istream& in)
 {
-  // This is not a fully featured .obj file reader, it just takes some
-  // inspiration from it: 
-  // http://www.martinreddy.net/gfx/3d/OBJ.spec
-  std::unordered_map<std::string, SceneNode*> nodes;
-  std::unordered_map<std::string, std::unique_ptr<SceneNode> > unattached_children;
-
-  std::string name;
-  std::string parent;
-  std::string material = "phong";
-  glm::vec3 location(0.0f, 0.0f, 0.0f);
-  glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
-  glm::vec3 scale(1.0f, 1.0f, 1.0f);
-  std::vector<glm::vec3>  normal;
-  std::vector<glm::vec3>  position;
-  std::vector<glm::vec3>  texcoord;
-  std::vector<int>        index;
-  std::vector<glm::vec4>  bone_weight;
-  std::vector<glm::ivec4> bone_index;
-  std::vector<int>        bone_count;
-
-  auto commit_object = [&]{
-    if (!name.empty())
+  SceneParser parser("<unknown>", [this](SceneObject& obj){
+      prepare_object(obj, m_options);
+      add_object(obj);
+    });
+  parser.parse_istream(in);
+  reconstruct_hierarchy();
+  log_mesh_stats("<unknown>");
+}
+
+void
+Scene::parse_file(const std::string& filename)
+{
+  MappedFile file(filename);
+  if (m_options.get_threads() == 1 || !SceneParser::is_worth_splitting(file.begin(), file.end()))
+  {
+    SceneParser parser(filename, [this](SceneObject& obj){
+        prepare_object(obj, m_options);
+        add_object(obj);
+      });
+    parser.parse(file.begin(), file.end());
+  }
+  else
+  {
+    // objects are parsed and prepared on the pool, the GL upload in
+    // add_object() stays on this thread
+    ThreadPool pool(m_options.get_threads());
+    SceneParser::parse_parallel(filename, file.begin(), file.end(), pool,
+                                [this](SceneObject& obj){ add_object(obj); },
+                                [this](SceneObject& obj){ prepare_object(obj, m_options); });
+  }
+  reconstruct_hierarchy();
+  log_mesh_stats(filename);
+}
+
+void
+Scene::parse_binary_file(const std::string& filename)
+{
+  MappedFile file(filename);
+  SceneBinaryReader reader(filename, file.begin(), file.end());
+
+  std::vector<SceneNode*> nodes;
+  nodes.reserve(reader.get_object_count());
+  std::vector<std::pair<int, std::unique_ptr<SceneNode> > > children;
+
+  BinaryObject obj;
+  while(reader.next(obj))
+  {
+    ModelPtr model;
+
+    if (obj.position_count == 0)
     {
-      ModelPtr model;
-        
-      if (!position.empty())
-      {
-        // fill in some texcoords if there aren't enough
-        if (texcoord.size() < position.size())
-        {
-          texcoord.resize(position.size());
-          for(FaceLst::size_type i = position.size()-1; i < texcoord.size(); ++i)
-          {
-            texcoord[i] = glm::vec3(0.0f, 0.0f, 0.0f);
-          }
-        }
-
-        {
-          // create Mesh
-          std::unique_ptr<Mesh> mesh(new Mesh(GL_TRIANGLES));
-
-          mesh->attach_float_array("position", position);
-          mesh->attach_float_array("texcoord", texcoord);
-          mesh->attach_float_array("normal",   normal);
-          mesh->attach_element_array(index);
-
-          if (!bone_weight.empty() && !bone_index.empty())
-          {
-            mesh->attach_float_array("bone_weight", bone_weight);
-            mesh->attach_int_array("bone_index", bone_index);
-          }
-
-          // create Model
-          model = std::make_shared<Model>();
-          model->add_mesh(std::move(mesh));
-          
-          if (boost::algorithm::ends_with(material, ".material"))
-          {
-            model->set_material(MaterialFactory::get().from_file(m_directory / boost::filesystem::path(material)));
-          }
-          else
-          {
-            model->set_material(MaterialFactory::get().create(material));
-          }
-        }
-      }
+      // no mesh
+    }
+    else if (m_options.get_weld() || m_options.get_optimize())
+    {
+      // the mesh gets rewritten, so it needs a copy of its own
+      SceneObject copy;
+      copy.name = obj.name;
+      copy.mesh.position.assign(obj.position, obj.position + obj.position_count);
+      copy.mesh.texcoord.assign(obj.texcoord, obj.texcoord + obj.texcoord_count);
+      copy.mesh.normal.assign(obj.normal, obj.normal + obj.normal_count);
+      copy.mesh.bone_weight.assign(obj.bone_weight, obj.bone_weight + obj.bone_count);
+      copy.mesh.bone_index.assign(obj.bone_index, obj.bone_index + obj.bone_count);
+      copy.mesh.index.assign(obj.index, obj.index + obj.index_count);
+      prepare_object(copy, m_options);
 
-      // create SceneNode
-      {
-        std::unique_ptr<SceneNode> node(new SceneNode(name));
-        node->set_position(location);
-        node->set_orientation(rotation);
-        node->set_scale(scale);
-        
-        if (model)
-        {
-          node->attach_model(model);
-        }
-
-        if (nodes.find(name) != nodes.end())
-        {
-          throw std::runtime_error("duplicate object name: " + name);
-        }
-
-        nodes[name] = node.get();
-        if (parent.empty())
-        {
-          m_node->attach_child(std::move(node));
-        }
-        else
-        {
-          unattached_children[parent] = std::move(node);
-        }
-      }
+      MeshPtr mesh = get_mesh(MeshArrays(copy.mesh), m_options, m_mesh_stats);
+      model = create_model(mesh, obj.material);
+    }
+    else
+    {
+      // the arrays point into the mmap()'ed file and go straight to glBufferData()
+      MeshPtr mesh = get_mesh(MeshArrays(obj), m_options, m_mesh_stats);
+      model = create_model(mesh, obj.material);
+    }
 
-      // clear for the next mesh
-      name.clear();
-      parent.clear();
-      normal.clear();
-      texcoord.clear();
-      position.clear();
-      index.clear();
-      location = glm::vec3(0.0f, 0.0f, 0.0f);
-      rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-      scale = glm::vec3(1.0f, 1.0f, 1.0f);
+    std::unique_ptr<SceneNode> node = create_node(obj.name, obj.location, obj.rotation, obj.scale, model);
+    nodes.push_back(node.get());
+    if (obj.parent < 0)
+    {
+      m_root->attach_child(std::move(node));
     }
-  };
+    else
+    {
+      children.emplace_back(obj.parent, std::move(node));
+    }
+  }
 
-  std::string line;
-  int line_number = 0;
-  while(std::getline(in, line))
+  for(auto& it : children)
   {
-    line_number += 1;
-
-    boost::tokenizer<boost::char_separator<char> > tokens(line, boost::char_separator<char>(" ", ""));
-    auto it = tokens.begin();
-    if (it != tokens.end())
+    if (static_cast<size_t>(it.first) >= nodes.size())
     {
-#define INCR_AND_CHECK {                                                \
-        ++it;                                                           \
-        if (it == tokens.end())                                         \
-        {                                                               \
-          throw std::runtime_error((boost::format("not enough tokens at line %d") % line_number).str()); \
-        }                                                               \
-      }
+      throw std::runtime_error(format("%s: parent index out of range: %d", filename, it.first));
+    }
+    nodes[it.first]->attach_child(std::move(it.second));
+  }
 
-      try
-      {  
-        if (*it == "o")
-        {
-          // object
-          commit_object();
-
-          INCR_AND_CHECK;
-          log_debug("object: '%s'", *it);
-          name = *it;
-        }
-        else if (*it == "g")
-        {
-          // group
-        }
-        else if (*it == "parent")
-        {
-          INCR_AND_CHECK;
-          parent = *it;
-        }
-        else if (*it == "mat")
-        {
-          INCR_AND_CHECK;
-          material = *it;
-        }
-        else if (*it == "loc")
-        {
-          INCR_AND_CHECK;
-          location.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          location.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          location.z = boost::lexical_cast<float>(*it);
-        }
-        else if (*it == "rot")
-        {
-          INCR_AND_CHECK;
-          rotation.w = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          rotation.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          rotation.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          rotation.z = boost::lexical_cast<float>(*it);
-        }
-        else if (*it == "scale")
-        {
-          INCR_AND_CHECK;
-          scale.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          scale.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          scale.z = boost::lexical_cast<float>(*it);
-        }
-        else if (*it == "v")
-        {
-          glm::vec3 v;
-
-          INCR_AND_CHECK;
-          v.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          v.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          v.z = boost::lexical_cast<float>(*it);
-          
-          position.push_back(v);
-        }
-        else if (*it == "vt")
-        {
-          glm::vec3 vt;
-
-          INCR_AND_CHECK;
-          vt.s = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          vt.t = boost::lexical_cast<float>(*it);
-
-          texcoord.push_back(vt);
-        }
-        else if (*it == "vn")
-        {
-          glm::vec3 vn;
-
-          INCR_AND_CHECK;
-          vn.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          vn.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          vn.z = boost::lexical_cast<float>(*it);
-
-          normal.push_back(vn);
-        }
-        else if (*it == "bw")
-        {
-          glm::vec4 bw;
-
-          INCR_AND_CHECK;
-          bw.x = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          bw.y = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          bw.z = boost::lexical_cast<float>(*it);
-          INCR_AND_CHECK;
-          bw.w = boost::lexical_cast<float>(*it);
-          
-          bone_weight.push_back(bw);
-        }
-        else if (*it == "bi")
-        {
-          glm::ivec4 bi;
-
-          INCR_AND_CHECK;
-          bi.x = boost::lexical_cast<int>(*it);
-          INCR_AND_CHECK;
-          bi.y = boost::lexical_cast<int>(*it);
-          INCR_AND_CHECK;
-          bi.z = boost::lexical_cast<int>(*it);
-          INCR_AND_CHECK;
-          bi.w = boost::lexical_cast<int>(*it);
-          
-          bone_index.push_back(bi);
-        }
-        else if (*it == "f")
-        {
-          INCR_AND_CHECK;
-          index.push_back(boost::lexical_cast<int>(*it));
-          INCR_AND_CHECK;
-          index.push_back(boost::lexical_cast<int>(*it));
-          INCR_AND_CHECK;
-          index.push_back(boost::lexical_cast<int>(*it));
-        }
-        else if ((*it)[0] == '#')
-        {
-          // ignore comments
-        }
-        else
-        {
-          throw std::runtime_error((boost::format("unhandled token %s") % *it).str());
-        }
-      }
-      catch(const std::exception& err)
-      {
-        throw std::runtime_error((boost::format("unknown:%d: %s") % line_number % err.what()).str());
-      }
+  log_mesh_stats(filename);
+}
+
+void
+Scene::prepare_object(SceneObject& obj, const SceneLoadOptions& opts)
+{
+  // this runs on the parser threads before anything else looked at
+  // the indices, so catch broken files before the optimizer uses them
+  if (opts.get_weld() || opts.get_optimize())
+  {
+    try
+    {
+      check_vertex_indices(obj.mesh.index, obj.mesh.position.size());
     }
+    catch(const std::exception& err)
+    {
+      throw std::runtime_error(format("%s: %s", obj.name, err.what()));
+    }
+  }
+
+  if (opts.get_weld() && !obj.mesh.position.empty())
+  {
+    size_t before = obj.mesh.position.size();
+    size_t after = weld_vertices(obj.mesh);
+    log_info("%s: welded %d vertices to %d", obj.name, before, after);
+  }
+
+  if (opts.get_optimize() && !obj.mesh.index.empty())
+  {
+    VertexCacheStats before = analyze_vertex_cache(obj.mesh.index, obj.mesh.position.size());
+    optimize_vertex_cache(obj.mesh);
+    optimize_vertex_fetch(obj.mesh);
+    VertexCacheStats after = analyze_vertex_cache(obj.mesh.index, obj.mesh.position.size());
+    log_info("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+             obj.name, before.acmr, after.acmr, before.atvr, after.atvr);
+  }
+}
+
+void
+Scene::add_object(SceneObject& obj)
+{
+  ModelPtr model;
+
+  if (!obj.mesh.position.empty())
+  {
+    MeshPtr mesh = get_mesh(MeshArrays(obj.mesh), m_options, m_mesh_stats);
+    model = create_model(mesh, obj.material);
+  }
+
+  std::unique_ptr<SceneNode> node = create_node(obj.name, obj.location, obj.rotation, obj.scale, model);
+
+  if (m_nodes.find(obj.name) != m_nodes.end())
+  {
+    throw std::runtime_error("duplicate object name: " + obj.name);
   }
 
-  commit_object();
+  SceneNode* node_ptr = node.get();
+  m_nodes[obj.name] = node_ptr;
+  if (obj.parent.empty())
+  {
+    m_root->attach_child(std::move(node));
+  }
+  else
+  {
+    auto p = m_nodes.find(obj.parent);
+    if (p != m_nodes.end())
+    {
+      p->second->attach_child(std::move(node));
+    }
+    else
+    {
+      m_unattached_children.emplace_back(obj.parent, std::move(node));
+    }
+  }
 
-  // reconstruct parent/child relationships
-  for(auto& it : unattached_children)
+  // pick up the children that came before their parent
+  for(auto it = m_unattached_children.begin(); it != m_unattached_children.end();)
   {
-    auto p = nodes.find(it.first);
-    if (p == nodes.end())
+    if (it->first == obj.name)
     {
-      throw std::runtime_error("parent not found: " + it.first);
+      node_ptr->attach_child(std::move(it->second));
+      it = m_unattached_children.erase(it);
     }
     else
     {
-      p->second->attach_child(std::move(it.second));
+      ++it;
     }
   }
 }
 
+ModelPtr
+Scene::create_model(MeshPtr mesh, const std::string& material)
+{
+  ModelPtr model = std::make_shared<Model>();
+  model->add_mesh(mesh);
+
+  if (boost::algorithm::ends_with(material, ".material"))
+  {
+    boost::filesystem::path path = m_directory / boost::filesystem::path(material);
+    model->set_material(m_options.get_cache() ?
+                        ResourceCache::get().get_material(path) :
+                        MaterialFactory::get().from_file(path));
+  }
+  else
+  {
+    model->set_material(MaterialFactory::get().create(material));
+  }
+
+  return model;
+}
+
+std::unique_ptr<SceneNode>
+Scene::create_node(const std::string& name,
+                   const glm::vec3& location, const glm::quat& rotation, const glm::vec3& scale,
+                   ModelPtr model)
+{
+  std::unique_ptr<SceneNode> node(new SceneNode(name));
+  node->set_position(location);
+  node->set_orientation(rotation);
+  node->set_scale(scale);
+
+  if (model)
+  {
+    node->attach_model(model);
+  }
+
+  return node;
+}
+
+void
+Scene::reconstruct_hierarchy()
+{
+  // add_object() attaches children as soon as their parent shows up,
+  // so whatever is left over has no parent at all
+  if (!m_unattached_children.empty())
+  {
+    throw std::runtime_error("parent not found: " + m_unattached_children.front().first);
+  }
+}
+
+void
+Scene::log_mesh_stats(const std::string& name) const
+{
+  log_info("%s: %d meshes, %d bytes of GPU memory, %d bytes uncompressed",
+           name, m_mesh_stats.meshes, m_mesh_stats.gpu_bytes, m_mesh_stats.uncompressed_bytes);
+}
+
 std::unique_ptr<SceneNode>
 Scene::get_node()
 {
@@ -2,28 +2,97 @@
 #define HEADER_SCENE_HPP
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <boost/filesystem/path.hpp>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
 
+#include "scene_load_options.hpp"
+
+class Mesh;
+class Model;
 class SceneNode;
+struct SceneObject;
+
+typedef std::shared_ptr<Mesh> MeshPtr;
+typedef std::shared_ptr<Model> ModelPtr;
 
 class Scene
 {
+public:
+  /** Meshes created by a Scene, meshes taken from the ResourceCache
+      are not counted */
+  struct MeshStats
+  {
+    int meshes;
+    size_t gpu_bytes;
+    size_t uncompressed_bytes;
+
+    MeshStats() : meshes(), gpu_bytes(), uncompressed_bytes() {}
+  };
+
 public:
   static std::unique_ptr<SceneNode> from_istream(std::istream& in);
-  static std::unique_ptr<SceneNode> from_file(const std::string& filename);
+
+  /** Load a .mod file, the file is mmap()'ed and parsed in place,
+      split at object boundaries over opts.get_threads() threads */
+  static std::unique_ptr<SceneNode> from_file(const std::string& filename,
+                                              const SceneLoadOptions& opts = SceneLoadOptions());
+
+  /** Load a .modb file as written by mod2modb, vertex and index
+      data is uploaded directly from the mmap()'ed file, unless
+      opts asks for welding or optimizing, opts.get_threads() is
+      ignored */
+  static std::unique_ptr<SceneNode> from_binary_file(const std::string& filename,
+                                                     const SceneLoadOptions& opts = SceneLoadOptions());
 
 private:
+  SceneLoadOptions m_options;
   boost::filesystem::path m_directory;
   std::unique_ptr<SceneNode> m_node;
+  SceneNode* m_root;
+  std::unordered_map<std::string, SceneNode*> m_nodes;
+  std::vector<std::pair<std::string, std::unique_ptr<SceneNode> > > m_unattached_children;
+  MeshStats m_mesh_stats;
 
 public:
-  Scene();
-  
+  Scene(const SceneLoadOptions& opts = SceneLoadOptions());
+
+  /** Attach the objects below \a root instead of a node of its own,
+      get_node() returns nullptr in that case */
+  Scene(const SceneLoadOptions& opts, SceneNode* root);
+
   void set_directory(const boost::filesystem::path& path);
   void parse_istream(std::istream& in);
+  void parse_file(const std::string& filename);
+  void parse_binary_file(const std::string& filename);
   std::unique_ptr<SceneNode> get_node();
 
+  /** CPU side processing of \a obj as requested in \a opts, doesn't
+      touch OpenGL and can be run on any thread */
+  static void prepare_object(SceneObject& obj, const SceneLoadOptions& opts);
+
+  /** Create the Mesh, Model and SceneNode for \a obj, must be called
+      from the thread owning the GL context */
+  void add_object(SceneObject& obj);
+
+  /** Throws if an object refers to a parent that was never added */
+  void reconstruct_hierarchy();
+
+  /** Print one line with the memory used by the created meshes */
+  void log_mesh_stats(const std::string& name) const;
+
+private:
+  ModelPtr create_model(MeshPtr mesh, const std::string& material);
+  std::unique_ptr<SceneNode> create_node(const std::string& name,
+                                         const glm::vec3& location, const glm::quat& rotation, const glm::vec3& scale,
+                                         ModelPtr model);
+
 private:
   Scene(const Scene&);
   Scene& operator=(const Scene&);
@@ -0,0 +1,322 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "scene_binary.hpp"
+
+#include <ostream>
+#include <stdexcept>
+#include <string.h>
+#include <unordered_map>
+
+#include "format.hpp"
+
+namespace {
+
+const char s_magic[4] = { 'M', 'O', 'D', 'B' };
+const uint32_t s_byte_order_mark = 0x01020304;
+
+size_t padding(size_t len)
+{
+  return (4 - len % 4) % 4;
+}
+
+void write_u32(std::ostream& out, uint32_t v)
+{
+  out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void write_float(std::ostream& out, float v)
+{
+  out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void write_string(std::ostream& out, const std::string& str)
+{
+  static const char zeros[4] = { 0, 0, 0, 0 };
+  write_u32(out, static_cast<uint32_t>(str.size()));
+  out.write(str.data(), str.size());
+  out.write(zeros, padding(str.size()));
+}
+
+template<typename T>
+void write_array(std::ostream& out, const std::vector<T>& vec)
+{
+  out.write(reinterpret_cast<const char*>(vec.data()), sizeof(T) * vec.size());
+}
+
+/** Return the index of an object whose parent chain leads back to
+    itself, or -1 when the parents form a proper tree, \a parents must
+    only contain valid indices or -1 */
+int find_parent_cycle(const std::vector<int>& parents)
+{
+  enum { kUnvisited, kVisiting, kDone };
+  std::vector<int> state(parents.size(), kUnvisited);
+
+  for(size_t i = 0; i < parents.size(); ++i)
+  {
+    int j = static_cast<int>(i);
+    while(j != -1 && state[j] == kUnvisited)
+    {
+      state[j] = kVisiting;
+      j = parents[j];
+    }
+
+    if (j != -1 && state[j] == kVisiting)
+    {
+      return j;
+    }
+
+    for(j = static_cast<int>(i); j != -1 && state[j] == kVisiting; j = parents[j])
+    {
+      state[j] = kDone;
+    }
+  }
+
+  return -1;
+}
+
+} // namespace
+
+void
+SceneBinaryWriter::write(std::ostream& out, const std::vector<SceneObject>& objects)
+{
+  std::unordered_map<std::string, int> name2index;
+  for(size_t i = 0; i < objects.size(); ++i)
+  {
+    if (!name2index.insert(std::make_pair(objects[i].name, static_cast<int>(i))).second)
+    {
+      throw std::runtime_error("duplicate object name: " + objects[i].name);
+    }
+  }
+
+  std::vector<int> parents(objects.size(), -1);
+  for(size_t i = 0; i < objects.size(); ++i)
+  {
+    if (!objects[i].parent.empty())
+    {
+      auto it = name2index.find(objects[i].parent);
+      if (it == name2index.end())
+      {
+        throw std::runtime_error("parent not found: " + objects[i].parent);
+      }
+      parents[i] = it->second;
+    }
+  }
+
+  int cycle = find_parent_cycle(parents);
+  if (cycle != -1)
+  {
+    throw std::runtime_error("object is its own ancestor: " + objects[cycle].name);
+  }
+
+  out.write(s_magic, sizeof(s_magic));
+  write_u32(out, s_version);
+  write_u32(out, s_byte_order_mark);
+  write_u32(out, static_cast<uint32_t>(objects.size()));
+
+  for(size_t i = 0; i < objects.size(); ++i)
+  {
+    const SceneObject& obj = objects[i];
+
+    write_string(out, obj.name);
+    write_string(out, obj.material);
+    write_u32(out, static_cast<uint32_t>(parents[i]));
+
+    write_float(out, obj.location.x);
+    write_float(out, obj.location.y);
+    write_float(out, obj.location.z);
+
+    write_float(out, obj.rotation.w);
+    write_float(out, obj.rotation.x);
+    write_float(out, obj.rotation.y);
+    write_float(out, obj.rotation.z);
+
+    write_float(out, obj.scale.x);
+    write_float(out, obj.scale.y);
+    write_float(out, obj.scale.z);
+
+    const MeshData& mesh = obj.mesh;
+
+    write_u32(out, static_cast<uint32_t>(mesh.position.size()));
+    write_array(out, mesh.position);
+
+    write_u32(out, static_cast<uint32_t>(mesh.normal.size()));
+    write_array(out, mesh.normal);
+
+    write_u32(out, static_cast<uint32_t>(mesh.texcoord.size()));
+    write_array(out, mesh.texcoord);
+
+    if (mesh.has_bones())
+    {
+      if (mesh.bone_weight.size() != mesh.bone_index.size())
+      {
+        throw std::runtime_error(obj.name + ": bone weight and bone index count differ");
+      }
+      write_u32(out, static_cast<uint32_t>(mesh.bone_weight.size()));
+      write_array(out, mesh.bone_weight);
+      write_array(out, mesh.bone_index);
+    }
+    else
+    {
+      write_u32(out, 0);
+    }
+
+    write_u32(out, static_cast<uint32_t>(mesh.index.size()));
+    write_array(out, mesh.index);
+  }
+
+  if (!out)
+  {
+    throw std::runtime_error("SceneBinaryWriter: write error");
+  }
+}
+
+SceneBinaryReader::SceneBinaryReader(const std::string& filename, const char* begin, const char* end) :
+  m_filename(filename),
+  m_end(end),
+  m_p(begin),
+  m_object_count(0),
+  m_current(0),
+  m_parents()
+{
+  if (memcmp(read(sizeof(s_magic)), s_magic, sizeof(s_magic)) != 0)
+  {
+    throw std::runtime_error(format("%s: not a .modb file", m_filename));
+  }
+
+  uint32_t version = read_u32();
+  if (version != SceneBinaryWriter::s_version)
+  {
+    throw std::runtime_error(format("%s: unsupported .modb version %d, expected %d",
+                                    m_filename, version, SceneBinaryWriter::s_version));
+  }
+
+  if (read_u32() != s_byte_order_mark)
+  {
+    throw std::runtime_error(format("%s: .modb file was written with a different byte order", m_filename));
+  }
+
+  m_object_count = read_u32();
+}
+
+bool
+SceneBinaryReader::next(BinaryObject& obj)
+{
+  if (m_current == m_object_count)
+  {
+    return false;
+  }
+  else
+  {
+    m_current += 1;
+
+    obj.name = read_string();
+    obj.material = read_string();
+    obj.parent = static_cast<int>(read_u32());
+
+    if (obj.parent < -1 || obj.parent >= static_cast<int>(m_object_count))
+    {
+      throw std::runtime_error(format("%s: %s: broken parent index %d", m_filename, obj.name, obj.parent));
+    }
+    else if (obj.parent == static_cast<int>(m_current) - 1)
+    {
+      throw std::runtime_error(format("%s: %s: object is its own parent", m_filename, obj.name));
+    }
+
+    // longer cycles can only be seen once all parents are known
+    m_parents.push_back(obj.parent);
+    if (m_current == m_object_count)
+    {
+      int cycle = find_parent_cycle(m_parents);
+      if (cycle != -1)
+      {
+        throw std::runtime_error(format("%s: object %d is its own ancestor", m_filename, cycle));
+      }
+    }
+
+    obj.location.x = read_float();
+    obj.location.y = read_float();
+    obj.location.z = read_float();
+
+    obj.rotation.w = read_float();
+    obj.rotation.x = read_float();
+    obj.rotation.y = read_float();
+    obj.rotation.z = read_float();
+
+    obj.scale.x = read_float();
+    obj.scale.y = read_float();
+    obj.scale.z = read_float();
+
+    obj.position_count = read_u32();
+    obj.position = read_array<glm::vec3>(obj.position_count);
+
+    obj.normal_count = read_u32();
+    obj.normal = read_array<glm::vec3>(obj.normal_count);
+
+    obj.texcoord_count = read_u32();
+    obj.texcoord = read_array<glm::vec3>(obj.texcoord_count);
+
+    obj.bone_count = read_u32();
+    obj.bone_weight = read_array<glm::vec4>(obj.bone_count);
+    obj.bone_index = read_array<glm::ivec4>(obj.bone_count);
+
+    obj.index_count = read_u32();
+    obj.index = read_array<int>(obj.index_count);
+
+    return true;
+  }
+}
+
+const char*
+SceneBinaryReader::read(size_t len)
+{
+  size_t padded_len = len + padding(len);
+  if (static_cast<size_t>(m_end - m_p) < padded_len)
+  {
+    throw std::runtime_error(format("%s: unexpected end of file", m_filename));
+  }
+  else
+  {
+    const char* p = m_p;
+    m_p += padded_len;
+    return p;
+  }
+}
+
+uint32_t
+SceneBinaryReader::read_u32()
+{
+  uint32_t v;
+  memcpy(&v, read(sizeof(v)), sizeof(v));
+  return v;
+}
+
+float
+SceneBinaryReader::read_float()
+{
+  float v;
+  memcpy(&v, read(sizeof(v)), sizeof(v));
+  return v;
+}
+
+std::string
+SceneBinaryReader::read_string()
+{
+  uint32_t len = read_u32();
+  return std::string(read(len), len);
+}
+
+/* EOF */
@@ -0,0 +1,144 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SCENE_BINARY_HPP
+#define HEADER_SCENE_BINARY_HPP
+
+#include <iosfwd>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "scene_object.hpp"
+
+/*
+  .modb is the binary form of a .mod file, all values are stored in
+  host byte order and every field is 4 byte aligned, so the vertex
+  and index blobs can be handed to glBufferData() straight from an
+  mmap()'ed file:
+
+    header:  "MODB" u32:version u32:byte_order_mark u32:object_count
+    object:  str:name str:material i32:parent
+             f32[3]:loc f32[4]:rot(w,x,y,z) f32[3]:scale
+             u32:position_count vec3[]:position
+             u32:normal_count   vec3[]:normal
+             u32:texcoord_count vec3[]:texcoord
+             u32:bone_count     vec4[]:bone_weight ivec4[]:bone_index
+             u32:index_count    i32[]:index
+    str:     u32:length char[] padded to 4 bytes
+
+  'parent' is the index of the parent object or -1 for root objects,
+  the parents may come after their children but must not form a
+  cycle.
+*/
+
+/** A single object of a .modb file, the arrays point directly into
+    the file data and are only valid as long as that stays around */
+struct BinaryObject
+{
+  std::string name;
+  std::string material;
+  int parent;
+
+  glm::vec3 location;
+  glm::quat rotation;
+  glm::vec3 scale;
+
+  const glm::vec3* position;
+  size_t position_count;
+
+  const glm::vec3* normal;
+  size_t normal_count;
+
+  const glm::vec3* texcoord;
+  size_t texcoord_count;
+
+  const glm::vec4* bone_weight;
+  const glm::ivec4* bone_index;
+  size_t bone_count;
+
+  const int* index;
+  size_t index_count;
+
+  BinaryObject() :
+    name(),
+    material(),
+    parent(-1),
+    location(),
+    rotation(),
+    scale(),
+    position(), position_count(),
+    normal(), normal_count(),
+    texcoord(), texcoord_count(),
+    bone_weight(), bone_index(), bone_count(),
+    index(), index_count()
+  {}
+
+  BinaryObject(const BinaryObject&) = default;
+  BinaryObject& operator=(const BinaryObject&) = default;
+};
+
+class SceneBinaryWriter
+{
+public:
+  static const uint32_t s_version = 1;
+
+  /** Write the objects, parent names are turned into object indices
+      and must refer to an object in the list without forming a cycle */
+  static void write(std::ostream& out, const std::vector<SceneObject>& objects);
+};
+
+class SceneBinaryReader
+{
+private:
+  std::string m_filename;
+  const char* m_end;
+  const char* m_p;
+  uint32_t m_object_count;
+  uint32_t m_current;
+
+  /** parent indices of the objects read so far */
+  std::vector<int> m_parents;
+
+public:
+  SceneBinaryReader(const std::string& filename, const char* begin, const char* end);
+
+  uint32_t get_object_count() const { return m_object_count; }
+
+  /** Read the next object, returns false when all objects are read,
+      parent cycles are reported when reading the last object */
+  bool next(BinaryObject& obj);
+
+private:
+  const char* read(size_t len);
+  uint32_t read_u32();
+  float read_float();
+  std::string read_string();
+
+  template<typename T>
+  const T* read_array(size_t count)
+  {
+    return reinterpret_cast<const T*>(read(sizeof(T) * count));
+  }
+
+private:
+  SceneBinaryReader(const SceneBinaryReader&) = delete;
+  SceneBinaryReader& operator=(const SceneBinaryReader&) = delete;
+};
+
+#endif
+
+/* EOF */
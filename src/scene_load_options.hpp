@@ -0,0 +1,73 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SCENE_LOAD_OPTIONS_HPP
+#define HEADER_SCENE_LOAD_OPTIONS_HPP
+
+class SceneLoadOptions
+{
+public:
+  SceneLoadOptions() :
+    m_threads(0),
+    m_cache(true),
+    m_weld(false),
+    m_optimize(false),
+    m_interleaved(true),
+    m_compact(false)
+  {}
+
+  /** number of threads used for parsing, 0 means one per core, 1
+      parses on the calling thread */
+  unsigned int get_threads() const { return m_threads; }
+
+  /** share identical meshes and materials via the ResourceCache */
+  bool get_cache() const { return m_cache; }
+
+  /** merge duplicate vertices, see weld_vertices() */
+  bool get_weld() const { return m_weld; }
+
+  /** reorder triangles and vertices for the vertex cache, see
+      optimize_vertex_cache() and optimize_vertex_fetch() */
+  bool get_optimize() const { return m_optimize; }
+
+  /** upload all vertex attributes of a mesh interleaved in one VBO */
+  bool get_interleaved() const { return m_interleaved; }
+
+  /** upload texcoords as half floats or normalized shorts, normals as
+      10:10:10:2, bone weights as bytes and indices as shorts when the
+      vertex count allows, see mesh_packing.hpp */
+  bool get_compact() const { return m_compact; }
+
+  SceneLoadOptions& set_threads(unsigned int threads) { m_threads = threads; return *this; }
+  SceneLoadOptions& set_cache(bool cache) { m_cache = cache; return *this; }
+  SceneLoadOptions& set_weld(bool weld) { m_weld = weld; return *this; }
+  SceneLoadOptions& set_optimize(bool optimize) { m_optimize = optimize; return *this; }
+  SceneLoadOptions& set_interleaved(bool interleaved) { m_interleaved = interleaved; return *this; }
+  SceneLoadOptions& set_compact(bool compact) { m_compact = compact; return *this; }
+
+private:
+  unsigned int m_threads;
+  bool m_cache;
+  bool m_weld;
+  bool m_optimize;
+  bool m_interleaved;
+  bool m_compact;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,213 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "scene_loader.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem/path.hpp>
+#include <vector>
+
+#include "log.hpp"
+#include "mapped_file.hpp"
+#include "material_parser.hpp"
+#include "scene.hpp"
+#include "scene_node.hpp"
+#include "scene_parser.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+struct Cancelled {};
+
+size_t upload_size(const MeshData& mesh)
+{
+  return
+    mesh.position.size() * sizeof(mesh.position[0]) +
+    mesh.normal.size() * sizeof(mesh.normal[0]) +
+    mesh.texcoord.size() * sizeof(mesh.texcoord[0]) +
+    mesh.index.size() * sizeof(mesh.index[0]) +
+    mesh.bone_weight.size() * sizeof(mesh.bone_weight[0]) +
+    mesh.bone_index.size() * sizeof(mesh.bone_index[0]);
+}
+
+} // namespace
+
+SceneLoader::SceneLoader(const std::string& filename, const SceneLoadOptions& opts) :
+  m_filename(filename),
+  m_options(opts),
+  m_callback(),
+  m_scene(),
+  m_root(nullptr),
+  m_object_count(0),
+  m_finished(false),
+  m_mutex(),
+  m_queue(),
+  m_parsed(false),
+  m_error(),
+  m_cancel(false),
+  m_thread(),
+  m_prefetched(0),
+  m_prefetched_materials()
+{
+  m_thread = std::thread(&SceneLoader::run, this);
+}
+
+SceneLoader::~SceneLoader()
+{
+  m_cancel = true;
+  m_thread.join();
+}
+
+void
+SceneLoader::run()
+{
+  try
+  {
+    auto callback = [this](SceneObject& obj)
+      {
+        if (m_cancel)
+        {
+          throw Cancelled();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(obj));
+      };
+
+    auto prepare = [this](SceneObject& obj)
+      {
+        Scene::prepare_object(obj, m_options);
+      };
+
+    MappedFile file(m_filename);
+    if (m_options.get_threads() == 1 || !SceneParser::is_worth_splitting(file.begin(), file.end()))
+    {
+      SceneParser parser(m_filename, [&](SceneObject& obj){ prepare(obj); callback(obj); });
+      parser.parse(file.begin(), file.end());
+    }
+    else
+    {
+      ThreadPool pool(m_options.get_threads());
+      SceneParser::parse_parallel(m_filename, file.begin(), file.end(), pool, callback, prepare);
+    }
+  }
+  catch(const Cancelled&)
+  {
+    // nobody is waiting for the result anymore
+  }
+  catch(...)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_error = std::current_exception();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_parsed = true;
+}
+
+bool
+SceneLoader::update(SceneNode* parent, size_t byte_budget)
+{
+  if (m_finished)
+  {
+    return true;
+  }
+
+  if (!m_scene)
+  {
+    m_root = parent->create_child();
+    m_scene.reset(new Scene(m_options, m_root));
+    m_scene->set_directory(boost::filesystem::path(m_filename).parent_path());
+  }
+
+  prefetch();
+
+  size_t uploaded = 0;
+  bool parsed = false;
+  do
+  {
+    SceneObject obj;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_queue.empty())
+      {
+        if (m_error)
+        {
+          m_finished = true;
+          std::rethrow_exception(m_error);
+        }
+        parsed = m_parsed;
+        break;
+      }
+
+      obj = std::move(m_queue.front());
+      m_queue.pop_front();
+      if (m_prefetched > 0)
+      {
+        m_prefetched -= 1;
+      }
+    }
+
+    uploaded += upload_size(obj.mesh);
+    m_scene->add_object(obj);
+    m_object_count += 1;
+  }
+  while(uploaded < byte_budget);
+
+  if (parsed)
+  {
+    m_finished = true;
+    m_scene->reconstruct_hierarchy();
+    log_info("%s: %d objects loaded", m_filename, m_object_count);
+    m_scene->log_mesh_stats(m_filename);
+
+    if (m_callback)
+    {
+      m_callback(m_root);
+    }
+  }
+
+  return m_finished;
+}
+
+void
+SceneLoader::prefetch()
+{
+  std::vector<std::string> materials;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(size_t i = m_prefetched; i < m_queue.size(); ++i)
+    {
+      materials.push_back(m_queue[i].material);
+    }
+    m_prefetched = m_queue.size();
+  }
+
+  // the textures of objects further back in the queue decode in
+  // parallel while the ones in front get uploaded
+  for(const auto& material : materials)
+  {
+    if (boost::algorithm::ends_with(material, ".material") &&
+        m_prefetched_materials.insert(material).second)
+    {
+      MaterialParser::prefetch(boost::filesystem::path(m_filename).parent_path() / material);
+    }
+  }
+}
+
+/* EOF */
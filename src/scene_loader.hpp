@@ -0,0 +1,99 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SCENE_LOADER_HPP
+#define HEADER_SCENE_LOADER_HPP
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "scene_load_options.hpp"
+#include "scene_object.hpp"
+
+class Scene;
+class SceneNode;
+
+/** Loads a .mod file in the background: file I/O and parsing run on
+    a thread of their own, while update() uploads the finished objects
+    on the render thread, a few per frame, so the scene shows up
+    progressively without stalling the frame rate. */
+class SceneLoader
+{
+public:
+  typedef std::function<void (SceneNode*)> Callback;
+
+private:
+  std::string m_filename;
+  SceneLoadOptions m_options;
+  Callback m_callback;
+
+  std::unique_ptr<Scene> m_scene;
+  SceneNode* m_root;
+  int m_object_count;
+  bool m_finished;
+
+  std::mutex m_mutex;
+  std::deque<SceneObject> m_queue;
+  bool m_parsed;
+  std::exception_ptr m_error;
+  std::atomic<bool> m_cancel;
+  std::thread m_thread;
+
+  /** objects at the front of m_queue whose textures were already
+      handed to the ImageDecoder, and the material files that were */
+  size_t m_prefetched;
+  std::unordered_set<std::string> m_prefetched_materials;
+
+public:
+  SceneLoader(const std::string& filename, const SceneLoadOptions& opts = SceneLoadOptions());
+
+  /** Stops the background thread, nodes already attached stay where
+      they are */
+  ~SceneLoader();
+
+  /** Called with the root of the scene once all objects are attached */
+  void set_callback(const Callback& callback) { m_callback = callback; }
+
+  /** Upload parsed objects until \a byte_budget bytes of vertex and
+      index data went to the GPU, at least one object is uploaded per
+      call. The objects go below a node that is attached to \a parent
+      on the first call. Errors from the background thread are rethrown
+      here. Returns true once the whole scene is attached. */
+  bool update(SceneNode* parent, size_t byte_budget);
+
+  bool is_finished() const { return m_finished; }
+  int get_object_count() const { return m_object_count; }
+
+private:
+  void run();
+  void prefetch();
+
+private:
+  SceneLoader(const SceneLoader&) = delete;
+  SceneLoader& operator=(const SceneLoader&) = delete;
+};
+
+#endif
+
+/* EOF */
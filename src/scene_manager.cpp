@@ -1,13 +1,50 @@
 #include "scene_manager.hpp"
 
 #include "camera.hpp"
-#include "render_context.hpp"
+#include "frustum.hpp"
+#include "log.hpp"
+
+namespace {
+
+const char* get_pass_name(bool geometry_pass, Stereo stereo)
+{
+  if (geometry_pass)
+  {
+    return "shadow";
+  }
+  else
+  {
+    switch(stereo)
+    {
+      case Stereo::Left:
+        return "left";
+
+      case Stereo::Right:
+        return "right";
+
+      default:
+        return "center";
+    }
+  }
+}
+
+} // namespace
 
 SceneManager::SceneManager() :
   m_world(new SceneNode),
   m_view(new SceneNode),
   m_lights(),
-  m_override_material()
+  m_override_material(),
+  m_shadowmap_matrix(),
+  m_frame_uniforms(FrameUniforms::binding, sizeof(FrameUniforms)),
+  m_object_uniforms(ObjectUniforms::binding, sizeof(ObjectUniforms)),
+  m_queue(),
+  m_cull_stats(),
+  m_transforms(),
+  m_bvh(),
+  // anything but the current version, so the first render() builds
+  m_world_version(SceneNode::get_structure_version() - 1),
+  m_visible()
 {}
 
 SceneManager::~SceneManager()
@@ -37,39 +74,135 @@ SceneManager::create_light()
 void
 SceneManager::render(const Camera& camera, bool geometry_pass, Stereo stereo)
 {
-  m_world->update_transform();
+  // only nodes that moved since the last pass are recomputed, the
+  // second and third pass of a frame usually find nothing to do
+  update_world();
   m_view->update_transform();
 
-  render_node(camera, m_world.get(), geometry_pass, stereo);
-
   Camera id = camera;
   id.set_position(glm::vec3(0.0f, 0.0f, 0.0f));
-  render_node(id, m_view.get(), geometry_pass, stereo);
+
+  // fill the uniform blocks for all objects up front and upload them
+  // in one go, the queue then only has to bind them
+  m_frame_uniforms.clear();
+  m_object_uniforms.clear();
+  m_queue.clear();
+  const Camera* cameras[] = { &camera, &id };
+  for(const Camera* cam : cameras)
+  {
+    FrameUniforms frame;
+    frame.view = cam->get_view_matrix();
+    frame.projection = cam->get_projection_matrix();
+    m_frame_uniforms.push(frame);
+  }
+  CullStats& cull_stats = m_cull_stats[get_pass_name(geometry_pass, stereo)];
+
+  m_visible.clear();
+  m_bvh.query(Frustum(camera.get_matrix()), m_visible);
+  for(SceneNode* node : m_visible)
+  {
+    add_node(RenderQueue::World, camera, node, geometry_pass);
+  }
+  cull_stats.drawn += static_cast<int>(m_visible.size());
+  cull_stats.culled += static_cast<int>(m_bvh.size() - m_visible.size());
+
+  collect(RenderQueue::View, id, Frustum(id.get_matrix()), m_view.get(), geometry_pass, cull_stats);
+  m_frame_uniforms.upload();
+  m_object_uniforms.upload();
+
+  m_queue.submit(m_frame_uniforms, m_object_uniforms, stereo);
 }
 
 void
-SceneManager::render_node(const Camera& camera, SceneNode* node, bool geometry_pass, Stereo stereo)
+SceneManager::update_world()
 {
-  OpenGLState state;
+  if (m_world_version != SceneNode::get_structure_version())
+  {
+    m_transforms.build(*m_world);
+    m_transforms.update();
+    m_bvh.build(m_world.get());
+    m_world_version = SceneNode::get_structure_version();
+  }
+  else if (m_transforms.update())
+  {
+    m_bvh.refit();
+  }
+}
 
-  RenderContext context(camera, node);
-  
-  context.set_stereo(stereo);
+SceneNode*
+SceneManager::pick(const glm::vec3& origin, const glm::vec3& direction) const
+{
+  float distance;
+  return m_bvh.raycast(origin, direction, distance);
+}
 
-  if (geometry_pass)
+void
+SceneManager::collect(RenderQueue::Layer layer, const Camera& camera, const Frustum& frustum,
+                      SceneNode* node, bool geometry_pass, CullStats& cull_stats)
+{
+  if (!node->get_models().empty())
   {
-    context.set_override_material(m_override_material);
+    if (frustum.intersects(node->get_world_bounds()))
+    {
+      add_node(layer, camera, node, geometry_pass);
+      cull_stats.drawn += 1;
+    }
+    else
+    {
+      cull_stats.culled += 1;
+    }
   }
 
-  for(auto& model : node->get_models())
+  for(const auto& child : node->get_children())
   {
-    model->draw(context);
+    collect(layer, camera, frustum, child.get(), geometry_pass, cull_stats);
   }
+}
 
-  for(const auto& child : node->get_children())
+void
+SceneManager::add_node(RenderQueue::Layer layer, const Camera& camera, SceneNode* node, bool geometry_pass)
+{
+  glm::mat4 view = camera.get_view_matrix();
+  glm::mat4 transform = node->get_transform();
+
+  ObjectUniforms object;
+  object.model = transform;
+  object.modelview = view * transform;
+  object.mvp = camera.get_projection_matrix() * object.modelview;
+  object.shadowmap = m_shadowmap_matrix * transform;
+
+  glm::mat3 normal(object.modelview);
+  for(int i = 0; i < 3; ++i)
   {
-    render_node(camera, child.get(), geometry_pass, stereo);
+    object.normal[i] = glm::vec4(normal[i], 0.0f);
   }
+
+  size_t idx = m_object_uniforms.push(object);
+  float depth = -object.modelview[3][2];
+
+  for(const auto& model : node->get_models())
+  {
+    MaterialPtr material = model->get_material();
+    if (!material)
+    {
+      log_error("SceneManager::add_node: no material set");
+    }
+    else if (!geometry_pass)
+    {
+      m_queue.add(layer, camera, node, model.get(), material.get(), idx, depth);
+    }
+    else if (m_override_material && material->cast_shadow())
+    {
+      m_queue.add(layer, camera, node, model.get(), m_override_material.get(), idx, depth);
+    }
+  }
+}
+
+void
+SceneManager::reset_stats()
+{
+  m_queue.reset_stats();
+  m_cull_stats.clear();
 }
 
 void
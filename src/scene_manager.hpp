@@ -1,15 +1,31 @@
 #ifndef HEADER_SCENE_MANAGER_HPP
 #define HEADER_SCENE_MANAGER_HPP
 
+#include <map>
+#include <string>
 #include <vector>
 
+#include "bvh.hpp"
 #include "light.hpp"
 #include "scene_node.hpp"
 #include "opengl_state.hpp"
 #include "material.hpp"
+#include "render_queue.hpp"
 #include "stereo.hpp"
+#include "transform_store.hpp"
+#include "uniform_buffer.hpp"
 
 class Camera;
+class Frustum;
+
+/** Nodes with models that passed and failed the frustum test */
+struct CullStats
+{
+  int drawn;
+  int culled;
+
+  CullStats() : drawn(), culled() {}
+};
 
 class SceneManager
 {
@@ -19,6 +35,28 @@ private:
   std::vector<LightPtr> m_lights;
   MaterialPtr m_override_material;
 
+  glm::mat4 m_shadowmap_matrix;
+
+  /** FrameUniforms of the world and the view camera and the
+      ObjectUniforms of every node with models, refilled by each
+      render() */
+  UniformBuffer m_frame_uniforms;
+  UniformBuffer m_object_uniforms;
+
+  RenderQueue m_queue;
+
+  /** by pass: "shadow", "center", "left" or "right" */
+  std::map<std::string, CullStats> m_cull_stats;
+
+  /** over the world, the view only holds a handful of nodes and
+      keeps the recursive SceneNode::update_transform() */
+  TransformStore m_transforms;
+  BVH m_bvh;
+
+  /** SceneNode::get_structure_version() the two above were built for */
+  unsigned int m_world_version;
+  std::vector<SceneNode*> m_visible;
+
 public:
   SceneManager();
   ~SceneManager();
@@ -29,10 +67,29 @@ public:
   LightPtr create_light();
 
   void render(const Camera& camera, bool geometry_pass = false, Stereo stereo = Stereo::Center);
-  void render_node(const Camera& camera, SceneNode* node, bool geometry_pass, Stereo stereo);
 
   void set_override_material(MaterialPtr material);
 
+  /** World to shadow map texture space, ends up in ShadowMapMatrix
+      multiplied with the model matrix */
+  void set_shadowmap_matrix(const glm::mat4& matrix) { m_shadowmap_matrix = matrix; }
+
+  /** The world node whose bounds are hit first by the ray, as of the
+      last render(), or nullptr */
+  SceneNode* pick(const glm::vec3& origin, const glm::vec3& direction) const;
+
+  /** Draws and state changes of all render() calls since the last
+      reset_stats() */
+  const RenderStats& get_stats() const { return m_queue.get_stats(); }
+  const std::map<std::string, CullStats>& get_cull_stats() const { return m_cull_stats; }
+  void reset_stats();
+
+private:
+  void update_world();
+  void collect(RenderQueue::Layer layer, const Camera& camera, const Frustum& frustum,
+               SceneNode* node, bool geometry_pass, CullStats& cull_stats);
+  void add_node(RenderQueue::Layer layer, const Camera& camera, SceneNode* node, bool geometry_pass);
+
 private:
   SceneManager(const SceneManager&);
   SceneManager& operator=(const SceneManager&);
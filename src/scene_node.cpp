@@ -16,12 +16,22 @@
 
 #include "scene_node.hpp"
 
+#include "transform_store.hpp"
+
+unsigned int SceneNode::s_structure_version = 0;
+
 SceneNode::SceneNode(const std::string& name) :
   m_name(name),
   m_position(0.0f, 0.0f, 0.0f),
   m_orientation(1.0f, 0.0f, 0.0f, 0.0f),
   m_scale(1.0f , 1.0f, 1.0f),
   m_global_transform(1),
+  m_dirty(true),
+  m_child_dirty(false),
+  m_parent(nullptr),
+  m_store(nullptr),
+  m_store_index(-1),
+  m_world_bounds(),
   m_children(),
   m_models()
 {
@@ -35,6 +45,7 @@ void
 SceneNode::set_position(const glm::vec3& p) 
 {
   m_position = p; 
+  transform_changed();
 }
 
 glm::vec3
@@ -47,6 +58,7 @@ void
 SceneNode::set_orientation(const glm::quat& q) 
 {
  m_orientation = q; 
+ transform_changed();
 }
 
 glm::quat
@@ -59,6 +71,7 @@ void
 SceneNode::set_scale(const glm::vec3& s) 
 {
  m_scale = s; 
+ transform_changed();
 }
 
 glm::vec3
@@ -70,34 +83,126 @@ SceneNode::get_scale() const
 glm::mat4
 SceneNode::get_transform() const 
 {
- return m_global_transform; 
+  if (m_store)
+  {
+    return m_store->get_world(m_store_index);
+  }
+  else
+  {
+    return m_global_transform;
+  }
+}
+
+const AABB&
+SceneNode::get_world_bounds() const
+{
+  if (m_store)
+  {
+    return m_store->get_world_bounds(m_store_index);
+  }
+  else
+  {
+    return m_world_bounds;
+  }
+}
+
+void
+SceneNode::bind_store(TransformStore* store, int idx)
+{
+  m_store = store;
+  m_store_index = idx;
+}
+
+void
+SceneNode::transform_changed()
+{
+  if (m_store)
+  {
+    m_store->set_local(m_store_index, m_position, m_orientation, m_scale);
+  }
+  else
+  {
+    mark_dirty();
+  }
 }
 
 void
-SceneNode::update_transform(const glm::mat4& parent_transform)
-{
-  m_global_transform = 
-    parent_transform *
-    glm::translate(m_position) *
-    glm::mat4_cast(m_orientation) *
-    glm::scale(m_scale);
-    
-  for(auto& child : m_children)
+SceneNode::mark_dirty()
+{
+  m_dirty = true;
+
+  // ancestors that are already marked have their ancestors marked too
+  for(SceneNode* node = m_parent; node && !node->m_child_dirty; node = node->m_parent)
+  {
+    node->m_child_dirty = true;
+  }
+}
+
+bool
+SceneNode::update_transform()
+{
+  if (m_parent)
   {
-    child->update_transform(m_global_transform);
+    return update_transform(m_parent->m_global_transform, false);
   }
+  else
+  {
+    return update_transform(glm::mat4(1), false);
+  }
+}
+
+bool
+SceneNode::update_transform(const glm::mat4& parent_transform, bool parent_changed)
+{
+  bool changed = false;
+
+  if (m_dirty || parent_changed)
+  {
+    m_global_transform = 
+      parent_transform *
+      glm::translate(m_position) *
+      glm::mat4_cast(m_orientation) *
+      glm::scale(m_scale);
+
+    AABB bounds;
+    for(const auto& model : m_models)
+    {
+      bounds.extend(model->get_bounds());
+    }
+    m_world_bounds = bounds.transform(m_global_transform);
+
+    m_dirty = false;
+    changed = true;
+  }
+
+  if (changed || m_child_dirty)
+  {
+    const bool recomputed = changed;
+    for(auto& child : m_children)
+    {
+      changed |= child->update_transform(m_global_transform, recomputed);
+    }
+    m_child_dirty = false;
+  }
+
+  return changed;
 }
 
 void
 SceneNode::attach_model(ModelPtr model)
 {
   m_models.push_back(model);
+  mark_dirty();
+  s_structure_version += 1;
 }
 
 void
 SceneNode::attach_child(std::unique_ptr<SceneNode> child)
 {
+  child->m_parent = this;
+  child->mark_dirty();
   m_children.push_back(std::move(child));
+  s_structure_version += 1;
 }
 
 SceneNode*
@@ -24,6 +24,8 @@
 
 #include "model.hpp"
 
+class TransformStore;
+
 class SceneNode
 {
 private:
@@ -34,10 +36,35 @@ private:
 
   glm::mat4 m_global_transform;
 
+  /** the local transform changed since the last update_transform(),
+      so this node and everything below it needs to be recomputed */
+  bool m_dirty;
+
+  /** some node further down the tree is dirty, clean subtrees are
+      skipped entirely */
+  bool m_child_dirty;
+
+  SceneNode* m_parent;
+
+  /** when bound, the global transform and bounds live in the store
+      and the members above are unused */
+  TransformStore* m_store;
+  int m_store_index;
+
+  /** bounds of the models in world space, refreshed by
+      update_transform() */
+  AABB m_world_bounds;
+
   std::vector<std::unique_ptr<SceneNode> > m_children;
   std::vector<ModelPtr> m_models;
 
+  static unsigned int s_structure_version;
+
 public:
+  /** Changes whenever a model or child gets attached to any node, so
+      that structures built over the scene know when to rebuild */
+  static unsigned int get_structure_version() { return s_structure_version; }
+
   SceneNode(const std::string& name = std::string());
   ~SceneNode(); 
 
@@ -51,8 +78,13 @@ public:
   glm::vec3 get_scale() const;
 
   glm::mat4 get_transform() const;
+  const AABB& get_world_bounds() const;
 
-  void update_transform(const glm::mat4& parent_transform = glm::mat4(1));
+  /** Recompute the global transform and bounds of all nodes below
+      this one that changed since the last call, returns true if any
+      node was recomputed. Nodes bound to a TransformStore are updated
+      by TransformStore::update() instead. */
+  bool update_transform();
 
   void attach_model(ModelPtr model);
   void attach_child(std::unique_ptr<SceneNode> child);
@@ -61,6 +93,14 @@ public:
   const std::vector<std::unique_ptr<SceneNode> >& get_children() const { return m_children; }
   const std::vector<ModelPtr>&   get_models() const { return m_models; }
 
+private:
+  friend class TransformStore;
+  void bind_store(TransformStore* store, int idx);
+
+  void transform_changed();
+  void mark_dirty();
+  bool update_transform(const glm::mat4& parent_transform, bool parent_changed);
+
 private:
   SceneNode(const SceneNode&);
   SceneNode& operator=(const SceneNode&);
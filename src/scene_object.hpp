@@ -0,0 +1,54 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SCENE_OBJECT_HPP
+#define HEADER_SCENE_OBJECT_HPP
+
+#include <string>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "mesh_data.hpp"
+
+/** A single 'o' block of a .mod file as it comes out of the parser,
+    before it is turned into a SceneNode */
+struct SceneObject
+{
+  std::string name;
+  std::string parent;
+  std::string material;
+
+  glm::vec3 location;
+  glm::quat rotation;
+  glm::vec3 scale;
+
+  MeshData mesh;
+
+  SceneObject() :
+    name(),
+    parent(),
+    material(),
+    location(0.0f, 0.0f, 0.0f),
+    rotation(1.0f, 0.0f, 0.0f, 0.0f),
+    scale(1.0f, 1.0f, 1.0f),
+    mesh()
+  {}
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,721 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "scene_parser.hpp"
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+#include <ctype.h>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "format.hpp"
+#include "log.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+/** A token is a view into the parsed buffer, it is never copied */
+struct Token
+{
+  const char* begin;
+  const char* end;
+
+  Token() : begin(nullptr), end(nullptr) {}
+
+  bool operator==(const char* str) const
+  {
+    size_t len = strlen(str);
+    return static_cast<size_t>(end - begin) == len && memcmp(begin, str, len) == 0;
+  }
+
+  std::string str() const { return std::string(begin, end); }
+};
+
+const float g_pow10[] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/** Fast path for plain decimals like "-0.287881", which is all the
+    Blender exporter ever writes. Mantissa and power of ten are both
+    exactly representable as float in this range, so a single float
+    multiplication or division rounds correctly and gives the same
+    result as strtof(). Returns false when the slow path is needed. */
+bool parse_float_fast(const char* p, const char* end, float& out)
+{
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+
+  for(; p != end && *p >= '0' && *p <= '9'; ++p)
+  {
+    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+    digits += 1;
+  }
+
+  if (p != end && *p == '.')
+  {
+    ++p;
+    for(; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      digits += 1;
+      exponent -= 1;
+    }
+  }
+
+  if (p != end || digits == 0 || digits > 19)
+  {
+    return false;
+  }
+
+  if (mantissa == 0)
+  {
+    out = negative ? -0.0f : 0.0f;
+    return true;
+  }
+
+  while(exponent < 0 && mantissa % 10 == 0)
+  {
+    mantissa /= 10;
+    exponent += 1;
+  }
+
+  if (mantissa > (1u << 24) || exponent < -10 || exponent > 10)
+  {
+    return false;
+  }
+
+  float f = static_cast<float>(mantissa);
+  if (exponent < 0)
+  {
+    f /= g_pow10[-exponent];
+  }
+  else
+  {
+    f *= g_pow10[exponent];
+  }
+
+  out = negative ? -f : f;
+  return true;
+}
+
+float parse_float(const Token& token)
+{
+  float result;
+  if (parse_float_fast(token.begin, token.end, result))
+  {
+    return result;
+  }
+  else
+  {
+    // slow path for exponents, long mantissas, inf, nan and garbage,
+    // copy to the stack as strtof() needs a terminated string
+    char buf[64];
+    size_t len = static_cast<size_t>(token.end - token.begin);
+    if (len == 0 || len >= sizeof(buf) || isspace(*token.begin))
+    {
+      throw std::runtime_error(format("can't convert '%s' to float", token.str()));
+    }
+    memcpy(buf, token.begin, len);
+    buf[len] = '\0';
+
+    char* endptr;
+    result = strtof(buf, &endptr);
+    if (endptr != buf + len)
+    {
+      throw std::runtime_error(format("can't convert '%s' to float", token.str()));
+    }
+    return result;
+  }
+}
+
+int parse_int(const Token& token)
+{
+  const char* p = token.begin;
+  bool negative = false;
+  if (p != token.end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  if (p == token.end)
+  {
+    throw std::runtime_error(format("can't convert '%s' to int", token.str()));
+  }
+
+  int64_t value = 0;
+  for(; p != token.end; ++p)
+  {
+    if (*p < '0' || *p > '9')
+    {
+      throw std::runtime_error(format("can't convert '%s' to int", token.str()));
+    }
+
+    value = value * 10 + (*p - '0');
+    if (value > static_cast<int64_t>(std::numeric_limits<int>::max()) + 1)
+    {
+      throw std::runtime_error(format("can't convert '%s' to int", token.str()));
+    }
+  }
+
+  value = negative ? -value : value;
+  if (value > std::numeric_limits<int>::max())
+  {
+    throw std::runtime_error(format("can't convert '%s' to int", token.str()));
+  }
+  return static_cast<int>(value);
+}
+
+/** Splits a single line on ' ', same as the boost::char_separator
+    used by SceneParser::parse_istream() */
+class LineScanner
+{
+private:
+  const char* m_p;
+  const char* m_eol;
+  int m_line_number;
+
+public:
+  LineScanner(const char* p, const char* eol, int line_number) :
+    m_p(p),
+    m_eol(eol),
+    m_line_number(line_number)
+  {}
+
+  bool next(Token& token)
+  {
+    while(m_p != m_eol && *m_p == ' ') ++m_p;
+
+    if (m_p == m_eol)
+    {
+      return false;
+    }
+    else
+    {
+      token.begin = m_p;
+      while(m_p != m_eol && *m_p != ' ') ++m_p;
+      token.end = m_p;
+      return true;
+    }
+  }
+
+  Token expect()
+  {
+    Token token;
+    if (!next(token))
+    {
+      throw std::runtime_error((boost::format("not enough tokens at line %d") % m_line_number).str());
+    }
+    return token;
+  }
+
+  float expect_float() { return parse_float(expect()); }
+  int expect_int() { return parse_int(expect()); }
+};
+
+} // namespace
+
+SceneParser::SceneParser(const std::string& filename, const Callback& callback) :
+  m_filename(filename),
+  m_callback(callback),
+  m_object(),
+  m_line_number(0)
+{
+  m_object.material = "phong";
+}
+
+void
+SceneParser::parse_istream(std::istream& in)
+{
+  std::string line;
+  while(std::getline(in, line))
+  {
+    m_line_number += 1;
+
+    boost::tokenizer<boost::char_separator<char> > tokens(line, boost::char_separator<char>(" ", ""));
+    auto it = tokens.begin();
+    if (it != tokens.end())
+    {
+#define INCR_AND_CHECK {                                                \
+        ++it;                                                           \
+        if (it == tokens.end())                                         \
+        {                                                               \
+          throw std::runtime_error((boost::format("not enough tokens at line %d") % m_line_number).str()); \
+        }                                                               \
+      }
+
+      try
+      {
+        if (*it == "o")
+        {
+          // object
+          commit_object();
+
+          INCR_AND_CHECK;
+          log_debug("object: '%s'", *it);
+          m_object.name = *it;
+        }
+        else if (*it == "g")
+        {
+          // group
+        }
+        else if (*it == "parent")
+        {
+          INCR_AND_CHECK;
+          m_object.parent = *it;
+        }
+        else if (*it == "mat")
+        {
+          INCR_AND_CHECK;
+          m_object.material = *it;
+        }
+        else if (*it == "loc")
+        {
+          INCR_AND_CHECK;
+          m_object.location.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.location.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.location.z = boost::lexical_cast<float>(*it);
+        }
+        else if (*it == "rot")
+        {
+          INCR_AND_CHECK;
+          m_object.rotation.w = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.rotation.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.rotation.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.rotation.z = boost::lexical_cast<float>(*it);
+        }
+        else if (*it == "scale")
+        {
+          INCR_AND_CHECK;
+          m_object.scale.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.scale.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          m_object.scale.z = boost::lexical_cast<float>(*it);
+        }
+        else if (*it == "v")
+        {
+          glm::vec3 v;
+
+          INCR_AND_CHECK;
+          v.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          v.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          v.z = boost::lexical_cast<float>(*it);
+
+          m_object.mesh.position.push_back(v);
+        }
+        else if (*it == "vt")
+        {
+          glm::vec3 vt;
+
+          INCR_AND_CHECK;
+          vt.s = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          vt.t = boost::lexical_cast<float>(*it);
+
+          m_object.mesh.texcoord.push_back(vt);
+        }
+        else if (*it == "vn")
+        {
+          glm::vec3 vn;
+
+          INCR_AND_CHECK;
+          vn.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          vn.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          vn.z = boost::lexical_cast<float>(*it);
+
+          m_object.mesh.normal.push_back(vn);
+        }
+        else if (*it == "bw")
+        {
+          glm::vec4 bw;
+
+          INCR_AND_CHECK;
+          bw.x = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          bw.y = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          bw.z = boost::lexical_cast<float>(*it);
+          INCR_AND_CHECK;
+          bw.w = boost::lexical_cast<float>(*it);
+
+          m_object.mesh.bone_weight.push_back(bw);
+        }
+        else if (*it == "bi")
+        {
+          glm::ivec4 bi;
+
+          INCR_AND_CHECK;
+          bi.x = boost::lexical_cast<int>(*it);
+          INCR_AND_CHECK;
+          bi.y = boost::lexical_cast<int>(*it);
+          INCR_AND_CHECK;
+          bi.z = boost::lexical_cast<int>(*it);
+          INCR_AND_CHECK;
+          bi.w = boost::lexical_cast<int>(*it);
+
+          m_object.mesh.bone_index.push_back(bi);
+        }
+        else if (*it == "f")
+        {
+          INCR_AND_CHECK;
+          m_object.mesh.index.push_back(boost::lexical_cast<int>(*it));
+          INCR_AND_CHECK;
+          m_object.mesh.index.push_back(boost::lexical_cast<int>(*it));
+          INCR_AND_CHECK;
+          m_object.mesh.index.push_back(boost::lexical_cast<int>(*it));
+        }
+        else if ((*it)[0] == '#')
+        {
+          // ignore comments
+        }
+        else
+        {
+          throw std::runtime_error((boost::format("unhandled token %s") % *it).str());
+        }
+      }
+      catch(const std::exception& err)
+      {
+        throw std::runtime_error((boost::format("%s:%d: %s") % m_filename % m_line_number % err.what()).str());
+      }
+#undef INCR_AND_CHECK
+    }
+  }
+
+  commit_object();
+}
+
+void
+SceneParser::parse(const char* begin, const char* end)
+{
+  const char* p = begin;
+  while(p != end)
+  {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!eol)
+    {
+      eol = end;
+    }
+
+    m_line_number += 1;
+
+    try
+    {
+      parse_line(p, eol);
+    }
+    catch(const std::exception& err)
+    {
+      throw std::runtime_error((boost::format("%s:%d: %s") % m_filename % m_line_number % err.what()).str());
+    }
+
+    p = (eol == end) ? end : eol + 1;
+  }
+
+  commit_object();
+}
+
+void
+SceneParser::parse(const Chunk& chunk)
+{
+  if (chunk.material_begin)
+  {
+    parse_line(chunk.material_begin, chunk.material_end);
+  }
+
+  m_line_number = chunk.line_number - 1;
+  parse(chunk.begin, chunk.end);
+}
+
+bool
+SceneParser::is_worth_splitting(const char* begin, const char* end)
+{
+  // below this, the parse takes about as long as starting the threads
+  const size_t min_size = 512 * 1024;
+
+  return
+    static_cast<size_t>(end - begin) >= min_size &&
+    split(begin, end, 2).size() >= 2;
+}
+
+std::vector<SceneParser::Chunk>
+SceneParser::split(const char* begin, const char* end, size_t count)
+{
+  std::vector<Chunk> chunks;
+  const size_t target_size = static_cast<size_t>(end - begin) / std::max<size_t>(1, count);
+
+  Chunk chunk;
+  chunk.begin = begin;
+
+  const char* material_begin = nullptr;
+  const char* material_end = nullptr;
+  int line_number = 1;
+
+  const char* p = begin;
+  while(p != end)
+  {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+    if (!eol)
+    {
+      eol = end;
+    }
+
+    const char* s = p;
+    while(s != eol && *s == ' ')
+    {
+      ++s;
+    }
+
+    if (eol - s >= 2 && s[0] == 'o' && s[1] == ' ')
+    {
+      if (static_cast<size_t>(p - chunk.begin) >= target_size)
+      {
+        chunk.end = p;
+        chunks.push_back(chunk);
+
+        chunk.begin = p;
+        chunk.line_number = line_number;
+        chunk.material_begin = material_begin;
+        chunk.material_end = material_end;
+      }
+    }
+    else if (eol - s >= 4 && memcmp(s, "mat ", 4) == 0)
+    {
+      material_begin = p;
+      material_end = eol;
+    }
+
+    line_number += 1;
+    p = (eol == end) ? end : eol + 1;
+  }
+
+  chunk.end = end;
+  chunks.push_back(chunk);
+
+  return chunks;
+}
+
+void
+SceneParser::parse_parallel(const std::string& filename, const char* begin, const char* end,
+                            ThreadPool& pool, const Callback& callback,
+                            const Callback& prepare)
+{
+  // a few chunks per thread, as objects vary a lot in size
+  std::vector<Chunk> chunks = split(begin, end, pool.size() * 4);
+
+  std::vector<std::future<std::vector<SceneObject> > > results;
+  results.reserve(chunks.size());
+  for(const auto& chunk : chunks)
+  {
+    results.push_back(pool.submit([filename, chunk, &prepare]{
+          std::vector<SceneObject> objects;
+          SceneParser parser(filename, [&objects, &prepare](SceneObject& obj){
+              if (prepare)
+              {
+                prepare(obj);
+              }
+              objects.push_back(std::move(obj));
+            });
+          parser.parse(chunk);
+          return objects;
+        }));
+  }
+
+  // hand out the objects as soon as their chunk is done
+  try
+  {
+    for(auto& result : results)
+    {
+      for(auto& obj : result.get())
+      {
+        callback(obj);
+      }
+    }
+  }
+  catch(...)
+  {
+    // the remaining tasks still reference the buffer
+    for(auto& result : results)
+    {
+      if (result.valid())
+      {
+        result.wait();
+      }
+    }
+    throw;
+  }
+}
+
+void
+SceneParser::parse_line(const char* p, const char* eol)
+{
+  LineScanner scanner(p, eol, m_line_number);
+
+  Token token;
+  if (!scanner.next(token))
+  {
+    // empty line
+  }
+  else if (token == "v")
+  {
+    glm::vec3 v;
+    v.x = scanner.expect_float();
+    v.y = scanner.expect_float();
+    v.z = scanner.expect_float();
+    m_object.mesh.position.push_back(v);
+  }
+  else if (token == "vn")
+  {
+    glm::vec3 vn;
+    vn.x = scanner.expect_float();
+    vn.y = scanner.expect_float();
+    vn.z = scanner.expect_float();
+    m_object.mesh.normal.push_back(vn);
+  }
+  else if (token == "vt")
+  {
+    glm::vec3 vt;
+    vt.s = scanner.expect_float();
+    vt.t = scanner.expect_float();
+    m_object.mesh.texcoord.push_back(vt);
+  }
+  else if (token == "f")
+  {
+    int a = scanner.expect_int();
+    int b = scanner.expect_int();
+    int c = scanner.expect_int();
+    m_object.mesh.index.push_back(a);
+    m_object.mesh.index.push_back(b);
+    m_object.mesh.index.push_back(c);
+  }
+  else if (token == "bw")
+  {
+    glm::vec4 bw;
+    bw.x = scanner.expect_float();
+    bw.y = scanner.expect_float();
+    bw.z = scanner.expect_float();
+    bw.w = scanner.expect_float();
+    m_object.mesh.bone_weight.push_back(bw);
+  }
+  else if (token == "bi")
+  {
+    glm::ivec4 bi;
+    bi.x = scanner.expect_int();
+    bi.y = scanner.expect_int();
+    bi.z = scanner.expect_int();
+    bi.w = scanner.expect_int();
+    m_object.mesh.bone_index.push_back(bi);
+  }
+  else if (token == "o")
+  {
+    commit_object();
+
+    m_object.name = scanner.expect().str();
+    log_debug("object: '%s'", m_object.name);
+  }
+  else if (token == "g")
+  {
+    // group
+  }
+  else if (token == "parent")
+  {
+    m_object.parent = scanner.expect().str();
+  }
+  else if (token == "mat")
+  {
+    m_object.material = scanner.expect().str();
+  }
+  else if (token == "loc")
+  {
+    m_object.location.x = scanner.expect_float();
+    m_object.location.y = scanner.expect_float();
+    m_object.location.z = scanner.expect_float();
+  }
+  else if (token == "rot")
+  {
+    m_object.rotation.w = scanner.expect_float();
+    m_object.rotation.x = scanner.expect_float();
+    m_object.rotation.y = scanner.expect_float();
+    m_object.rotation.z = scanner.expect_float();
+  }
+  else if (token == "scale")
+  {
+    m_object.scale.x = scanner.expect_float();
+    m_object.scale.y = scanner.expect_float();
+    m_object.scale.z = scanner.expect_float();
+  }
+  else if (*token.begin == '#')
+  {
+    // ignore comments
+  }
+  else
+  {
+    throw std::runtime_error(format("unhandled token %s", token.str()));
+  }
+}
+
+void
+SceneParser::commit_object()
+{
+  if (!m_object.name.empty())
+  {
+    MeshData& mesh = m_object.mesh;
+
+    // fill in some texcoords if there aren't enough
+    if (!mesh.position.empty() && mesh.texcoord.size() < mesh.position.size())
+    {
+      mesh.texcoord.resize(mesh.position.size(), glm::vec3(0.0f, 0.0f, 0.0f));
+    }
+
+    // the callback is free to move from the object
+    std::string material = m_object.material;
+    m_callback(m_object);
+
+    // clear for the next object, the material carries over
+    m_object.material = material;
+    m_object.name.clear();
+    m_object.parent.clear();
+    m_object.location = glm::vec3(0.0f, 0.0f, 0.0f);
+    m_object.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    m_object.scale = glm::vec3(1.0f, 1.0f, 1.0f);
+    m_object.mesh.clear();
+  }
+}
+
+/* EOF */
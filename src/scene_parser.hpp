@@ -0,0 +1,112 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SCENE_PARSER_HPP
+#define HEADER_SCENE_PARSER_HPP
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "scene_object.hpp"
+
+class ThreadPool;
+
+/** Turns the text of a .mod file into SceneObjects, one callback per
+    'o' block. This is not a fully featured .obj file reader, it just
+    takes some inspiration from it:
+    http://www.martinreddy.net/gfx/3d/OBJ.spec
+
+    No OpenGL calls are made, so this can be used from any thread. The
+    callback may move from the object it is given. */
+class SceneParser
+{
+public:
+  typedef std::function<void (SceneObject&)> Callback;
+
+  /** A range of lines that starts at an 'o' line or the start of the
+      file and can be parsed independently of the rest of the file */
+  struct Chunk
+  {
+    const char* begin;
+    const char* end;
+    int line_number;
+
+    /** last 'mat' line before the chunk, as the material carries over
+        from the previous object, nullptr when there is none */
+    const char* material_begin;
+    const char* material_end;
+
+    Chunk() :
+      begin(nullptr), end(nullptr), line_number(1),
+      material_begin(nullptr), material_end(nullptr)
+    {}
+
+    Chunk(const Chunk&) = default;
+    Chunk& operator=(const Chunk&) = default;
+  };
+
+  /** Split the given memory range at 'o' lines into at most \a count
+      chunks of roughly equal size */
+  static std::vector<Chunk> split(const char* begin, const char* end, size_t count);
+
+  /** Whether parse_parallel() can beat a serial parse() on the given
+      memory range, false for small files and files with a single
+      object, where setting up the ThreadPool costs more than it
+      saves */
+  static bool is_worth_splitting(const char* begin, const char* end);
+
+  /** Parse the chunks of the given memory range on \a pool, the
+      callback is called from the calling thread in file order, while
+      \a prepare, if given, runs on the worker threads for every object
+      before it is handed back */
+  static void parse_parallel(const std::string& filename, const char* begin, const char* end,
+                             ThreadPool& pool, const Callback& callback,
+                             const Callback& prepare = Callback());
+
+private:
+  std::string m_filename;
+  Callback m_callback;
+  SceneObject m_object;
+  int m_line_number;
+
+public:
+  SceneParser(const std::string& filename, const Callback& callback);
+
+  /** Parse line by line with boost::tokenizer */
+  void parse_istream(std::istream& in);
+
+  /** Parse the given memory range in place, no per-line or per-token
+      allocations are done, this is the fast path used for mmap()'ed
+      files */
+  void parse(const char* begin, const char* end);
+
+  /** Parse a single chunk as returned by split() */
+  void parse(const Chunk& chunk);
+
+private:
+  void parse_line(const char* p, const char* eol);
+  void commit_object();
+
+private:
+  SceneParser(const SceneParser&) = delete;
+  SceneParser& operator=(const SceneParser&) = delete;
+};
+
+#endif
+
+/* EOF */
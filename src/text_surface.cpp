@@ -22,6 +22,7 @@
 #include "assert_gl.hpp"
 #include "material_factory.hpp"
 #include "opengl_state.hpp"
+#include "pixel_kernels.hpp"
 
 std::shared_ptr<TextSurface>
 TextSurface::create(const std::string& text, const TextProperties& text_props)
@@ -98,6 +99,11 @@ TextSurface::draw(RenderContext& ctx, float x, float y, float z)
   assert(texcoords_loc != -1);
   assert(positions_loc != -1);
 
+  // client side arrays, which must not end up in the VAO of the last
+  // Mesh drawn
+  OpenGLState::bind_vertex_array(0);
+  OpenGLState::bind_buffer(GL_ARRAY_BUFFER, 0);
+
   glVertexAttribPointer(texcoords_loc, 2, GL_FLOAT, GL_FALSE, 0, texcoord.data());
   glVertexAttribPointer(positions_loc, 3, GL_FLOAT, GL_FALSE, 0, position.data());
 
@@ -120,34 +126,17 @@ TextSurface::create_opengl_texture(Cairo::RefPtr<Cairo::ImageSurface> surface)
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->get_width());
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture->get_id());
+  OpenGLState::active_texture(GL_TEXTURE0);
+  OpenGLState::bind_texture(GL_TEXTURE_2D, texture->get_id());
   assert_gl("Texture failure");
 
-  // flip RGBA to BGRA
+  // remove the pre-multiplied alpha and flip BGRA to RGBA
+  const PixelKernels& kernels = PixelKernels::get();
   for(int y = 0; y < surface->get_height(); ++y)
   {
     uint8_t* pixels = surface->get_data() + surface->get_stride() * y;
-
-    for(int x = 0; x < surface->get_width()*4; x += 4)
-    {
-      uint8_t r = pixels[x+0];
-      uint8_t g = pixels[x+1];
-      uint8_t b = pixels[x+2];
-      uint8_t a = pixels[x+3];
-
-      // removing pre-multiplayed alpha
-      if (a != 0)
-      {
-        pixels[x+0] = static_cast<uint8_t>(b * 255 / a);
-        pixels[x+1] = static_cast<uint8_t>(g * 255 / a);
-        pixels[x+2] = static_cast<uint8_t>(r * 255 / a);
-      }
-
-      // debug foobar
-      //if (pixels[x+3] == 0)
-      //  pixels[x+3] = 32;
-    }
+    kernels.unpremultiply(pixels, pixels, surface->get_width());
+    kernels.swap_rb_rgba(pixels, pixels, surface->get_width());
   }
 
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
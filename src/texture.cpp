@@ -1,7 +1,5 @@
 #include "texture.hpp"
 
-#include <SDL.h>
-#include <SDL_image.h>
 #include <assert.h>
 #include <math.h>
 #include <stdexcept>
@@ -9,37 +7,48 @@
 #include <vector>
 
 #include "assert_gl.hpp"
+#include "image_decoder.hpp"
+#include "mipmap_builder.hpp"
 #include "opengl_state.hpp"
 
 namespace {
 
-void flip_rgb(SDL_Surface* surface)
+GLenum get_format(const Image& image)
 {
-  for(int y = 0; y < surface->h; ++y)
-    for(int x = 0; x < surface->w; ++x)
-    {
-      uint8_t* p = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch + x * surface->format->BytesPerPixel;
-      std::swap(p[0], p[2]);
-    }
+  return image.get_bytes_per_pixel() == 4 ? GL_RGBA : GL_RGB;
 }
 
-void vflip_surface(SDL_Surface* surface)
+/** Upload \a image and the levels below it into storage allocated
+    with glTexStorage2D(), \a target is the 2D target or a cube map
+    face */
+void upload_levels(GLenum target, const Image& image, const std::vector<ImagePtr>& mipmaps)
 {
-  size_t len = surface->w * surface->format->BytesPerPixel;
-  std::vector<uint8_t> tmp_vec(len);
-  for(int y = 0; y < surface->h/2; ++y)
+  glTexSubImage2D(target, 0, 0, 0, image.get_width(), image.get_height(),
+                  get_format(image), GL_UNSIGNED_BYTE, image.get_data());
+
+  int level = 1;
+  for(const auto& mipmap : mipmaps)
   {
-    uint8_t* src = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
-    uint8_t* dst = static_cast<uint8_t*>(surface->pixels) + (surface->h - y - 1) * surface->pitch;
-    uint8_t* tmp = tmp_vec.data();
-    memcpy(tmp, src, len);
-    memcpy(src, dst, len);
-    memcpy(dst, tmp, len);
+    glTexSubImage2D(target, level, 0, 0, mipmap->get_width(), mipmap->get_height(),
+                    get_format(*mipmap), GL_UNSIGNED_BYTE, mipmap->get_data());
+    level += 1;
   }
 }
 
-} // namespace
+/** The mipmaps the ImageDecoder built, or new ones when it didn't */
+std::vector<ImagePtr> get_mipmaps(const Image& image)
+{
+  if (image.get_mipmaps().empty())
+  {
+    return MipmapBuilder().build(image);
+  }
+  else
+  {
+    return image.get_mipmaps();
+  }
+}
 
+} // namespace
 
 TexturePtr
 Texture::create_empty(GLenum target, GLenum format, int width, int height)
@@ -49,7 +58,7 @@ Texture::create_empty(GLenum target, GLenum format, int width, int height)
   assert_gl("framebuffer");
   GLuint texture;
   glGenTextures(1, &texture);
-  glBindTexture(target, texture);
+  OpenGLState::bind_texture(target, texture);
   glTexImage2D(target, 0, format,  width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
   glTexParameterf(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameterf(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -69,7 +78,7 @@ Texture::create_shadowmap(int width, int height)
 
   assert_gl("Texture::create_shadowmap: start");
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  OpenGLState::bind_texture(GL_TEXTURE_2D, texture);
   
   glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,  width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, NULL);
 
@@ -102,19 +111,21 @@ Texture::create_random_noise(int width, int height)
   GLuint texture;
 
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  OpenGLState::bind_texture(GL_TEXTURE_2D, texture);
    
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
-
-  std::vector<uint8_t> data(width*height*3);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
-  for(size_t i = 0; i < sizeof(data); i+=3)
+  Image image(width, height, 3);
+  uint8_t* data = image.get_data();
+  for(size_t i = 0; i < image.get_size(); i+=3)
   {
     data[i+0] = data[i+1] = data[i+2] = rand() % 255;
   }
 
-  gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height, GL_RGB, GL_UNSIGNED_BYTE, data.data());
+  glTexStorage2D(GL_TEXTURE_2D, MipmapBuilder::get_level_count(width, height), GL_RGB8, width, height);
+  // noise is not a color, so filter it linearly
+  upload_levels(GL_TEXTURE_2D, image, MipmapBuilder(MipmapFilter::Box, false).build(image));
   assert_gl("texture0()");
     
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -140,13 +151,14 @@ Texture::create_lightspot(int width, int height)
   GLuint texture;
 
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  OpenGLState::bind_texture(GL_TEXTURE_2D, texture);
 
-  const int pitch = width * 3;
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
-  std::vector<uint8_t> data(width*height*3);
+  Image image(width, height, 3);
+  const int pitch = image.get_pitch();
+  uint8_t* data = image.get_data();
   for(int y = 0; y < height; ++y)
     for(int x = 0; x < width; ++x)
     {
@@ -160,7 +172,9 @@ Texture::create_lightspot(int width, int height)
       data[y * pitch + 3*x+2] = static_cast<uint8_t>(std::max(0.0f, std::min(f * 255.0f, 255.0f)));
     }
 
-  gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, width, height, GL_RGB, GL_UNSIGNED_BYTE, data.data());
+  glTexStorage2D(GL_TEXTURE_2D, MipmapBuilder::get_level_count(width, height), GL_RGB8, width, height);
+  // a light mask, not a color
+  upload_levels(GL_TEXTURE_2D, image, MipmapBuilder(MipmapFilter::Box, false).build(image));
   assert_gl("texture0()");
     
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -173,49 +187,33 @@ Texture::create_lightspot(int width, int height)
   return TexturePtr(new Texture(GL_TEXTURE_2D, texture));
 }
 
-namespace {
-SDL_Surface* surface_from_file(const std::string& filename)
+TexturePtr
+Texture::cubemap_from_file(const std::string& filename)
 {
-  SDL_Surface* surface = IMG_Load(filename.c_str());
-  if (!surface)
+  // all six faces decode in parallel
+  const char* names[] = { "up.png", "dn.png", "lf.png", "rt.png", "ft.png", "bk.png" };
+  std::shared_future<ImagePtr> faces[6];
+  for(int i = 0; i < 6; ++i)
   {
-    throw std::runtime_error("couldn't load " + filename);
+    faces[i] = ImageDecoder::get().request(filename + names[i], ImageDecoder::SwapRB | ImageDecoder::Mipmaps);
   }
-  else
+
+  ImagePtr images[6];
+  for(int i = 0; i < 6; ++i)
   {
-    return surface;
+    images[i] = faces[i].get();
   }
+
+  return cubemap_from_images(images[0], images[1], images[2], images[3], images[4], images[5]);
 }
-} // namespace
 
 TexturePtr
-Texture::cubemap_from_file(const std::string& filename)
+Texture::cubemap_from_images(ImagePtr up, ImagePtr dn, ImagePtr lf, ImagePtr rt, ImagePtr ft, ImagePtr bk)
 {
   OpenGLState state;
 
-  SDL_Surface* up = surface_from_file(filename + "up.png");
-  SDL_Surface* dn = surface_from_file(filename + "dn.png");
-  SDL_Surface* ft = surface_from_file(filename + "ft.png");
-  SDL_Surface* bk = surface_from_file(filename + "bk.png");
-  SDL_Surface* lf = surface_from_file(filename + "lf.png");
-  SDL_Surface* rt = surface_from_file(filename + "rt.png");
-
-  assert(up);
-  assert(dn);
-  assert(ft);
-  assert(bk);
-  assert(lf);
-  assert(rt);
-
-  flip_rgb(up);
-  flip_rgb(dn);
-  flip_rgb(ft);
-  flip_rgb(bk);
-  flip_rgb(lf);
-  flip_rgb(rt);
-
-  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, up->pitch / up->format->BytesPerPixel);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
   //glActiveTexture(GL_TEXTURE0);
   //glEnable(GL_TEXTURE_CUBE_MAP);
@@ -223,86 +221,96 @@ Texture::cubemap_from_file(const std::string& filename)
   GLuint texture;
   GLenum target = GL_TEXTURE_CUBE_MAP;
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+  OpenGLState::bind_texture(GL_TEXTURE_CUBE_MAP, texture);
 
   glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
   glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-   
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, GL_RGB, up->w, up->h, up->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, up->pixels);
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, GL_RGB, dn->w, dn->h, dn->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, dn->pixels);
-
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_RGB, lf->w, lf->h, lf->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, lf->pixels);
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_POSITIVE_X, GL_RGB, rt->w, rt->h, rt->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, rt->pixels);
-
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, GL_RGB, ft->w, ft->h, ft->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, ft->pixels);
-  gluBuild2DMipmaps(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_RGB, bk->w, bk->h, bk->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, bk->pixels);
-
-  glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
-  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 10);
-  glGenerateMipmap(target);
 
-  SDL_FreeSurface(up);
-  SDL_FreeSurface(dn);
-  SDL_FreeSurface(ft);
-  SDL_FreeSurface(bk);
-  SDL_FreeSurface(lf);
-  SDL_FreeSurface(rt);
+  const std::pair<GLenum, Image*> faces[] = {
+    std::make_pair(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, up.get()),
+    std::make_pair(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, dn.get()),
+    std::make_pair(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, lf.get()),
+    std::make_pair(GL_TEXTURE_CUBE_MAP_POSITIVE_X, rt.get()),
+    std::make_pair(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, ft.get()),
+    std::make_pair(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, bk.get())
+  };
+
+  // faces of a cube map all have the same size
+  glTexStorage2D(target, MipmapBuilder::get_level_count(up->get_width(), up->get_height()),
+                 GL_RGB8, up->get_width(), up->get_height());
+
+  size_t decoded_bytes = 0;
+  for(const auto& face : faces)
+  {
+    const Image& image = *face.second;
+    upload_levels(face.first, image, get_mipmaps(image));
+    decoded_bytes += image.get_size();
+  }
 
   assert_gl("cube texture");
 
-  return TexturePtr(new Texture(target, texture));
+  TexturePtr result(new Texture(target, texture));
+  result->m_decoded_bytes = decoded_bytes;
+  return result;
 }
 
 TexturePtr
 Texture::from_file(const std::string& filename, bool build_mipmaps)
 {
-  OpenGLState state;
+  return from_image(*ImageDecoder::get().decode(filename, get_decoder_flags(build_mipmaps)), build_mipmaps);
+}
 
-  SDL_Surface* surface = IMG_Load(filename.c_str());
-  if (!surface)
-  {
-    throw std::runtime_error("Texture: couldn't open " + filename);
-  }
-  else
-  {
-    vflip_surface(surface);
+void
+Texture::prefetch(const std::string& filename, bool build_mipmaps)
+{
+  ImageDecoder::get().prefetch(filename, get_decoder_flags(build_mipmaps));
+}
 
-    GLenum target = GL_TEXTURE_2D;
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(target, texture);
+int
+Texture::get_decoder_flags(bool build_mipmaps)
+{
+  return ImageDecoder::FlipVertical | (build_mipmaps ? ImageDecoder::Mipmaps : ImageDecoder::None);
+}
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / surface->format->BytesPerPixel);  
+TexturePtr
+Texture::from_image(const Image& image, bool build_mipmaps)
+{
+  OpenGLState state;
 
-    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, build_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  GLenum target = GL_TEXTURE_2D;
+  GLuint texture;
+  glGenTextures(1, &texture);
+  OpenGLState::bind_texture(target, texture);
 
-    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  // Image rows are tightly packed
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
-    if (build_mipmaps)
-    {
-      gluBuild2DMipmaps(target, GL_RGB, surface->w, surface->h,
-                        surface->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB,
-                        GL_UNSIGNED_BYTE, surface->pixels);
-    }
-    else
-    {
-      glTexImage2D(target, 0, GL_RGB, surface->w, surface->h, 0,
-                   surface->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB,
-                   GL_UNSIGNED_BYTE, surface->pixels);
-    }
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, build_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 
-    SDL_FreeSurface(surface);
+  glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    return TexturePtr(new Texture(target, texture));
+  if (build_mipmaps)
+  {
+    glTexStorage2D(target, MipmapBuilder::get_level_count(image.get_width(), image.get_height()),
+                   GL_RGB8, image.get_width(), image.get_height());
+    upload_levels(target, image, get_mipmaps(image));
+  }
+  else
+  {
+    glTexStorage2D(target, 1, GL_RGB8, image.get_width(), image.get_height());
+    upload_levels(target, image, std::vector<ImagePtr>());
   }
-}
 
+  TexturePtr result(new Texture(target, texture));
+  result->m_decoded_bytes = image.get_size();
+  return result;
+}
 
 TexturePtr
 Texture::from_rgb_data(int width, int height, int pitch, void* data)
@@ -312,7 +320,7 @@ Texture::from_rgb_data(int width, int height, int pitch, void* data)
   GLenum target = GL_TEXTURE_2D;
   GLuint texture;
   glGenTextures(1, &texture);
-  glBindTexture(target, texture);
+  OpenGLState::bind_texture(target, texture);
 
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
@@ -337,13 +345,14 @@ Texture::create_handle(GLenum target)
 
 Texture::Texture(GLenum target, GLuint id) :
   m_target(target),
-  m_id(id)
+  m_id(id),
+  m_decoded_bytes(0)
 {
 }
 
 Texture::~Texture()
 {
-  glDeleteTextures(1, &m_id);
+  OpenGLState::delete_textures(1, &m_id);
 }
 
 void
@@ -354,7 +363,7 @@ Texture::upload(int width, int height, int pitch, void* data)
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
 
-  glBindTexture(m_target, m_id);
+  OpenGLState::bind_texture(m_target, m_id);
   glTexSubImage2D(m_target, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
   assert_gl("Texture::upload");
 }
@@ -5,6 +5,8 @@
 #include <string>
 #include <GL/glew.h>
 
+#include "image.hpp"
+
 class Texture;
 
 typedef std::shared_ptr<Texture> TexturePtr;
@@ -15,9 +17,26 @@ private:
   GLenum m_target;
   GLuint m_id;
 
+  /** size of the pixel data decoded from image files, 0 for textures
+      that weren't loaded from files */
+  size_t m_decoded_bytes;
+
 public:
+  /** Decodes the six faces on the ImageDecoder */
   static TexturePtr cubemap_from_file(const std::string& filename);
+  static TexturePtr cubemap_from_images(ImagePtr up, ImagePtr dn, ImagePtr lf,
+                                        ImagePtr rt, ImagePtr ft, ImagePtr bk);
+
+  /** Decodes on the ImageDecoder, picking up a prefetched image */
   static TexturePtr from_file(const std::string& filename, bool build_mipmaps = true);
+
+  /** Start decoding \a filename, and building its mipmaps, for a
+      later from_file() with the same arguments */
+  static void prefetch(const std::string& filename, bool build_mipmaps = true);
+
+  /** Uses the mipmaps of \a image when it has them, builds them
+      otherwise, uploads with glTexStorage2D() */
+  static TexturePtr from_image(const Image& image, bool build_mipmaps = true);
   static TexturePtr from_rgb_data(int width, int height, int pitch, void* data);
   static TexturePtr create_lightspot(int width, int height);
   static TexturePtr create_random_noise(int width, int height);
@@ -31,9 +50,13 @@ public:
 
   GLuint get_id() const { return m_id; }
   GLenum get_target() const { return m_target; }
+  size_t get_decoded_bytes() const { return m_decoded_bytes; }
 
   void upload(int width, int height, int pitch, void* data);
 
+private:
+  static int get_decoder_flags(bool build_mipmaps);
+
 private:
   Texture(const Texture&);
   Texture& operator=(const Texture&);
@@ -0,0 +1,159 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "texture_cache.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include "log.hpp"
+
+namespace {
+
+std::string canonical_path(const std::string& filename)
+{
+  boost::system::error_code ec;
+  boost::filesystem::path path = boost::filesystem::canonical(filename, ec);
+  if (ec)
+  {
+    // let the loader report the error
+    return filename;
+  }
+  else
+  {
+    return path.string();
+  }
+}
+
+std::string make_key(const std::string& filename, bool build_mipmaps)
+{
+  return (build_mipmaps ? "2d-mipmap:" : "2d:") + canonical_path(filename);
+}
+
+} // namespace
+
+TextureCache::TextureCache() :
+  m_textures(),
+  m_evict_callbacks(),
+  m_stats()
+{
+}
+
+TexturePtr
+TextureCache::from_file(const std::string& filename, bool build_mipmaps)
+{
+  std::string key = make_key(filename, build_mipmaps);
+  return lookup(key, [&]{ return Texture::from_file(filename, build_mipmaps); });
+}
+
+void
+TextureCache::prefetch(const std::string& filename, bool build_mipmaps)
+{
+  std::string key = make_key(filename, build_mipmaps);
+  if (m_textures.find(key) == m_textures.end())
+  {
+    Texture::prefetch(filename, build_mipmaps);
+  }
+}
+
+TexturePtr
+TextureCache::cubemap_from_file(const std::string& filename)
+{
+  // the filename is a prefix for the six faces, so the key has to
+  // keep a trailing slash
+  std::string key = "cube:" + canonical_path(filename);
+  if (!filename.empty() && filename.back() == '/')
+  {
+    key += '/';
+  }
+  return lookup(key, [&]{ return Texture::cubemap_from_file(filename); });
+}
+
+TexturePtr
+TextureCache::lookup(const std::string& key, const std::function<TexturePtr ()>& load)
+{
+  auto it = m_textures.find(key);
+  if (it != m_textures.end())
+  {
+    m_stats.hits += 1;
+    m_stats.bytes_saved += it->second->get_decoded_bytes();
+    return it->second;
+  }
+  else
+  {
+    TexturePtr texture = load();
+    m_stats.misses += 1;
+    m_stats.bytes_decoded += texture->get_decoded_bytes();
+    m_textures[key] = texture;
+    return texture;
+  }
+}
+
+void
+TextureCache::add_evict_callback(const EvictCallback& callback)
+{
+  m_evict_callbacks.push_back(callback);
+}
+
+int
+TextureCache::evict_unused()
+{
+  int count = 0;
+  for(auto it = m_textures.begin(); it != m_textures.end();)
+  {
+    if (it->second.use_count() == 1)
+    {
+      evict(it->first, it->second);
+      it = m_textures.erase(it);
+      count += 1;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return count;
+}
+
+void
+TextureCache::clear()
+{
+  for(const auto& entry : m_textures)
+  {
+    evict(entry.first, entry.second);
+  }
+  m_textures.clear();
+}
+
+void
+TextureCache::evict(const std::string& key, const TexturePtr& texture)
+{
+  m_stats.evictions += 1;
+  for(const auto& callback : m_evict_callbacks)
+  {
+    callback(key, texture);
+  }
+}
+
+void
+TextureCache::print_stats() const
+{
+  log_info("TextureCache: %d textures, %d hits, %d misses, %d evictions, %d bytes decoded, %d bytes saved",
+           m_textures.size(), m_stats.hits, m_stats.misses, m_stats.evictions,
+           m_stats.bytes_decoded, m_stats.bytes_saved);
+}
+
+/* EOF */
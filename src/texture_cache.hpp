@@ -0,0 +1,117 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_TEXTURE_CACHE_HPP
+#define HEADER_TEXTURE_CACHE_HPP
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "texture.hpp"
+
+/** Shares textures loaded from image files, so that every file is
+    decoded and uploaded only once no matter how many materials use
+    it. Entries are keyed by the canonical path and the load
+    parameters and hold a strong reference, textures stay around until
+    evict_unused() or clear() drops them. Must only be used from the
+    thread owning the GL context. */
+class TextureCache
+{
+public:
+  struct Stats
+  {
+    int hits;
+    int misses;
+    int evictions;
+
+    /** pixel data decoded for misses */
+    size_t bytes_decoded;
+
+    /** pixel data that didn't have to be decoded and uploaded again */
+    size_t bytes_saved;
+
+    Stats() :
+      hits(),
+      misses(),
+      evictions(),
+      bytes_decoded(),
+      bytes_saved()
+    {}
+  };
+
+  /** Called with the cache key and the texture for every entry that
+      gets dropped from the cache */
+  typedef std::function<void (const std::string&, const TexturePtr&)> EvictCallback;
+
+private:
+  std::unordered_map<std::string, TexturePtr> m_textures;
+  std::vector<EvictCallback> m_evict_callbacks;
+  Stats m_stats;
+
+public:
+  TextureCache();
+
+  /** Cached Texture::from_file() */
+  TexturePtr from_file(const std::string& filename, bool build_mipmaps = true);
+
+  /** Start decoding \a filename on the ImageDecoder unless the
+      texture is already in the cache, a later from_file() picks up the
+      result */
+  void prefetch(const std::string& filename, bool build_mipmaps = true);
+
+  /** Cached Texture::cubemap_from_file() */
+  TexturePtr cubemap_from_file(const std::string& filename);
+
+  void add_evict_callback(const EvictCallback& callback);
+
+  /** Drop all textures that are referenced by nothing but the cache,
+      returns the number of textures dropped */
+  int evict_unused();
+
+  /** Drop all entries, textures still in use stay alive with their
+      users */
+  void clear();
+
+  size_t size() const { return m_textures.size(); }
+
+  const Stats& get_stats() const { return m_stats; }
+  void print_stats() const;
+
+  static TextureCache& get()
+  {
+    static TextureCache* instance = 0;
+    if (!instance)
+    {
+      instance = new TextureCache;
+    }
+    return *instance;
+  }
+
+private:
+  TexturePtr lookup(const std::string& key, const std::function<TexturePtr ()>& load);
+  void evict(const std::string& key, const TexturePtr& texture);
+
+private:
+  TextureCache(const TextureCache&);
+  TextureCache& operator=(const TextureCache&);
+};
+
+#endif
+
+/* EOF */
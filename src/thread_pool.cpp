@@ -0,0 +1,85 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int count) :
+  m_threads(),
+  m_queue(),
+  m_mutex(),
+  m_cond(),
+  m_quit(false)
+{
+  if (count == 0)
+  {
+    count = hardware_concurrency();
+  }
+
+  for(unsigned int i = 0; i < count; ++i)
+  {
+    m_threads.emplace_back(&ThreadPool::run, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_cond.notify_all();
+
+  for(auto& thread : m_threads)
+  {
+    thread.join();
+  }
+}
+
+unsigned int
+ThreadPool::hardware_concurrency()
+{
+  // may return 0 when the number of cores isn't known
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void
+ThreadPool::run()
+{
+  while(true)
+  {
+    std::function<void ()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this]{ return m_quit || !m_queue.empty(); });
+
+      if (m_queue.empty())
+      {
+        return;
+      }
+
+      task = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    task();
+  }
+}
+
+/* EOF */
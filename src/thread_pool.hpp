@@ -0,0 +1,80 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_THREAD_POOL_HPP
+#define HEADER_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/** Fixed number of worker threads processing a shared queue of tasks,
+    results and exceptions are handed back via std::future */
+class ThreadPool
+{
+private:
+  std::vector<std::thread> m_threads;
+  std::deque<std::function<void ()> > m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  bool m_quit;
+
+public:
+  /** Creates \a count worker threads, 0 means one per core */
+  ThreadPool(unsigned int count = 0);
+
+  /** Finishes all queued tasks, then joins the workers */
+  ~ThreadPool();
+
+  size_t size() const { return m_threads.size(); }
+
+  template<typename F>
+  std::future<typename std::result_of<F()>::type> submit(F func)
+  {
+    typedef typename std::result_of<F()>::type Result;
+
+    auto task = std::make_shared<std::packaged_task<Result ()> >(std::move(func));
+    std::future<Result> future = task->get_future();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_queue.push_back([task]{ (*task)(); });
+    }
+    m_cond.notify_one();
+
+    return future;
+  }
+
+  static unsigned int hardware_concurrency();
+
+private:
+  void run();
+
+private:
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,244 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "transform_store.hpp"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "scene_node.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+/** levels smaller than this are not worth handing to other threads */
+const size_t s_min_chunk_size = 4096;
+
+} // namespace
+
+TransformStore::TransformStore() :
+  m_parent(),
+  m_position(),
+  m_orientation(),
+  m_scale(),
+  m_local_bounds(),
+  m_world(),
+  m_world_bounds(),
+  m_dirty(),
+  m_levels(),
+  m_changed(false)
+{
+}
+
+TransformStore::~TransformStore()
+{
+}
+
+void
+TransformStore::clear()
+{
+  m_parent.clear();
+  m_position.clear();
+  m_orientation.clear();
+  m_scale.clear();
+  m_local_bounds.clear();
+  m_world.clear();
+  m_world_bounds.clear();
+  m_dirty.clear();
+  m_levels.clear();
+  m_changed = false;
+}
+
+void
+TransformStore::build(SceneNode& root)
+{
+  clear();
+
+  // breadth-first, the queue doubles as the list of visited nodes
+  std::vector<std::pair<SceneNode*, int> > queue;
+  queue.push_back(std::make_pair(&root, -1));
+  for(size_t i = 0; i < queue.size(); ++i)
+  {
+    SceneNode* node = queue[i].first;
+
+    AABB bounds;
+    for(const auto& model : node->get_models())
+    {
+      bounds.extend(model->get_bounds());
+    }
+
+    int idx = add(queue[i].second, node->get_position(), node->get_orientation(), node->get_scale(), bounds);
+    node->bind_store(this, idx);
+
+    for(const auto& child : node->get_children())
+    {
+      queue.push_back(std::make_pair(child.get(), idx));
+    }
+  }
+}
+
+int
+TransformStore::add(int parent, const glm::vec3& position, const glm::quat& orientation,
+                    const glm::vec3& scale, const AABB& bounds)
+{
+  size_t idx = m_parent.size();
+  size_t depth = 0;
+  if (parent >= 0)
+  {
+    if (static_cast<size_t>(parent) >= idx)
+    {
+      throw std::runtime_error("TransformStore: parent has to be added before its children");
+    }
+    depth = static_cast<size_t>(std::upper_bound(m_levels.begin(), m_levels.end(),
+                                                 static_cast<size_t>(parent)) - m_levels.begin());
+  }
+
+  if (depth == m_levels.size())
+  {
+    m_levels.push_back(idx);
+  }
+  else if (depth + 1 != m_levels.size())
+  {
+    throw std::runtime_error("TransformStore: entries have to be added in breadth-first order");
+  }
+
+  m_parent.push_back(parent);
+  m_position.push_back(position);
+  m_orientation.push_back(orientation);
+  m_scale.push_back(scale);
+  m_local_bounds.push_back(bounds);
+  m_world.push_back(glm::mat4(1));
+  m_world_bounds.push_back(AABB());
+  m_dirty.push_back(1);
+  m_changed = true;
+
+  return static_cast<int>(idx);
+}
+
+void
+TransformStore::set_local(int idx, const glm::vec3& position, const glm::quat& orientation,
+                          const glm::vec3& scale)
+{
+  m_position[idx] = position;
+  m_orientation[idx] = orientation;
+  m_scale[idx] = scale;
+  m_dirty[idx] = 1;
+  m_changed = true;
+}
+
+bool
+TransformStore::update()
+{
+  if (!m_changed)
+  {
+    return false;
+  }
+  else
+  {
+    update_range(0, m_parent.size());
+    finish_update();
+    return true;
+  }
+}
+
+bool
+TransformStore::update(ThreadPool& pool)
+{
+  if (!m_changed)
+  {
+    return false;
+  }
+  else
+  {
+    std::vector<std::future<void> > results;
+    for(size_t level = 0; level < m_levels.size(); ++level)
+    {
+      size_t begin = m_levels[level];
+      size_t end = (level + 1 < m_levels.size()) ? m_levels[level + 1] : m_parent.size();
+
+      size_t chunks = std::min(pool.size(), (end - begin) / s_min_chunk_size);
+      if (chunks < 2)
+      {
+        update_range(begin, end);
+      }
+      else
+      {
+        // the next level reads the results of this one, so wait for
+        // all chunks before moving on
+        size_t chunk_size = (end - begin + chunks - 1) / chunks;
+        results.clear();
+        for(size_t i = begin; i < end; i += chunk_size)
+        {
+          size_t chunk_end = std::min(i + chunk_size, end);
+          results.push_back(pool.submit([this, i, chunk_end]{ update_range(i, chunk_end); }));
+        }
+        for(auto& result : results)
+        {
+          result.get();
+        }
+      }
+    }
+    finish_update();
+    return true;
+  }
+}
+
+void
+TransformStore::update_range(size_t begin, size_t end)
+{
+  for(size_t i = begin; i < end; ++i)
+  {
+    const int parent = m_parent[i];
+    if (parent >= 0 && m_dirty[parent])
+    {
+      m_dirty[i] = 1;
+    }
+
+    if (m_dirty[i])
+    {
+      // translate(p) * mat4_cast(q) * scale(s) without the two full
+      // matrix multiplications
+      glm::mat4 local = glm::mat4_cast(m_orientation[i]);
+      local[0] *= m_scale[i].x;
+      local[1] *= m_scale[i].y;
+      local[2] *= m_scale[i].z;
+      local[3] = glm::vec4(m_position[i], 1.0f);
+
+      if (parent >= 0)
+      {
+        m_world[i] = m_world[parent] * local;
+      }
+      else
+      {
+        m_world[i] = local;
+      }
+      m_world_bounds[i] = m_local_bounds[i].transform(m_world[i]);
+    }
+  }
+}
+
+void
+TransformStore::finish_update()
+{
+  // children look at the flag of their parent, so it can only be
+  // cleared once every level is done
+  std::fill(m_dirty.begin(), m_dirty.end(), 0);
+  m_changed = false;
+}
+
+/* EOF */
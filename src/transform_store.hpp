@@ -0,0 +1,110 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_TRANSFORM_STORE_HPP
+#define HEADER_TRANSFORM_STORE_HPP
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+#include <vector>
+
+#include "aabb.hpp"
+
+class SceneNode;
+class ThreadPool;
+
+/** Transforms of a whole scene graph in flat arrays, one entry per
+    node in breadth-first order, so that every parent comes before its
+    children. update() computes the global transforms in a single
+    linear pass over the arrays instead of recursing through the
+    nodes, and as every depth level only depends on the previous one,
+    the levels can be split up over a ThreadPool.
+
+    SceneNodes bound to a store by build() forward their local
+    transform to it and take their global transform and bounds from
+    it. */
+class TransformStore
+{
+private:
+  /** index of the parent, always smaller than the own index, -1 for
+      roots */
+  std::vector<int> m_parent;
+
+  std::vector<glm::vec3> m_position;
+  std::vector<glm::quat> m_orientation;
+  std::vector<glm::vec3> m_scale;
+  std::vector<AABB> m_local_bounds;
+
+  std::vector<glm::mat4> m_world;
+  std::vector<AABB> m_world_bounds;
+
+  /** char instead of bool, as std::vector<bool> packs bits and
+      threads write to neighbouring entries */
+  std::vector<char> m_dirty;
+
+  /** first index of every depth level */
+  std::vector<size_t> m_levels;
+
+  /** any entry is dirty */
+  bool m_changed;
+
+public:
+  TransformStore();
+  ~TransformStore();
+
+  void clear();
+
+  /** Replace the content of the store with the tree below and
+      including \a root and bind all its nodes to the store */
+  void build(SceneNode& root);
+
+  /** Append an entry below \a parent, or a root when \a parent is -1,
+      entries have to be added in breadth-first order, returns the
+      index of the new entry */
+  int add(int parent, const glm::vec3& position, const glm::quat& orientation,
+          const glm::vec3& scale, const AABB& bounds);
+
+  void set_local(int idx, const glm::vec3& position, const glm::quat& orientation,
+                 const glm::vec3& scale);
+
+  /** Recompute the global transforms of all dirty entries and their
+      descendants, returns true if anything was recomputed */
+  bool update();
+
+  /** Same as update(), but levels large enough are split into chunks
+      that run on \a pool */
+  bool update(ThreadPool& pool);
+
+  const glm::mat4& get_world(int idx) const { return m_world[idx]; }
+  const AABB& get_world_bounds(int idx) const { return m_world_bounds[idx]; }
+
+  size_t size() const { return m_parent.size(); }
+  size_t get_depth() const { return m_levels.size(); }
+
+private:
+  void update_range(size_t begin, size_t end);
+  void finish_update();
+
+private:
+  TransformStore(const TransformStore&) = delete;
+  TransformStore& operator=(const TransformStore&) = delete;
+};
+
+#endif
+
+/* EOF */
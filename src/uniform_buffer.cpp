@@ -0,0 +1,104 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "uniform_buffer.hpp"
+
+#include "assert_gl.hpp"
+#include "opengl_state.hpp"
+
+namespace {
+
+size_t get_stride(size_t block_size)
+{
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  if (alignment <= 0)
+  {
+    return block_size;
+  }
+  else
+  {
+    return (block_size + alignment - 1) / alignment * alignment;
+  }
+}
+
+} // namespace
+
+UniformBuffer::UniformBuffer(GLuint binding, size_t block_size) :
+  m_binding(binding),
+  m_block_size(block_size),
+  m_stride(get_stride(block_size)),
+  m_buffer(0),
+  m_capacity(0),
+  m_segment(0),
+  m_staging()
+{
+}
+
+UniformBuffer::~UniformBuffer()
+{
+  OpenGLState::delete_buffers(1, &m_buffer);
+}
+
+void
+UniformBuffer::clear()
+{
+  m_staging.clear();
+}
+
+void
+UniformBuffer::upload()
+{
+  if (m_staging.empty())
+  {
+    return;
+  }
+
+  if (size() > m_capacity)
+  {
+    // grow with some headroom, the old storage is orphaned and stays
+    // alive until the GPU is done with it
+    m_capacity = size() * 3 / 2 + 16;
+    m_segment = 0;
+
+    if (!m_buffer)
+    {
+      glGenBuffers(1, &m_buffer);
+    }
+    OpenGLState::bind_buffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, s_segments * m_capacity * m_stride, nullptr, GL_STREAM_DRAW);
+  }
+  else
+  {
+    m_segment = (m_segment + 1) % s_segments;
+    OpenGLState::bind_buffer(GL_UNIFORM_BUFFER, m_buffer);
+  }
+
+  glBufferSubData(GL_UNIFORM_BUFFER, m_segment * m_capacity * m_stride, m_staging.size(), m_staging.data());
+  OpenGLState::bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+  assert_gl("UniformBuffer::upload");
+}
+
+void
+UniformBuffer::bind(size_t idx) const
+{
+  OpenGLState::bind_buffer_range(GL_UNIFORM_BUFFER, m_binding, m_buffer,
+                                 (m_segment * m_capacity + idx) * m_stride, m_block_size);
+}
+
+/* EOF */
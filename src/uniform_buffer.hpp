@@ -0,0 +1,115 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_UNIFORM_BUFFER_HPP
+#define HEADER_UNIFORM_BUFFER_HPP
+
+#include <GL/glew.h>
+#include <string.h>
+#include <vector>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+/** std140 layout of the FrameBlock uniform block of the shaders */
+struct FrameUniforms
+{
+  static const GLuint binding = 0;
+
+  glm::mat4 view;
+  glm::mat4 projection;
+
+  FrameUniforms() : view(), projection() {}
+};
+
+/** std140 layout of the ObjectBlock uniform block of the shaders */
+struct ObjectUniforms
+{
+  static const GLuint binding = 1;
+
+  glm::mat4 model;
+  glm::mat4 modelview;
+  glm::mat4 mvp;
+  glm::mat4 shadowmap;
+
+  /** a mat3 is stored as three vec4 columns in std140 */
+  glm::vec4 normal[3];
+
+  ObjectUniforms() : model(), modelview(), mvp(), shadowmap(), normal() {}
+};
+
+/** A ring of uniform blocks of type T in a single buffer object. The
+    blocks of a render pass are collected with push() and go to the
+    GPU with one upload(), each upload() writes the next segment of
+    the ring. SceneManager::render() uploads once per pass, so the
+    ring has room for s_passes passes (shadow map and two eyes, plus
+    one spare) of s_frames frames, a segment is only rewritten once
+    the GPU is s_frames frames past it and the driver doesn't have to
+    wait. More passes per frame still work, but may stall. */
+class UniformBuffer
+{
+private:
+  static const int s_frames = 3;
+  static const int s_passes = 4;
+  static const int s_segments = s_frames * s_passes;
+
+  GLuint m_binding;
+  size_t m_block_size;
+
+  /** m_block_size rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT */
+  size_t m_stride;
+
+  GLuint m_buffer;
+
+  /** blocks per segment */
+  size_t m_capacity;
+  int m_segment;
+
+  std::vector<char> m_staging;
+
+public:
+  UniformBuffer(GLuint binding, size_t block_size);
+  ~UniformBuffer();
+
+  /** Drop all blocks, to be called at the start of a pass */
+  void clear();
+
+  /** Add a block and return its index for bind() */
+  template<typename T>
+  size_t push(const T& block)
+  {
+    size_t idx = size();
+    m_staging.resize(m_staging.size() + m_stride);
+    memcpy(&m_staging[idx * m_stride], &block, sizeof(T));
+    return idx;
+  }
+
+  size_t size() const { return m_staging.size() / m_stride; }
+
+  /** Copy all blocks pushed since clear() to the GPU */
+  void upload();
+
+  /** Bind the block \a idx to the uniform block binding point */
+  void bind(size_t idx) const;
+
+private:
+  UniformBuffer(const UniformBuffer&) = delete;
+  UniformBuffer& operator=(const UniformBuffer&) = delete;
+};
+
+#endif
+
+/* EOF */
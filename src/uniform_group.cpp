@@ -26,27 +26,27 @@ Uniform<UniformSymbol>::apply(ProgramPtr prog, const RenderContext& ctx)
   switch(m_value)
   {
     case UniformSymbol::NormalMatrix:
-      prog->set_uniform(m_name, glm::mat3(ctx.get_view_matrix() * ctx.get_model_matrix()));
+      set(*prog, glm::mat3(ctx.get_view_matrix() * ctx.get_model_matrix()));
       break;
 
     case UniformSymbol::ViewMatrix:
-      prog->set_uniform(m_name, ctx.get_view_matrix());
+      set(*prog, ctx.get_view_matrix());
       break;
       
     case UniformSymbol::ModelMatrix:
-      prog->set_uniform(m_name, ctx.get_model_matrix());
+      set(*prog, ctx.get_model_matrix());
       break;
       
     case UniformSymbol::ModelViewMatrix:
-      prog->set_uniform(m_name, ctx.get_view_matrix() * ctx.get_model_matrix());
+      set(*prog, ctx.get_view_matrix() * ctx.get_model_matrix());
       break;
 
     case UniformSymbol::ProjectionMatrix:
-      prog->set_uniform(m_name, ctx.get_projection_matrix());
+      set(*prog, ctx.get_projection_matrix());
       break;
 
     case UniformSymbol::ModelViewProjectionMatrix:
-      prog->set_uniform(m_name, ctx.get_projection_matrix() * ctx.get_view_matrix() * ctx.get_model_matrix());
+      set(*prog, ctx.get_projection_matrix() * ctx.get_view_matrix() * ctx.get_model_matrix());
       break;
       
     default:
@@ -71,26 +71,62 @@ UniformGroup::apply(ProgramPtr prog, const RenderContext& ctx)
     uniform->apply(prog, ctx);
   }
 
-  apply_subroutines(prog, GL_VERTEX_SHADER, m_vertex_subroutine_uniforms);
-  apply_subroutines(prog, GL_FRAGMENT_SHADER, m_fragment_subroutine_uniforms);
+  // subroutine selections are not part of the program object and get
+  // reset by glUseProgram(), so they have to be uploaded every time
+  const SubroutineTable& table = get_subroutine_table(*prog);
+  if (!table.vertex.empty())
+  {
+    glUniformSubroutinesuiv(GL_VERTEX_SHADER, table.vertex.size(), table.vertex.data());
+  }
+  if (!table.fragment.empty())
+  {
+    glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, table.fragment.size(), table.fragment.data());
+  }
   assert_gl("apply:exit");
 }
 
-void
-UniformGroup::apply_subroutines(ProgramPtr prog, GLenum shadertype, 
-                                const std::unordered_map<std::string, std::string>& subroutines)
+const UniformGroup::SubroutineTable&
+UniformGroup::get_subroutine_table(const Program& prog)
+{
+  if (m_subroutine_tables_generation != OpenGLState::get_program_generation())
+  {
+    m_subroutine_tables.clear();
+    m_subroutine_tables_generation = OpenGLState::get_program_generation();
+  }
+
+  for(const auto& table : m_subroutine_tables)
+  {
+    if (table.program == prog.get_id())
+    {
+      return table;
+    }
+  }
+
+  SubroutineTable table(prog.get_id());
+  table.vertex = build_subroutine_table(prog.get_id(), GL_VERTEX_SHADER, m_vertex_subroutine_uniforms);
+  table.fragment = build_subroutine_table(prog.get_id(), GL_FRAGMENT_SHADER, m_fragment_subroutine_uniforms);
+  m_subroutine_tables.push_back(std::move(table));
+  return m_subroutine_tables.back();
+}
+
+std::vector<GLuint>
+UniformGroup::build_subroutine_table(GLuint program, GLenum shadertype,
+                                     const std::unordered_map<std::string, std::string>& subroutines)
 {
-  assert_gl("apply_subroutines:enter");
+  assert_gl("build_subroutine_table:enter");
   GLint num_uniform_locations;
-  glGetProgramStageiv(prog->get_id(), shadertype, GL_ACTIVE_SUBROUTINE_UNIFORM_LOCATIONS, &num_uniform_locations);
-  
-  std::vector<GLuint> subroutine_mappings;
-  for(int i = 0; i < num_uniform_locations; ++i)
+  glGetProgramStageiv(program, shadertype, GL_ACTIVE_SUBROUTINE_UNIFORM_LOCATIONS, &num_uniform_locations);
+
+  GLint num_uniforms;
+  glGetProgramStageiv(program, shadertype, GL_ACTIVE_SUBROUTINE_UNIFORMS, &num_uniforms);
+
+  std::vector<GLuint> subroutine_mappings(num_uniform_locations, 0);
+  for(int i = 0; i < num_uniforms; ++i)
   {
     char name[256];
     GLsizei length;
-    glGetActiveSubroutineUniformName(prog->get_id(), shadertype, i, sizeof(name), &length, name);
-    
+    glGetActiveSubroutineUniformName(program, shadertype, i, sizeof(name), &length, name);
+
     const auto& it = subroutines.find(name);
     if (it == subroutines.end())
     {
@@ -98,21 +134,21 @@ UniformGroup::apply_subroutines(ProgramPtr prog, GLenum shadertype,
     }
     else
     {
-      GLuint loc = glGetSubroutineIndex(prog->get_id(), shadertype, it->second.c_str());
-      if (loc == GL_INVALID_INDEX)
+      GLint loc = glGetSubroutineUniformLocation(program, shadertype, name);
+      GLuint idx = glGetSubroutineIndex(program, shadertype, it->second.c_str());
+      if (idx == GL_INVALID_INDEX)
       {
         log_error("unknown subroutine: %s", it->second);
       }
-      else
+      else if (0 <= loc && loc < num_uniform_locations)
       {
-        subroutine_mappings.emplace_back(loc);  
+        subroutine_mappings[loc] = idx;
       }
     }
   }
 
-  glUniformSubroutinesuiv(shadertype, subroutine_mappings.size(), subroutine_mappings.data());
-
-  assert_gl("apply_subroutines:exit");
+  assert_gl("build_subroutine_table:exit");
+  return subroutine_mappings;
 }
 
 /* EOF */
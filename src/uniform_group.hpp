@@ -27,6 +27,7 @@
 #include <unordered_map>
 #include <tuple>
 
+#include "opengl_state.hpp"
 #include "program.hpp"
 
 class RenderContext;
@@ -46,14 +47,61 @@ class UniformBase
 protected:
   std::string m_name;
 
+private:
+  /** location of m_name per program id, a material usually sees only
+      one or two programs (its own and the shadow pass override) */
+  std::vector<std::pair<GLuint, GLint> > m_locations;
+
+  /** OpenGLState::get_program_generation() when m_locations was
+      filled, program ids may have been reused since it changed */
+  unsigned int m_locations_generation;
+
 public:
   UniformBase(const std::string& name) :
-    m_name(name)
+    m_name(name),
+    m_locations(),
+    m_locations_generation(OpenGLState::get_program_generation())
   {}
   virtual ~UniformBase() {}
 
   std::string get_name() const { return m_name; }
   virtual void apply(ProgramPtr prog, const RenderContext& ctx) = 0;
+
+protected:
+  /** Look up the location of m_name for a value of type T once per
+      program, type mismatches are reported on the first lookup and
+      result in -1 */
+  template<typename T>
+  GLint get_location(const Program& prog)
+  {
+    if (m_locations_generation != OpenGLState::get_program_generation())
+    {
+      m_locations.clear();
+      m_locations_generation = OpenGLState::get_program_generation();
+    }
+
+    for(const auto& it : m_locations)
+    {
+      if (it.first == prog.get_id())
+      {
+        return it.second;
+      }
+    }
+
+    GLint loc = prog.resolve_uniform<T>(m_name);
+    m_locations.emplace_back(prog.get_id(), loc);
+    return loc;
+  }
+
+  template<typename T>
+  void set(Program& prog, const T& value)
+  {
+    GLint loc = get_location<T>(prog);
+    if (loc != -1)
+    {
+      prog.set_uniform(loc, value);
+    }
+  }
 };
 
 template<typename T>
@@ -70,7 +118,7 @@ public:
 
   void apply(ProgramPtr prog, const RenderContext& ctx)
   {
-    prog->set_uniform(m_name, m_value);
+    set(*prog, m_value);
   }
 };
 
@@ -108,16 +156,39 @@ public:
 
 class UniformGroup
 {
+private:
+  /** subroutine indices of a program, ordered by subroutine uniform
+      location, ready for glUniformSubroutinesuiv() */
+  struct SubroutineTable
+  {
+    GLuint program;
+    std::vector<GLuint> vertex;
+    std::vector<GLuint> fragment;
+
+    SubroutineTable(GLuint program_) :
+      program(program_),
+      vertex(),
+      fragment()
+    {}
+  };
+
 private:
   std::vector<std::unique_ptr<UniformBase> > m_uniforms;
   std::unordered_map<std::string, std::string> m_vertex_subroutine_uniforms;
   std::unordered_map<std::string, std::string> m_fragment_subroutine_uniforms;
 
+  /** one table per program this group was applied to, cleared by
+      set_subroutine_uniform() and when a program got deleted */
+  std::vector<SubroutineTable> m_subroutine_tables;
+  unsigned int m_subroutine_tables_generation;
+
 public:
   UniformGroup() :
     m_uniforms(),
     m_vertex_subroutine_uniforms(),
-    m_fragment_subroutine_uniforms()
+    m_fragment_subroutine_uniforms(),
+    m_subroutine_tables(),
+    m_subroutine_tables_generation(OpenGLState::get_program_generation())
   {}
 
   template<typename T>
@@ -142,10 +213,16 @@ public:
     {
       assert(!"not implemented");
     }
+
+    m_subroutine_tables.clear();
   }
 
   void apply(ProgramPtr prog, const RenderContext& ctx);
-  void apply_subroutines(ProgramPtr prog, GLenum shadertype, const std::unordered_map<std::string, std::string>& subroutines);
+
+private:
+  const SubroutineTable& get_subroutine_table(const Program& prog);
+  static std::vector<GLuint> build_subroutine_table(GLuint program, GLenum shadertype,
+                                                    const std::unordered_map<std::string, std::string>& subroutines);
 
 private:
   UniformGroup(const UniformGroup&);
@@ -16,8 +16,6 @@
 
 #version 420 core
 
-uniform mat4 MVP;
-
 in vec2 frag_uv;
 
 uniform float offset;
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "log.hpp"
+#include "pixel_kernels.hpp"
 
 VideoProcessor::VideoProcessor(const std::string& filename) :
   m_mainloop(Glib::MainLoop::create()),
@@ -290,12 +291,7 @@ VideoProcessor::update()
         int istride = m_buffer->get_size() / height;
         for(int y = 0; y < height; ++y)
         {
-          for(int x = 0; x < width; ++x)
-          {
-            op[y*ostride + 4*x+0] = ip[y*istride + 4*x+2];
-            op[y*ostride + 4*x+1] = ip[y*istride + 4*x+1];
-            op[y*ostride + 4*x+2] = ip[y*istride + 4*x+0];
-          }
+          PixelKernels::get().swap_rb_rgba(ip + y*istride, op + y*ostride, width);
         }
       }
       
@@ -17,6 +17,7 @@
 #include <GL/glew.h>
 #include <SDL.h>
 #include <SDL_image.h>
+#include <boost/algorithm/string/predicate.hpp>
 #include <cmath>
 #include <cmath>
 //#include <cwiid.h>
@@ -35,7 +36,9 @@
 #include "armature.hpp"
 #include "assert_gl.hpp"
 #include "camera.hpp"
+#include "compositor.hpp"
 #include "framebuffer.hpp"
+#include "image_decoder.hpp"
 #include "renderbuffer.hpp"
 #include "log.hpp"
 #include "material_factory.hpp"
@@ -46,10 +49,13 @@
 #include "pose.hpp"
 #include "program.hpp"
 #include "render_context.hpp"
+#include "resource_cache.hpp"
 #include "scene.hpp"
+#include "scene_loader.hpp"
 #include "scene_manager.hpp"
 #include "shader.hpp"
 #include "text_surface.hpp"
+#include "texture_cache.hpp"
 #include "video_processor.hpp"
 #include "wiimote_manager.hpp"
 
@@ -92,6 +98,10 @@ struct Options
   std::string video = std::string();
   bool video3d = false;
   std::string model = std::string();
+  unsigned int threads = 0;
+  bool weld = false;
+  bool optimize = false;
+  bool compact = false;
 };
 
 // global variables
@@ -111,6 +121,9 @@ bool g_show_calibration = false;
 
 std::unique_ptr<Menu> g_menu;
 std::unique_ptr<SceneManager> g_scene_manager;
+std::unique_ptr<SceneLoader> g_scene_loader;
+// bytes of vertex data uploaded per frame while a scene is loading
+const size_t g_scene_upload_budget = 4 * 1024 * 1024;
 std::unique_ptr<Camera> g_camera;
 
 MaterialPtr g_video_material;
@@ -199,7 +212,7 @@ glm::vec2 g_wiimote_dot2;
 //glm::vec2 g_wiimote_scale(0.84f, 0.64f);
 glm::vec2 g_wiimote_scale(0.52f, 0.47f);
 
-ProgramPtr m_composition_prog;
+std::unique_ptr<Compositor> g_compositor;
 
 SceneNode* g_wiimote_accel_node = 0;
 SceneNode* g_wiimote_gyro_node = 0;
@@ -241,6 +254,11 @@ void reshape(int w, int h)
   g_renderbuffer1.reset(new Renderbuffer(g_screen_w, g_screen_h));
   g_renderbuffer2.reset(new Renderbuffer(g_screen_w, g_screen_h));
 
+  if (g_compositor)
+  {
+    g_compositor->resize(g_screen_w, g_screen_h);
+  }
+
   g_aspect_ratio = static_cast<GLfloat>(g_screen_w)/static_cast<GLfloat>(g_screen_h);
 
   assert_gl("reshape");
@@ -257,6 +275,7 @@ void draw_scene(Stereo stereo)
   glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
   g_camera->perspective(g_fov, g_aspect_ratio, g_near_z, g_far_z);
+  g_camera->set_viewport_height(g_screen_h);
 
   glm::vec3 look_at = g_look_at;
   glm::vec3 up = g_up;
@@ -314,6 +333,7 @@ void draw_shadowmap()
 
   Camera camera;
   camera.perspective(g_shadowmap_fov, 1.0f, g_near_z, g_far_z);
+  camera.set_viewport_height(g_shadowmap->get_height());
   //camera.ortho(-25.0f, 25.0f, -25.0f, 25.0f, g_near_z, g_far_z);
   
   camera.look_at(light_pos, look_at, up);
@@ -324,6 +344,7 @@ void draw_shadowmap()
                                   0.5, 0.5, 0.5, 1.0);
 
   g_shadowmap_matrix = g_shadowmap_matrix * camera.get_matrix();
+  g_scene_manager->set_shadowmap_matrix(g_shadowmap_matrix);
 
   g_scene_manager->render(camera, true);
 }
@@ -375,77 +396,57 @@ void display()
   {
     OpenGLState state;
 
-    MaterialPtr material = std::make_shared<Material>();
-    { // setup material
-      material->set_program(m_composition_prog);
+    g_compositor->set_barrel_power(g_barrel_power);
 
-      material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
+    TexturePtr left_eye = g_framebuffer1->get_color_texture();
+    TexturePtr right_eye = g_framebuffer2->get_color_texture();
+    if (g_show_calibration)
+    {
+      left_eye = g_calibration_left_texture;
+      right_eye = g_calibration_right_texture;
+    }
 
-      material->set_uniform("barrel_power", g_barrel_power);
-      material->set_uniform("left_eye",  0);
-      material->set_uniform("right_eye", 1);
+    switch(g_stereo_mode)
+    {
+      case StereoMode::Cybermaxx:
+        g_compositor->set_mode("interlaced");
+        break;
 
-      if (!g_show_calibration)
-      {
-        material->set_texture(0, g_framebuffer1->get_color_texture());
-        material->set_texture(1, g_framebuffer2->get_color_texture());
-      }
-      else
-      {
-        material->set_texture(0, g_calibration_left_texture);
-        material->set_texture(1, g_calibration_right_texture);
-      }
+      case StereoMode::CrossEye:
+        g_compositor->set_mode("crosseye");
+        break;
 
-      switch(g_stereo_mode)
-      {
-        case StereoMode::Cybermaxx:
-          material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "interlaced");
-          break;
-                
-        case StereoMode::CrossEye:
-          material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "crosseye");
-          break;
-                
-        case StereoMode::Anaglyph:
-          material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "anaglyph");
-          break;
-
-        case StereoMode::Depth:
-          material->set_texture(0, g_framebuffer1->get_depth_texture());
-          material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "depth");
-          break;
-
-        default:
-          material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "mono");
-          break;
-      }
-    } // setup material
+      case StereoMode::Anaglyph:
+        g_compositor->set_mode("anaglyph");
+        break;
 
-    ModelPtr model = std::make_shared<Model>();
-    model->add_mesh(Mesh::create_rect(0.0f, 0.0f, g_screen_w, g_screen_h, -20.0f));
-    model->set_material(material);
-            
-    Camera camera;
-    camera.ortho(0, g_screen_w, g_screen_h, 0.0f, 0.1f, 10000.0f);
-            
-    SceneManager mgr;
-    mgr.get_world()->attach_model(model);
+      case StereoMode::Depth:
+        left_eye = g_framebuffer1->get_depth_texture();
+        g_compositor->set_mode("depth");
+        break;
+
+      default:
+        g_compositor->set_mode("mono");
+        break;
+    }
+
+    g_compositor->set_textures(left_eye, right_eye);
 
     glViewport(g_viewport_offset.x, g_viewport_offset.y, g_screen_w, g_screen_h);
         
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-    mgr.render(camera);
+    g_compositor->draw();
     
     // render menu overlay
     if (true)
     {
       glClear(GL_DEPTH_BUFFER_BIT);
-      RenderContext ctx(camera, mgr.get_world());
+      RenderContext ctx(g_compositor->get_camera(), g_compositor->get_node());
 
       if (false && g_show_menu)
       {
-        glDisable(GL_BLEND);
+        OpenGLState::disable(GL_BLEND);
         //g_shadowmap->draw_depth(g_screen_w - 266, 10, 256, 256, -20.0f);
         g_shadowmap->draw(g_screen_w - 266 - 276, 10, 256, 256, -20.0f);
       } 
@@ -534,7 +535,7 @@ void keyboard(SDL_KeyboardEvent key, int x, int y)
         clip_plane[2] = (rand() / double(RAND_MAX) - 0.5) * 2.0f;
         clip_plane[3] = (rand() / double(RAND_MAX) - 0.5) * 2.0f;
 
-        glEnable(GL_CLIP_PLANE0);
+        OpenGLState::enable(GL_CLIP_PLANE0);
         glClipPlane(GL_CLIP_PLANE0, clip_plane);
       }
       break;
@@ -543,7 +544,7 @@ void keyboard(SDL_KeyboardEvent key, int x, int y)
       {
         GLdouble clip_plane[] = { 0.0, 1.0, 1.0, 0.0 };
         glClipPlane(GL_CLIP_PLANE0, clip_plane);
-        glEnable(GL_CLIP_PLANE0);
+        OpenGLState::enable(GL_CLIP_PLANE0);
       }
       break;
 
@@ -708,9 +709,7 @@ void init()
   //g_armature = Armature::from_file("/tmp/blender.bones");
   //g_pose = Pose::from_file("/tmp/blender.pose");
 
-  //m_composition_prog = Program::create(Shader::from_file(GL_FRAGMENT_SHADER, "src/newsprint.frag"));
-  m_composition_prog = Program::create(Shader::from_file(GL_FRAGMENT_SHADER, "src/composite.frag"),
-                                       Shader::from_file(GL_VERTEX_SHADER, "src/composite.vert"));
+  g_compositor.reset(new Compositor(g_screen_w, g_screen_h));
 
   {
     g_scene_manager.reset(new SceneManager);
@@ -720,7 +719,6 @@ void init()
       material->cull_face(GL_FRONT);
       material->enable(GL_CULL_FACE);
       material->enable(GL_DEPTH_TEST);
-      material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
       material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/shadowmap.vert"),
                                             Shader::from_file(GL_FRAGMENT_SHADER, "src/shadowmap.frag")));
       g_scene_manager->set_override_material(material);
@@ -815,9 +813,8 @@ void init()
         node->attach_model(model);
       }
 
-      auto mesh = Mesh::create_sphere(0.2, 8, 16);
       ModelPtr model = std::make_shared<Model>();
-      model->add_mesh(std::move(mesh));
+      model->set_lod(0.2f, [](int segments){ return MeshPtr(Mesh::create_sphere(0.2f, segments / 2, segments)); });
       model->set_material(phong_material);
 
       auto origin = g_scene_manager->get_world()->create_child();
@@ -851,7 +848,7 @@ void init()
         auto child = parent->create_child();
         child->set_position(glm::vec3(1.0f, 0.0f, -3.0f));
         ModelPtr model = std::make_shared<Model>();
-        model->add_mesh(Mesh::create_sphere(0.5f, 16, 8));
+        model->set_lod(0.5f, [](int segments){ return MeshPtr(Mesh::create_sphere(0.5f, segments / 2, segments)); });
         model->set_material(phong_material);
         child->attach_model(model);
 
@@ -863,9 +860,30 @@ void init()
 
     if (!g_model_filename.empty())
     { // load a mesh from file
-      auto node = Scene::from_file(g_model_filename);
-      print_scene_graph(node.get());
-      g_scene_manager->get_world()->attach_child(std::move(node));
+      SceneLoadOptions opts;
+      opts.set_threads(g_opts.threads);
+      opts.set_weld(g_opts.weld);
+      opts.set_optimize(g_opts.optimize);
+      opts.set_compact(g_opts.compact);
+
+      if (boost::algorithm::ends_with(g_model_filename, ".modb"))
+      {
+        auto node = Scene::from_binary_file(g_model_filename, opts);
+        print_scene_graph(node.get());
+        ResourceCache::get().print_stats();
+        TextureCache::get().print_stats();
+        g_scene_manager->get_world()->attach_child(std::move(node));
+      }
+      else
+      {
+        // uploaded bit by bit in main_loop()
+        g_scene_loader.reset(new SceneLoader(g_model_filename, opts));
+        g_scene_loader->set_callback([](SceneNode* node){
+            print_scene_graph(node);
+            ResourceCache::get().print_stats();
+            TextureCache::get().print_stats();
+          });
+      }
     }
 
     if (false)
@@ -912,8 +930,6 @@ void init()
       material->enable(GL_PROGRAM_POINT_SIZE);
       material->set_texture(0, Texture::create_lightspot(256, 256));
       material->set_uniform("diffuse_texture", 0);
-      material->set_uniform("ModelViewMatrix", UniformSymbol::ModelViewMatrix);
-      material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
       material->set_program(Program::create(Shader::from_file(GL_VERTEX_SHADER, "src/lightcone.vert"),
                                             Shader::from_file(GL_FRAGMENT_SHADER, "src/lightcone.frag")));
 
@@ -955,8 +971,8 @@ void init()
     }
   }
 
-  g_calibration_left_texture  = Texture::from_file("data/calibration_left.png", false);
-  g_calibration_right_texture = Texture::from_file("data/calibration_right.png", false);
+  g_calibration_left_texture  = TextureCache::get().from_file("data/calibration_left.png", false);
+  g_calibration_right_texture = TextureCache::get().from_file("data/calibration_right.png", false);
 
   g_dot_surface = TextSurface::create("+", TextProperties().set_line_width(3.0f));
 
@@ -1344,6 +1360,16 @@ void main_loop()
     int delta = next - ticks;
     ticks = next;
     update_world(delta / 1000.0f);
+
+    if (g_scene_loader && g_scene_loader->update(g_scene_manager->get_world(), g_scene_upload_budget))
+    {
+      g_scene_loader.reset();
+
+      // drop what the loading left behind but no material ended up using
+      ImageDecoder::get().clear();
+      int evicted = TextureCache::get().evict_unused();
+      log_info("scene loaded, %d unused textures evicted", evicted);
+    }
       
     display();
     SDL_Delay(1);
@@ -1377,6 +1403,28 @@ void main_loop()
                 << " fps: " << static_cast<float>(num_frames) / static_cast<float>(t) * 1000.0f
                 << std::endl;
 
+      const RenderStats& stats = g_scene_manager->get_stats();
+      log_info("per frame: %d draws, %d materials, %d programs, %d textures, %d states, %d buffers",
+               stats.draws / num_frames, stats.materials / num_frames,
+               stats.programs / num_frames, stats.textures / num_frames,
+               stats.states / num_frames, stats.buffers / num_frames);
+      for(const auto& it : g_scene_manager->get_cull_stats())
+      {
+        log_info("per frame %s pass: %d nodes drawn, %d culled",
+                 it.first, it.second.drawn / num_frames, it.second.culled / num_frames);
+      }
+      g_scene_manager->reset_stats();
+
+      const OpenGLState::Stats& gl = OpenGLState::get_stats();
+      log_info("per frame GL calls issued/redundant: state %d/%d, texture %d/%d, program %d/%d, "
+               "framebuffer %d/%d, buffer %d/%d",
+               gl.state.issued / num_frames, gl.state.redundant / num_frames,
+               gl.texture.issued / num_frames, gl.texture.redundant / num_frames,
+               gl.program.issued / num_frames, gl.program.redundant / num_frames,
+               gl.framebuffer.issued / num_frames, gl.framebuffer.redundant / num_frames,
+               gl.buffer.issued / num_frames, gl.buffer.redundant / num_frames);
+      OpenGLState::reset_stats();
+
       num_frames = 0;
       start_ticks = SDL_GetTicks();
     }
@@ -1552,6 +1600,23 @@ void parse_args(int argc, char** argv, Options& opts)
         opts.video = argv[i+1];
         ++i;
       }
+      else if (strcmp("--weld", argv[i]) == 0)
+      {
+        opts.weld = true;
+      }
+      else if (strcmp("--optimize", argv[i]) == 0)
+      {
+        opts.optimize = true;
+      }
+      else if (strcmp("--compact", argv[i]) == 0)
+      {
+        opts.compact = true;
+      }
+      else if (strcmp("--threads", argv[i]) == 0)
+      {
+        opts.threads = static_cast<unsigned int>(atoi(argv[i+1]));
+        ++i;
+      }
       else
       {
         throw std::runtime_error("unknown option: " + std::string(argv[i]));
@@ -1630,7 +1695,11 @@ int main(int argc, char** argv)
     g_video_player = std::make_shared<VideoProcessor>(g_opts.video);
   }
 
+  // built-in materials are only built on first use, so this mostly
+  // depends on what the loaded scene needs
+  unsigned int init_ticks = SDL_GetTicks();
   init();
+  log_info("init() took %d ms", SDL_GetTicks() - init_ticks);
 
   std::cout << "main: " << std::this_thread::get_id() << std::endl;
 
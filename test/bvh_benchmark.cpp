@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "bvh.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "scene_node.hpp"
+
+namespace {
+
+/** Groups of nodes scattered over a 1000x1000 area, each with a model
+    of radius 0.5, the LOD generator is never called */
+std::unique_ptr<SceneNode> create_scene(int count)
+{
+  std::unique_ptr<SceneNode> root(new SceneNode);
+
+  ModelPtr model = std::make_shared<Model>();
+  model->set_lod(0.5f, [](int){ return MeshPtr(); });
+
+  const int group_size = 1000;
+  SceneNode* group = nullptr;
+  for(int i = 0; i < count; ++i)
+  {
+    if (i % group_size == 0)
+    {
+      group = root->create_child();
+      group->set_position(glm::vec3(rand() % 1000 - 500, 0.0f, rand() % 1000 - 500));
+    }
+
+    SceneNode* node = group->create_child();
+    node->set_position(glm::vec3(rand() % 100 - 50, rand() % 20 - 10, rand() % 100 - 50));
+    node->attach_model(model);
+  }
+
+  return root;
+}
+
+/** What SceneManager did before: test every node on the way down */
+void collect_recursive(SceneNode* node, const Frustum& frustum, std::vector<SceneNode*>& result)
+{
+  if (!node->get_models().empty() && frustum.intersects(node->get_world_bounds()))
+  {
+    result.push_back(node);
+  }
+
+  for(const auto& child : node->get_children())
+  {
+    collect_recursive(child.get(), frustum, result);
+  }
+}
+
+template<typename F>
+double measure(int iterations, F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    func(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int count = 100000;
+  int iterations = 100;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+  }
+
+  std::unique_ptr<SceneNode> root = create_scene(count);
+  root->update_transform();
+
+  // a few cameras looking in different directions from the middle
+  std::vector<Frustum> frustums;
+  for(int i = 0; i < 8; ++i)
+  {
+    Camera camera;
+    camera.perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    float angle = 2.0f * glm::pi<float>() * i / 8;
+    camera.look_at(glm::vec3(0.0f, 5.0f, 0.0f),
+                   glm::vec3(std::cos(angle), 5.0f, std::sin(angle)),
+                   glm::vec3(0.0f, 1.0f, 0.0f));
+    frustums.push_back(Frustum(camera.get_matrix()));
+  }
+
+  BVH bvh;
+  double build_ms = measure(1, [&](int){ bvh.build(root.get()); });
+  double refit_ms = measure(iterations, [&](int){ bvh.refit(); });
+
+  std::vector<SceneNode*> recursive_result;
+  std::vector<SceneNode*> bvh_result;
+  size_t visible = 0;
+
+  double recursive_ms = measure(iterations, [&](int i){
+      recursive_result.clear();
+      collect_recursive(root.get(), frustums[i % frustums.size()], recursive_result);
+      visible += recursive_result.size();
+    });
+  double bvh_ms = measure(iterations, [&](int i){
+      bvh_result.clear();
+      bvh.query(frustums[i % frustums.size()], bvh_result);
+    });
+
+  std::cerr << count << " nodes, BVH depth " << bvh.get_depth() << ", "
+            << visible / iterations << " visible on average\n"
+            << "  build:            " << build_ms << " ms\n"
+            << "  refit:            " << refit_ms << " ms\n"
+            << "  recursive cull:   " << recursive_ms << " ms\n"
+            << "  BVH cull:         " << bvh_ms << " ms (" << recursive_ms / bvh_ms << "x)\n";
+
+  // both have to find the same nodes
+  int ret = 0;
+  for(size_t i = 0; i < frustums.size(); ++i)
+  {
+    recursive_result.clear();
+    bvh_result.clear();
+    collect_recursive(root.get(), frustums[i], recursive_result);
+    bvh.query(frustums[i], bvh_result);
+    std::sort(recursive_result.begin(), recursive_result.end());
+    std::sort(bvh_result.begin(), bvh_result.end());
+    if (recursive_result != bvh_result)
+    {
+      std::cerr << "  ERROR: results differ for camera " << i << std::endl;
+      ret = 1;
+    }
+  }
+
+  // a ray straight down onto a known node has to hit it
+  SceneNode* target = root->get_children()[0]->get_children()[0].get();
+  glm::vec3 top(target->get_transform()[3]);
+  float distance;
+  SceneNode* hit = bvh.raycast(top + glm::vec3(0.0f, 1000.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), distance);
+  if (!hit || glm::abs(hit->get_world_bounds().get_max().y + distance - (top.y + 1000.0f)) > 0.01f)
+  {
+    std::cerr << "  ERROR: raycast missed" << std::endl;
+    ret = 1;
+  }
+
+  return ret;
+}
+
+/* EOF */
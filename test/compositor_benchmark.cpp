@@ -0,0 +1,134 @@
+#include <GL/glew.h>
+#include <SDL.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+#include "camera.hpp"
+#include "compositor.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "model.hpp"
+#include "opengl_state.hpp"
+#include "scene_manager.hpp"
+#include "texture.hpp"
+
+namespace {
+
+const int g_width = 640;
+const int g_height = 480;
+
+/** What display() did before: build the material, the quad, the model
+    and a SceneManager for every frame */
+void draw_rebuild(ProgramPtr program, TexturePtr left, TexturePtr right)
+{
+  MaterialPtr material = std::make_shared<Material>();
+  material->set_program(program);
+  material->set_uniform("MVP", UniformSymbol::ModelViewProjectionMatrix);
+  material->set_uniform("barrel_power", 0.05f);
+  material->set_uniform("left_eye",  0);
+  material->set_uniform("right_eye", 1);
+  material->set_texture(0, left);
+  material->set_texture(1, right);
+  material->set_subroutine_uniform(GL_FRAGMENT_SHADER, "fragment_color", "anaglyph");
+
+  ModelPtr model = std::make_shared<Model>();
+  model->add_mesh(Mesh::create_rect(0.0f, 0.0f, g_width, g_height, -20.0f));
+  model->set_material(material);
+
+  Camera camera;
+  camera.ortho(0, g_width, g_height, 0.0f, 0.1f, 10000.0f);
+
+  SceneManager mgr;
+  mgr.get_world()->attach_model(model);
+  mgr.render(camera);
+}
+
+void draw_persistent(Compositor& compositor, TexturePtr left, TexturePtr right)
+{
+  compositor.set_barrel_power(0.05f);
+  compositor.set_textures(left, right);
+  compositor.set_mode("anaglyph");
+  compositor.draw();
+}
+
+template<typename F>
+double measure(int frames, F draw)
+{
+  draw();
+  glFinish();
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < frames; ++i)
+  {
+    draw();
+    glFinish();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int frames = 2000;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      frames = atoi(argv[++i]);
+    }
+  }
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+  {
+    std::cerr << "Couldn't initialize SDL: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  atexit(SDL_Quit);
+
+  SDL_Window* window = SDL_CreateWindow("compositor_benchmark",
+                                        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                        g_width, g_height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!window || !SDL_GL_CreateContext(window))
+  {
+    std::cerr << "Couldn't create GL context: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  glewInit();
+
+  // keep the log output of the per frame objects out of the timing
+  std::cout.setstate(std::ios::failbit);
+
+  glViewport(0, 0, g_width, g_height);
+
+  TexturePtr left = Texture::create_empty(GL_TEXTURE_2D, GL_RGB16F, g_width, g_height);
+  TexturePtr right = Texture::create_empty(GL_TEXTURE_2D, GL_RGB16F, g_width, g_height);
+
+  Compositor compositor(g_width, g_height);
+  ProgramPtr program = Program::create(Shader::from_file(GL_FRAGMENT_SHADER, "src/composite.frag"),
+                                       Shader::from_file(GL_VERTEX_SHADER, "src/composite.vert"));
+
+  OpenGLState::reset_stats();
+  double rebuild_ms = measure(frames, [&]{ draw_rebuild(program, left, right); });
+  OpenGLState::Stats rebuild_stats = OpenGLState::get_stats();
+
+  OpenGLState::reset_stats();
+  double persistent_ms = measure(frames, [&]{ draw_persistent(compositor, left, right); });
+  OpenGLState::Stats persistent_stats = OpenGLState::get_stats();
+
+  std::cerr << frames << " frames, " << g_width << "x" << g_height << "\n"
+            << "  rebuild per frame: " << rebuild_ms << " ms/frame, "
+            << rebuild_stats.buffer.issued / (frames + 1) << " buffer binds/frame\n"
+            << "  persistent:        " << persistent_ms << " ms/frame ("
+            << rebuild_ms / persistent_ms << "x), "
+            << persistent_stats.buffer.issued / (frames + 1) << " buffer binds/frame" << std::endl;
+
+  return 0;
+}
+
+/* EOF */
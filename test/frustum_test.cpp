@@ -0,0 +1,91 @@
+#include <iostream>
+
+#include "aabb.hpp"
+#include "camera.hpp"
+#include "frustum.hpp"
+
+namespace {
+
+int g_errors = 0;
+
+void expect(const char* what, bool result, bool expected)
+{
+  if (result != expected)
+  {
+    std::cerr << "ERROR: " << what << ": got " << result << ", expected " << expected << std::endl;
+    g_errors += 1;
+  }
+}
+
+bool near(const glm::vec3& lhs, const glm::vec3& rhs)
+{
+  return glm::length(lhs - rhs) < 1.0e-4f;
+}
+
+} // namespace
+
+int main()
+{
+  // bounds of points and their transformation
+  glm::vec3 points[] = { glm::vec3(-1.0f, 0.0f, 2.0f), glm::vec3(3.0f, -2.0f, 0.0f) };
+  AABB box = AABB::from_points(points, 2);
+  expect("from_points min", near(box.get_min(), glm::vec3(-1.0f, -2.0f, 0.0f)), true);
+  expect("from_points max", near(box.get_max(), glm::vec3(3.0f, 0.0f, 2.0f)), true);
+  expect("empty", AABB().is_empty(), true);
+
+  AABB moved = box.transform(glm::translate(glm::vec3(10.0f, 0.0f, 0.0f)));
+  expect("translate", near(moved.get_min(), glm::vec3(9.0f, -2.0f, 0.0f)), true);
+
+  // a 90 degree rotation around y swaps x and z
+  AABB rotated = box.transform(glm::rotate(glm::half_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f)));
+  expect("rotate min", near(rotated.get_min(), glm::vec3(0.0f, -2.0f, -3.0f)), true);
+  expect("rotate max", near(rotated.get_max(), glm::vec3(2.0f, 0.0f, 1.0f)), true);
+
+  AABB scaled = box.transform(glm::scale(glm::vec3(2.0f)));
+  expect("scale", near(scaled.get_max(), glm::vec3(6.0f, 0.0f, 4.0f)), true);
+
+  AABB merged;
+  merged.extend(box);
+  merged.extend(moved);
+  expect("extend", near(merged.get_max(), glm::vec3(13.0f, 0.0f, 2.0f)), true);
+  merged.extend(AABB::infinite());
+  expect("extend infinite", merged.is_infinite(), true);
+
+  // camera at the origin looking down -z
+  Camera camera;
+  camera.perspective(glm::half_pi<float>(), 1.0f, 0.1f, 100.0f);
+  Frustum frustum(camera.get_matrix());
+
+  AABB unit(glm::vec3(-0.5f), glm::vec3(0.5f));
+  expect("in front", frustum.intersects(unit.transform(glm::translate(glm::vec3(0.0f, 0.0f, -10.0f)))), true);
+  expect("behind", frustum.intersects(unit.transform(glm::translate(glm::vec3(0.0f, 0.0f, 10.0f)))), false);
+  expect("left", frustum.intersects(unit.transform(glm::translate(glm::vec3(-20.0f, 0.0f, -10.0f)))), false);
+  expect("above", frustum.intersects(unit.transform(glm::translate(glm::vec3(0.0f, 20.0f, -10.0f)))), false);
+  expect("beyond far", frustum.intersects(unit.transform(glm::translate(glm::vec3(0.0f, 0.0f, -200.0f)))), false);
+  expect("straddling", frustum.intersects(unit.transform(glm::translate(glm::vec3(-10.2f, 0.0f, -10.0f)))), true);
+  expect("containing", frustum.intersects(AABB(glm::vec3(-500.0f), glm::vec3(500.0f))), true);
+  expect("infinite", frustum.intersects(AABB::infinite()), true);
+  expect("empty", frustum.intersects(AABB()), false);
+
+  expect("sphere in front", frustum.intersects(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f), true);
+  expect("sphere behind", frustum.intersects(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f), false);
+
+  // moved and turned camera
+  camera.look_at(glm::vec3(50.0f, 0.0f, 0.0f), glm::vec3(50.0f, 0.0f, 10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  Frustum turned(camera.get_matrix());
+  expect("turned in front", turned.intersects(unit.transform(glm::translate(glm::vec3(50.0f, 0.0f, 10.0f)))), true);
+  expect("turned origin", turned.intersects(unit), false);
+
+  if (g_errors)
+  {
+    std::cerr << g_errors << " errors" << std::endl;
+    return 1;
+  }
+  else
+  {
+    std::cout << "all ok" << std::endl;
+    return 0;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "image_decoder.hpp"
+
+namespace {
+
+std::vector<std::string> find_images(const std::string& directory)
+{
+  std::vector<std::string> result;
+  for(boost::filesystem::directory_iterator it(directory), end; it != end; ++it)
+  {
+    std::string filename = it->path().string();
+    if (boost::algorithm::iends_with(filename, ".jpg") ||
+        boost::algorithm::iends_with(filename, ".png"))
+    {
+      result.push_back(filename);
+    }
+  }
+  return result;
+}
+
+template<typename F>
+double measure(int iterations, F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string directory = "data/room";
+  int iterations = 3;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else
+    {
+      directory = argv[i];
+    }
+  }
+
+  std::vector<std::string> files = find_images(directory);
+
+  std::vector<ImagePtr> serial;
+  std::vector<ImagePtr> parallel;
+
+  // what Texture::from_file() used to do on the GL thread
+  double serial_ms = measure(iterations, [&]{
+      serial.clear();
+      for(const auto& filename : files)
+      {
+        ImagePtr image = Image::from_file(filename);
+        image->vflip();
+        serial.push_back(image);
+      }
+    });
+
+  // what SceneLoader does now, prefetch everything, then pick it up
+  ImageDecoder decoder;
+  double parallel_ms = measure(iterations, [&]{
+      parallel.clear();
+      for(const auto& filename : files)
+      {
+        decoder.prefetch(filename, ImageDecoder::FlipVertical);
+      }
+      for(const auto& filename : files)
+      {
+        parallel.push_back(decoder.decode(filename, ImageDecoder::FlipVertical));
+      }
+    });
+
+  size_t bytes = 0;
+  int ret = 0;
+  for(size_t i = 0; i < files.size(); ++i)
+  {
+    bytes += serial[i]->get_size();
+    if (serial[i]->get_size() != parallel[i]->get_size() ||
+        memcmp(serial[i]->get_data(), parallel[i]->get_data(), serial[i]->get_size()) != 0)
+    {
+      std::cerr << files[i] << ": ERROR: decode results differ" << std::endl;
+      ret = 1;
+    }
+  }
+
+  std::cerr << directory << ": " << files.size() << " images, " << bytes << " bytes\n"
+            << "  serial:   " << serial_ms << " ms\n"
+            << "  parallel: " << parallel_ms << " ms (" << serial_ms / parallel_ms << "x)\n";
+
+  return ret;
+}
+
+/* EOF */
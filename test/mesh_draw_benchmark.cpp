@@ -0,0 +1,271 @@
+#include <GL/glew.h>
+#include <SDL.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "mesh.hpp"
+#include "program.hpp"
+#include "shader.hpp"
+
+namespace {
+
+const char* g_vertex_shader =
+  "#version 330 core\n"
+  "in vec3 position;\n"
+  "in vec3 normal;\n"
+  "in vec3 texcoord;\n"
+  "out vec3 color;\n"
+  "void main() {\n"
+  "  color = normal * 0.5 + texcoord * 0.5;\n"
+  "  gl_Position = vec4(position * 0.001, 1.0);\n"
+  "}\n";
+
+const char* g_fragment_shader =
+  "#version 330 core\n"
+  "in vec3 color;\n"
+  "out vec4 frag_color;\n"
+  "void main() {\n"
+  "  frag_color = vec4(color, 1.0);\n"
+  "}\n";
+
+ShaderPtr create_shader(GLenum type, const char* source)
+{
+  ShaderPtr shader = std::make_shared<Shader>(type);
+  shader->source(source);
+  shader->compile();
+  if (!shader->get_compile_status())
+  {
+    throw std::runtime_error("shader compile failed: " + shader->get_info_log());
+  }
+  return shader;
+}
+
+/** small sphere-like grid, about what a typical prop in data/ has */
+MeshData create_mesh_data(int n)
+{
+  MeshData data;
+  for(int y = 0; y <= n; ++y)
+  {
+    for(int x = 0; x <= n; ++x)
+    {
+      glm::vec3 p(x, y, 0);
+      data.position.push_back(p);
+      data.normal.push_back(glm::vec3(0, 0, 1));
+      data.texcoord.push_back(glm::vec3(static_cast<float>(x) / n, static_cast<float>(y) / n, 0));
+    }
+  }
+
+  for(int y = 0; y < n; ++y)
+  {
+    for(int x = 0; x < n; ++x)
+    {
+      int v = y * (n + 1) + x;
+      int tri[] = { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 };
+      data.index.insert(data.index.end(), tri, tri + 6);
+    }
+  }
+
+  return data;
+}
+
+/** What Mesh::draw() used to do: query the program, look up every
+    attribute by name and respecify its pointer on each draw */
+class LegacyMesh
+{
+private:
+  std::vector<std::pair<std::string, GLuint> > m_arrays;
+  GLuint m_element_array_vbo;
+  int m_element_count;
+
+public:
+  LegacyMesh(const MeshData& data) :
+    m_arrays(),
+    m_element_array_vbo(),
+    m_element_count(data.index.size())
+  {
+    add("position", data.position);
+    add("normal", data.normal);
+    add("texcoord", data.texcoord);
+
+    glGenBuffers(1, &m_element_array_vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_element_array_vbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * data.index.size(), data.index.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+
+  ~LegacyMesh()
+  {
+    for(const auto& array : m_arrays)
+    {
+      glDeleteBuffers(1, &array.second);
+    }
+    glDeleteBuffers(1, &m_element_array_vbo);
+  }
+
+  void add(const std::string& name, const std::vector<glm::vec3>& vec)
+  {
+    GLuint vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * vec.size(), vec.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_arrays.push_back(std::make_pair(name, vbo));
+  }
+
+  void draw()
+  {
+    GLint program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    for(const auto& array : m_arrays)
+    {
+      int loc = glGetAttribLocation(program, array.first.c_str());
+      if (loc != -1)
+      {
+        glBindBuffer(GL_ARRAY_BUFFER, array.second);
+        glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glEnableVertexAttribArray(loc);
+      }
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_element_array_vbo);
+    glDrawElements(GL_TRIANGLES, m_element_count, GL_UNSIGNED_INT, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+
+private:
+  LegacyMesh(const LegacyMesh&) = delete;
+  LegacyMesh& operator=(const LegacyMesh&) = delete;
+};
+
+template<typename F>
+double measure(SDL_Window* window, int frames, F draw_frame)
+{
+  // warm up, so VAOs get built outside the timing
+  draw_frame();
+  glFinish();
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < frames; ++i)
+  {
+    glClear(GL_COLOR_BUFFER_BIT);
+    draw_frame();
+    SDL_GL_SwapWindow(window);
+  }
+  glFinish();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int nodes = 5000;
+  int frames = 50;
+  int meshes = 50;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      nodes = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+    {
+      frames = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+    {
+      meshes = atoi(argv[++i]);
+    }
+  }
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+  {
+    std::cerr << "Couldn't initialize SDL: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  atexit(SDL_Quit);
+
+  SDL_Window* window = SDL_CreateWindow("mesh_draw_benchmark",
+                                        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                        256, 256, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!window || !SDL_GL_CreateContext(window))
+  {
+    std::cerr << "Couldn't create GL context: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  SDL_GL_SetSwapInterval(0);
+  glewInit();
+
+  ProgramPtr program = Program::create(create_shader(GL_VERTEX_SHADER, g_vertex_shader),
+                                       create_shader(GL_FRAGMENT_SHADER, g_fragment_shader));
+
+  MeshData data = create_mesh_data(8);
+
+  // a few distinct meshes shared by many nodes, like a scene from the
+  // ResourceCache would have
+  std::vector<std::unique_ptr<LegacyMesh> > legacy;
+  std::vector<std::unique_ptr<Mesh> > separate;
+  std::vector<std::unique_ptr<Mesh> > interleaved;
+  for(int i = 0; i < meshes; ++i)
+  {
+    legacy.emplace_back(new LegacyMesh(data));
+
+    separate.emplace_back(new Mesh(GL_TRIANGLES));
+    separate.back()->attach_float_array("position", data.position);
+    separate.back()->attach_float_array("normal", data.normal);
+    separate.back()->attach_float_array("texcoord", data.texcoord);
+    separate.back()->attach_element_array(data.index);
+
+    interleaved.emplace_back(new Mesh(GL_TRIANGLES));
+    interleaved.back()->attach_interleaved_arrays({ Mesh::interleaved_float("position", data.position.data()),
+                                                    Mesh::interleaved_float("normal", data.normal.data()),
+                                                    Mesh::interleaved_float("texcoord", data.texcoord.data()) },
+                                                  data.position.size());
+    interleaved.back()->attach_element_array(data.index);
+  }
+
+  glUseProgram(program->get_id());
+
+  double legacy_ms = measure(window, frames, [&]{
+      for(int i = 0; i < nodes; ++i)
+      {
+        legacy[i % meshes]->draw();
+      }
+    });
+
+  double separate_ms = measure(window, frames, [&]{
+      for(int i = 0; i < nodes; ++i)
+      {
+        separate[i % meshes]->draw(program->get_id());
+      }
+    });
+
+  double interleaved_ms = measure(window, frames, [&]{
+      for(int i = 0; i < nodes; ++i)
+      {
+        interleaved[i % meshes]->draw(program->get_id());
+      }
+    });
+
+  glUseProgram(0);
+
+  std::cout << nodes << " draws per frame, " << meshes << " meshes, " << frames << " frames\n"
+            << "  per-draw attribute setup:   " << legacy_ms << " ms/frame\n"
+            << "  VAO, separate VBOs:         " << separate_ms << " ms/frame ("
+            << legacy_ms / separate_ms << "x)\n"
+            << "  VAO, interleaved VBO:       " << interleaved_ms << " ms/frame ("
+            << legacy_ms / interleaved_ms << "x)" << std::endl;
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mesh_generator.hpp"
+#include "mesh_optimizer.hpp"
+
+namespace {
+
+/** Indices in range, no degenerate triangles, unit normals */
+bool validate(const MeshData& mesh, bool unit_normals)
+{
+  if (mesh.index.size() % 3 != 0 ||
+      mesh.normal.size() != mesh.position.size() ||
+      mesh.texcoord.size() != mesh.position.size())
+  {
+    return false;
+  }
+
+  for(size_t i = 0; i < mesh.index.size(); i += 3)
+  {
+    for(int j = 0; j < 3; ++j)
+    {
+      if (mesh.index[i+j] < 0 || static_cast<size_t>(mesh.index[i+j]) >= mesh.position.size())
+      {
+        return false;
+      }
+    }
+
+    glm::vec3 a = mesh.position[mesh.index[i+0]];
+    glm::vec3 b = mesh.position[mesh.index[i+1]];
+    glm::vec3 c = mesh.position[mesh.index[i+2]];
+    if (glm::length(glm::cross(b - a, c - a)) < 1e-7f)
+    {
+      return false;
+    }
+  }
+
+  for(const auto& n : mesh.normal)
+  {
+    if (unit_normals && fabsf(glm::length(n) - 1.0f) > 1e-4f)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool check(const std::string& name, const MeshData& mesh, size_t old_vertex_count, bool unit_normals = true)
+{
+  bool ok = validate(mesh, unit_normals);
+  VertexCacheStats stats = analyze_vertex_cache(mesh.index, mesh.position.size());
+  std::cout << name << ": " << old_vertex_count << " -> " << mesh.position.size() << " vertices, "
+            << mesh.index.size() / 3 << " triangles, ACMR " << stats.acmr
+            << (ok ? "" : " FAILED") << std::endl;
+  return ok;
+}
+
+} // namespace
+
+int main()
+{
+  int ret = 0;
+
+  // the old generators emitted four vertices per quad
+  if (!check("sphere 8x16", generate_sphere(0.2f, 8, 16), 8 * 16 * 4) ||
+      !check("sphere 32x64", generate_sphere(1.0f, 32, 64), 32 * 64 * 4) ||
+      !check("curved screen 32x32", generate_curved_screen(15.0f, glm::radians(360.0f), glm::radians(180.0f),
+                                                           32, 32, 0, 0, false, false), 32 * 32 * 4) ||
+      !check("curved screen 32x32 offset", generate_curved_screen(15.0f, glm::radians(125.0f), glm::radians(70.3f),
+                                                                  32, 32, 16, -16, true, true), 32 * 32 * 4) ||
+      // the skybox normals point at the corners
+      !check("skybox", generate_skybox(500.0f), 8, false))
+  {
+    ret = 1;
+  }
+
+  // more pixels need at least as many segments, within the limits
+  int last = 0;
+  for(float pixels = 0.0f; pixels < 10000.0f; pixels = pixels * 1.5f + 1.0f)
+  {
+    int segments = lod_segments(pixels);
+    if (segments < last || segments < 8 || segments > 128 || (segments & (segments - 1)) != 0)
+    {
+      std::cout << "lod_segments(" << pixels << ") = " << segments << " FAILED" << std::endl;
+      ret = 1;
+    }
+    last = segments;
+  }
+  std::cout << "lod_segments: 10px -> " << lod_segments(10.0f)
+            << ", 100px -> " << lod_segments(100.0f)
+            << ", 1000px -> " << lod_segments(1000.0f) << std::endl;
+
+  return ret;
+}
+
+/* EOF */
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "mesh_hash.hpp"
+#include "scene_parser.hpp"
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files(argv + 1, argv + argc);
+  if (files.empty())
+  {
+    files = { "data/textured_cube.mod", "data/wiimote.mod", "data/room/blender.mod" };
+  }
+
+  // identical content must give identical hashes, moving data between
+  // arrays must not
+  {
+    MeshData a;
+    a.position = { glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(4.0f, 5.0f, 6.0f) };
+    a.index = { 0, 1, 0 };
+    MeshData b = a;
+    MeshData c = a;
+    c.index.push_back(c.index.back());
+    c.index.pop_back();
+    c.normal.push_back(c.position.back());
+    c.position.pop_back();
+
+    bool ok =
+      hash_mesh(a).get() == hash_mesh(b).get() && hash_mesh(a).get() != hash_mesh(c).get() &&
+      hash_mesh(a).get_key() == hash_mesh(b).get_key() && !(hash_mesh(a).get_key() == hash_mesh(c).get_key()) &&
+      hash_mesh(a).get_key().hash2 != hash_mesh(c).get_key().hash2;
+    std::cout << "hash consistency: " << (ok ? "ok" : "FAILED") << std::endl;
+    if (!ok)
+    {
+      return 1;
+    }
+  }
+
+  for(const auto& filename : files)
+  {
+    std::map<uint64_t, int> counts;
+    int objects = 0;
+    size_t bytes_total = 0;
+    size_t bytes_saved = 0;
+
+    MappedFile file(filename);
+    SceneParser parser(filename, [&](SceneObject& obj){
+        if (!obj.mesh.position.empty())
+        {
+          MeshHash hash = hash_mesh(obj.mesh);
+          objects += 1;
+          bytes_total += hash.get_bytes();
+          if (counts[hash.get()]++ != 0)
+          {
+            bytes_saved += hash.get_bytes();
+          }
+        }
+      });
+    parser.parse(file.begin(), file.end());
+
+    std::cout << filename << ": " << objects << " meshes, " << counts.size() << " unique, "
+              << bytes_saved << " of " << bytes_total << " bytes shared" << std::endl;
+  }
+
+  return 0;
+}
+
+/* EOF */
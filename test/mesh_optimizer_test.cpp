@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "mesh_optimizer.hpp"
+#include "scene_parser.hpp"
+
+namespace {
+
+/** Expand the indexed mesh into a list of triangles, which has to stay
+    the same, up to triangle order, no matter how the vertices get
+    shuffled around */
+std::vector<std::string> unindex(const MeshData& mesh)
+{
+  std::vector<std::string> result;
+  std::string triangle;
+  auto append = [&triangle](const void* data, size_t len) {
+    triangle.append(static_cast<const char*>(data), len);
+  };
+
+  for(size_t i = 0; i < mesh.index.size(); ++i)
+  {
+    int idx = mesh.index[i];
+    append(&mesh.position[idx], sizeof(glm::vec3));
+    append(&mesh.normal[idx], sizeof(glm::vec3));
+    append(&mesh.texcoord[idx], sizeof(glm::vec3));
+    if (mesh.has_bones())
+    {
+      append(&mesh.bone_weight[idx], sizeof(glm::vec4));
+      append(&mesh.bone_index[idx], sizeof(glm::ivec4));
+    }
+
+    if (i % 3 == 2)
+    {
+      result.push_back(triangle);
+      triangle.clear();
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files(argv + 1, argv + argc);
+  if (files.empty())
+  {
+    files = { "data/textured_cube.mod", "data/wiimote.mod", "data/room/blender.mod" };
+  }
+
+  int ret = 0;
+
+  { // a quad written as two separate triangles
+    MeshData quad;
+    quad.position = { glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(1, 1, 0),
+                      glm::vec3(0, 0, 0), glm::vec3(1, 1, 0), glm::vec3(0, 1, 0) };
+    quad.normal.resize(6, glm::vec3(0, 0, 1));
+    quad.texcoord.resize(6);
+    quad.index = { 0, 1, 2, 3, 4, 5 };
+
+    std::vector<std::string> reference = unindex(quad);
+    size_t after = weld_vertices(quad);
+    bool ok = (after == 4 && unindex(quad) == reference);
+    std::cout << "quad: 6 -> " << after << " vertices" << (ok ? "" : " FAILED") << std::endl;
+    if (!ok)
+    {
+      ret = 1;
+    }
+  }
+
+  { // a 64x64 grid with the triangles in random order
+    const int n = 64;
+    MeshData grid;
+    for(int y = 0; y <= n; ++y)
+    {
+      for(int x = 0; x <= n; ++x)
+      {
+        grid.position.push_back(glm::vec3(x, y, 0));
+      }
+    }
+    grid.normal.resize(grid.position.size(), glm::vec3(0, 0, 1));
+    grid.texcoord.resize(grid.position.size());
+
+    std::vector<int> quads;
+    for(int i = 0; i < n * n; ++i)
+    {
+      quads.push_back(i);
+    }
+    std::random_shuffle(quads.begin(), quads.end());
+    for(int q : quads)
+    {
+      int v = (q / n) * (n + 1) + q % n;
+      int tri[] = { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 };
+      grid.index.insert(grid.index.end(), tri, tri + 6);
+    }
+
+    std::vector<std::string> reference = unindex(grid);
+    VertexCacheStats before = analyze_vertex_cache(grid.index, grid.position.size());
+    optimize_vertex_cache(grid);
+    optimize_vertex_fetch(grid);
+    VertexCacheStats after = analyze_vertex_cache(grid.index, grid.position.size());
+
+    bool ok = (after.acmr < before.acmr && unindex(grid) == reference);
+    std::cout << "grid: ACMR " << before.acmr << " -> " << after.acmr
+              << ", ATVR " << before.atvr << " -> " << after.atvr
+              << (ok ? "" : " FAILED") << std::endl;
+    if (!ok)
+    {
+      ret = 1;
+    }
+  }
+
+  { // an index past the end has to throw instead of touching memory
+    MeshData broken;
+    broken.position.resize(3);
+    broken.index = { 0, 1, 7 };
+
+    int throws = 0;
+    try { analyze_vertex_cache(broken.index, broken.position.size()); } catch(const std::exception&) { throws += 1; }
+    try { optimize_vertex_cache(broken); } catch(const std::exception&) { throws += 1; }
+    try { optimize_vertex_fetch(broken); } catch(const std::exception&) { throws += 1; }
+
+    VertexCacheStats empty = analyze_vertex_cache(FaceLst{ 0 }, 1);
+    bool ok = (throws == 3 && empty.acmr == 0.0f);
+    std::cout << "broken indices: " << throws << " of 3 throw" << (ok ? "" : " FAILED") << std::endl;
+    if (!ok)
+    {
+      ret = 1;
+    }
+  }
+
+  for(const auto& filename : files)
+  {
+    size_t total_before = 0;
+    size_t total_after = 0;
+
+    MappedFile file(filename);
+    SceneParser parser(filename, [&](SceneObject& obj){
+        if (obj.mesh.position.empty())
+        {
+          return;
+        }
+
+        std::vector<std::string> reference = unindex(obj.mesh);
+
+        size_t before = obj.mesh.position.size();
+        size_t after = weld_vertices(obj.mesh);
+        total_before += before;
+        total_after += after;
+
+        VertexCacheStats cache_before = analyze_vertex_cache(obj.mesh.index, obj.mesh.position.size());
+        optimize_vertex_cache(obj.mesh);
+        optimize_vertex_fetch(obj.mesh);
+        VertexCacheStats cache_after = analyze_vertex_cache(obj.mesh.index, obj.mesh.position.size());
+
+        bool ok = (after == obj.mesh.position.size() && unindex(obj.mesh) == reference);
+        std::cout << "  " << obj.name << ": " << before << " -> " << after << " vertices, "
+                  << "ACMR " << cache_before.acmr << " -> " << cache_after.acmr << ", "
+                  << "ATVR " << cache_before.atvr << " -> " << cache_after.atvr
+                  << (ok ? "" : " FAILED") << std::endl;
+        if (!ok)
+        {
+          ret = 1;
+        }
+      });
+    parser.parse(file.begin(), file.end());
+
+    std::cout << filename << ": " << total_before << " -> " << total_after << " vertices" << std::endl;
+  }
+
+  return ret;
+}
+
+/* EOF */
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "mesh_packing.hpp"
+#include "scene_parser.hpp"
+
+namespace {
+
+struct MaxError
+{
+  float normal;
+  float texcoord;
+  float bone_weight;
+
+  /** largest difference of the packed bytes from 255 for weights
+      that sum up to 1 */
+  int bone_weight_sum;
+
+  MaxError() : normal(), texcoord(), bone_weight(), bone_weight_sum() {}
+};
+
+/** Pack and unpack the mesh, return the largest per component error */
+MaxError roundtrip(const MeshData& mesh, TexcoordEncoding& encoding)
+{
+  MaxError err;
+
+  std::vector<uint32_t> normal;
+  pack_normals(mesh.normal.data(), mesh.normal.size(), normal);
+  for(size_t i = 0; i < normal.size(); ++i)
+  {
+    glm::vec3 d = glm::abs(unpack_normal(normal[i]) - glm::clamp(mesh.normal[i], -1.0f, 1.0f));
+    err.normal = glm::max(err.normal, glm::max(d.x, glm::max(d.y, d.z)));
+  }
+
+  std::vector<uint32_t> texcoord;
+  encoding = pack_texcoords(mesh.texcoord.data(), mesh.texcoord.size(), texcoord);
+  for(size_t i = 0; i < texcoord.size(); ++i)
+  {
+    glm::vec2 uv = encoding == TexcoordEncoding::Unorm16 ?
+      glm::unpackUnorm2x16(texcoord[i]) : glm::unpackHalf2x16(texcoord[i]);
+    glm::vec2 ref(mesh.texcoord[i]);
+    // half floats have a relative error
+    glm::vec2 d = glm::abs(uv - ref) / glm::max(glm::vec2(1.0f), glm::abs(ref));
+    err.texcoord = glm::max(err.texcoord, glm::max(d.x, d.y));
+  }
+
+  std::vector<uint32_t> bone_weight;
+  pack_bone_weights(mesh.bone_weight.data(), mesh.bone_weight.size(), bone_weight);
+  for(size_t i = 0; i < bone_weight.size(); ++i)
+  {
+    glm::vec4 d = glm::abs(glm::unpackUnorm4x8(bone_weight[i]) - mesh.bone_weight[i]);
+    err.bone_weight = glm::max(err.bone_weight, glm::max(glm::max(d.x, d.y), glm::max(d.z, d.w)));
+
+    const glm::vec4& w = mesh.bone_weight[i];
+    if (fabsf(w.x + w.y + w.z + w.w - 1.0f) < 1e-4f)
+    {
+      int sum = 0;
+      for(int k = 0; k < 4; ++k)
+      {
+        sum += (bone_weight[i] >> (8 * k)) & 0xff;
+      }
+      err.bone_weight_sum = std::max(err.bone_weight_sum, abs(sum - 255));
+    }
+  }
+
+  return err;
+}
+
+bool check(const std::string& name, const MeshData& mesh)
+{
+  TexcoordEncoding encoding;
+  MaxError err = roundtrip(mesh, encoding);
+
+  std::vector<uint16_t> index;
+  bool short_index = pack_indices(mesh.index.data(), mesh.index.size(), index);
+
+  size_t vertices = mesh.position.size();
+  size_t bones = mesh.has_bones() ? vertices : 0;
+  size_t before = vertices * 36 + bones * 32 + mesh.index.size() * 4;
+  size_t after = vertices * (encoding == TexcoordEncoding::Float ? 24 : 20) + bones * 20 +
+    mesh.index.size() * (short_index ? 2 : 4);
+
+  // 10 bit snorm, 16 bit unorm or half float, 8 bit unorm with the
+  // rounding error of all four weights on the largest one
+  bool ok =
+    err.normal <= 0.5f / 511.0f + 1e-6f &&
+    err.texcoord <= 1.0f / 1024.0f &&
+    err.bone_weight <= 2.5f / 255.0f + 1e-6f &&
+    err.bone_weight_sum == 0 &&
+    short_index == (vertices <= 0x10000);
+
+  std::cout << name << ": " << before << " -> " << after << " bytes, "
+            << "texcoords as " << (encoding == TexcoordEncoding::Unorm16 ? "unorm16" :
+                                   encoding == TexcoordEncoding::Half ? "half" : "float")
+            << ", " << (short_index ? "16" : "32") << " bit indices, "
+            << "max error: normal " << err.normal
+            << " texcoord " << err.texcoord
+            << " bone_weight " << err.bone_weight
+            << " bone_weight_sum " << err.bone_weight_sum
+            << (ok ? "" : " FAILED") << std::endl;
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files(argv + 1, argv + argc);
+  if (files.empty())
+  {
+    files = { "data/textured_cube.mod", "data/wiimote.mod", "data/room/blender.mod" };
+  }
+
+  int ret = 0;
+
+  { // unit normals in all directions and the corner cases
+    MeshData mesh;
+    for(int i = 0; i < 1000; ++i)
+    {
+      float a = static_cast<float>(i) * 0.1f;
+      float b = static_cast<float>(i) * 0.037f;
+      mesh.position.emplace_back();
+      mesh.normal.emplace_back(cosf(a) * sinf(b), sinf(a) * sinf(b), cosf(b));
+      mesh.texcoord.emplace_back(static_cast<float>(i) / 999.0f, 1.0f - static_cast<float>(i) / 999.0f, 0.0f);
+      mesh.bone_weight.emplace_back(glm::fract(a), glm::fract(b), 0.0f, 1.0f);
+      mesh.bone_index.emplace_back();
+    }
+    mesh.normal[0] = glm::vec3(-1.0f, 1.0f, 0.0f);
+    mesh.index = { 0, 1, 2 };
+    if (!check("synthetic", mesh))
+    {
+      ret = 1;
+    }
+
+    // weights that sum up to 1, as exported for skinned meshes
+    MeshData normalized = mesh;
+    for(auto& w : normalized.bone_weight)
+    {
+      w = glm::vec4(w.x, w.y, w.x * w.y, 0.1f);
+      w /= w.x + w.y + w.z + w.w;
+    }
+    if (!check("synthetic normalized weights", normalized))
+    {
+      ret = 1;
+    }
+
+    // tiled texcoords don't fit into unorm
+    mesh.texcoord[1] = glm::vec3(4.0f, -2.5f, 0.0f);
+    // too many vertices for 16 bit indices
+    mesh.position.resize(70000);
+    mesh.index.push_back(69999);
+    if (!check("synthetic tiled", mesh))
+    {
+      ret = 1;
+    }
+
+    // half floats are too coarse for heavily tiled texcoords
+    mesh.texcoord[2] = glm::vec3(100.0f, 0.25f, 0.0f);
+    TexcoordEncoding encoding;
+    roundtrip(mesh, encoding);
+    if (encoding != TexcoordEncoding::Float || !check("synthetic far tiled", mesh))
+    {
+      std::cout << "synthetic far tiled: expected float texcoords FAILED" << std::endl;
+      ret = 1;
+    }
+  }
+
+  for(const auto& filename : files)
+  {
+    MappedFile file(filename);
+    SceneParser parser(filename, [&](SceneObject& obj){
+        if (!check(filename + ": " + obj.name, obj.mesh))
+        {
+          ret = 1;
+        }
+      });
+    parser.parse(file.begin(), file.end());
+  }
+
+  return ret;
+}
+
+/* EOF */
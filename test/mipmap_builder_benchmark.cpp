@@ -0,0 +1,120 @@
+#include <GL/glew.h>
+#include <GL/glu.h>
+#include <SDL.h>
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.hpp"
+#include "mipmap_builder.hpp"
+#include "texture.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+ImagePtr random_image(int width, int height)
+{
+  ImagePtr image = std::make_shared<Image>(width, height, 3);
+  for(size_t i = 0; i < image->get_size(); ++i)
+  {
+    image->get_data()[i] = static_cast<uint8_t>(rand());
+  }
+  return image;
+}
+
+/** What Texture::from_image() did before */
+void upload_glu(const Image& image)
+{
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, image.get_width(), image.get_height(),
+                    GL_RGB, GL_UNSIGNED_BYTE, image.get_data());
+  glDeleteTextures(1, &texture);
+}
+
+template<typename F>
+double measure(int iterations, F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    func();
+    glFinish();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = 5;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+  }
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+  {
+    std::cerr << "Couldn't initialize SDL: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  atexit(SDL_Quit);
+
+  SDL_Window* window = SDL_CreateWindow("mipmap_builder_benchmark",
+                                        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                        64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!window || !SDL_GL_CreateContext(window))
+  {
+    std::cerr << "Couldn't create GL context: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  glewInit();
+
+  ThreadPool pool;
+
+  const int sizes[][2] = { { 512, 512 }, { 2048, 2048 }, { 1000, 700 } };
+  for(const auto& size : sizes)
+  {
+    ImagePtr image = random_image(size[0], size[1]);
+
+    double glu_ms = measure(iterations, [&]{ upload_glu(*image); });
+
+    double box_ms = measure(iterations, [&]{
+        MipmapBuilder(MipmapFilter::Box).build(*image);
+      });
+    double kaiser_ms = measure(iterations, [&]{
+        MipmapBuilder(MipmapFilter::Kaiser).build(*image);
+      });
+    double pooled_ms = measure(iterations, [&]{
+        MipmapBuilder(MipmapFilter::Box, true, &pool).build(*image);
+      });
+
+    // the upload alone, as done after ImageDecoder built the chain
+    image->set_mipmaps(MipmapBuilder(MipmapFilter::Box).build(*image));
+    double upload_ms = measure(iterations, [&]{ Texture::from_image(*image); });
+
+    std::cerr << size[0] << "x" << size[1] << ", "
+              << MipmapBuilder::get_level_count(size[0], size[1]) << " levels\n"
+              << "  gluBuild2DMipmaps: " << glu_ms << " ms\n"
+              << "  box:               " << box_ms << " ms\n"
+              << "  kaiser:            " << kaiser_ms << " ms\n"
+              << "  box, threaded:     " << pooled_ms << " ms (" << pool.size() << " threads)\n"
+              << "  upload:            " << upload_ms << " ms\n"
+              << "  box + upload:      " << box_ms + upload_ms << " ms ("
+              << glu_ms / (box_ms + upload_ms) << "x)" << std::endl;
+  }
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <stdlib.h>
+
+#include "mipmap_builder.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+int g_errors = 0;
+
+void expect(const char* what, bool result)
+{
+  if (!result)
+  {
+    std::cerr << "ERROR: " << what << std::endl;
+    g_errors += 1;
+  }
+}
+
+ImagePtr random_image(int width, int height, int bpp)
+{
+  ImagePtr image = std::make_shared<Image>(width, height, bpp);
+  for(size_t i = 0; i < image->get_size(); ++i)
+  {
+    image->get_data()[i] = static_cast<uint8_t>(rand());
+  }
+  return image;
+}
+
+bool near(const Image& image, int x, int y, int ch, int expected)
+{
+  int value = image.get_data()[y * image.get_pitch() + x * image.get_bytes_per_pixel() + ch];
+  return abs(value - expected) <= 1;
+}
+
+bool same(const Image& lhs, const Image& rhs)
+{
+  return
+    lhs.get_width() == rhs.get_width() &&
+    lhs.get_height() == rhs.get_height() &&
+    std::equal(lhs.get_data(), lhs.get_data() + lhs.get_size(), rhs.get_data());
+}
+
+} // namespace
+
+int main()
+{
+  expect("level count 256x128", MipmapBuilder::get_level_count(256, 128) == 9);
+  expect("level count 5x3", MipmapBuilder::get_level_count(5, 3) == 3);
+  expect("level count 1x1", MipmapBuilder::get_level_count(1, 1) == 1);
+
+  // level sizes, non-power-of-two included
+  {
+    std::vector<ImagePtr> levels = MipmapBuilder().build(*random_image(5, 3, 3));
+    expect("5x3 gives two levels", levels.size() == 2);
+    expect("5x3 level 1", levels[0]->get_width() == 2 && levels[0]->get_height() == 1);
+    expect("5x3 level 2", levels[1]->get_width() == 1 && levels[1]->get_height() == 1);
+  }
+
+  // box without sRGB is the plain average of 2x2 texels
+  {
+    ImagePtr image = random_image(8, 8, 4);
+    std::vector<ImagePtr> levels = MipmapBuilder(MipmapFilter::Box, false).build(*image);
+    const Image& level = *levels[0];
+    bool ok = true;
+    for(int y = 0; y < 4; ++y)
+    {
+      for(int x = 0; x < 4; ++x)
+      {
+        for(int ch = 0; ch < 4; ++ch)
+        {
+          int sum = 0;
+          for(int i = 0; i < 4; ++i)
+          {
+            int sx = 2 * x + (i & 1);
+            int sy = 2 * y + (i >> 1);
+            sum += image->get_data()[sy * image->get_pitch() + sx * 4 + ch];
+          }
+          ok = ok && near(level, x, y, ch, (sum + 2) / 4);
+        }
+      }
+    }
+    expect("box average", ok);
+  }
+
+  // a flat color stays the same in every level, with both filters
+  for(MipmapFilter filter : { MipmapFilter::Box, MipmapFilter::Kaiser })
+  {
+    Image image(37, 21, 4);
+    for(size_t i = 0; i < image.get_size(); i += 4)
+    {
+      image.get_data()[i + 0] = 200;
+      image.get_data()[i + 1] = 100;
+      image.get_data()[i + 2] = 30;
+      image.get_data()[i + 3] = 128;
+    }
+    bool ok = true;
+    for(const auto& level : MipmapBuilder(filter, true).build(image))
+    {
+      ok = ok &&
+        near(*level, level->get_width() - 1, 0, 0, 200) &&
+        near(*level, 0, level->get_height() - 1, 1, 100) &&
+        near(*level, 0, 0, 2, 30) &&
+        near(*level, 0, 0, 3, 128);
+    }
+    expect(filter == MipmapFilter::Box ? "flat color, box" : "flat color, kaiser", ok);
+  }
+
+  // sRGB averages black and white to 188, not 128
+  {
+    Image image(2, 1, 3);
+    std::fill(image.get_data(), image.get_data() + 3, 0);
+    std::fill(image.get_data() + 3, image.get_data() + 6, 255);
+    std::vector<ImagePtr> levels = MipmapBuilder(MipmapFilter::Box, true).build(image);
+    expect("sRGB average", near(*levels[0], 0, 0, 0, 188));
+  }
+
+  // threads don't change the result
+  {
+    ThreadPool pool(4);
+    ImagePtr image = random_image(517, 301, 3);
+    for(MipmapFilter filter : { MipmapFilter::Box, MipmapFilter::Kaiser })
+    {
+      std::vector<ImagePtr> serial = MipmapBuilder(filter, true).build(*image);
+      std::vector<ImagePtr> parallel = MipmapBuilder(filter, true, &pool).build(*image);
+      bool ok = serial.size() == parallel.size();
+      for(size_t i = 0; ok && i < serial.size(); ++i)
+      {
+        ok = same(*serial[i], *parallel[i]);
+      }
+      expect("threaded result", ok);
+    }
+  }
+
+  if (g_errors == 0)
+  {
+    std::cout << "all ok" << std::endl;
+    return 0;
+  }
+  else
+  {
+    return 1;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "pixel_kernels.hpp"
+
+namespace {
+
+typedef void (*Kernel)(const uint8_t*, uint8_t*, size_t);
+
+/** MB/s of source data */
+double measure(int iterations, Kernel kernel, const std::vector<uint8_t>& src, std::vector<uint8_t>& dst,
+               size_t count, int src_bpp)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    kernel(src.data(), dst.data(), count);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return static_cast<double>(count * src_bpp) * iterations / seconds / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int iterations = 20;
+  int size = 2048;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+    {
+      size = atoi(argv[++i]);
+    }
+  }
+
+  const size_t count = static_cast<size_t>(size) * size;
+  std::vector<uint8_t> src(count * 4);
+  for(auto& v : src)
+  {
+    v = static_cast<uint8_t>(rand());
+  }
+  std::vector<uint8_t> dst(count * 4);
+
+  std::cerr << size << "x" << size << " pixels, MB/s of source data\n"
+            << "          swap_rb_rgb  swap_rb_rgba  rgb_to_rgba  rgba_to_rgb  premultiply  unpremultiply  vflip\n";
+
+  const PixelKernels* tables[] = { &PixelKernels::scalar(), PixelKernels::sse2(), PixelKernels::avx2() };
+  for(const PixelKernels* kernels : tables)
+  {
+    if (!kernels)
+    {
+      continue;
+    }
+
+    double vflip_mbs;
+    {
+      auto start = std::chrono::steady_clock::now();
+      for(int i = 0; i < iterations; ++i)
+      {
+        kernels->vflip(dst.data(), size * 4, size);
+      }
+      auto end = std::chrono::steady_clock::now();
+      vflip_mbs = static_cast<double>(count * 4) * iterations
+        / std::chrono::duration<double>(end - start).count() / (1024.0 * 1024.0);
+    }
+
+    std::cerr.width(8);
+    std::cerr << kernels->name << "  "
+              << measure(iterations, kernels->swap_rb_rgb, src, dst, count, 3) << "  "
+              << measure(iterations, kernels->swap_rb_rgba, src, dst, count, 4) << "  "
+              << measure(iterations, kernels->rgb_to_rgba, src, dst, count, 3) << "  "
+              << measure(iterations, kernels->rgba_to_rgb, src, dst, count, 4) << "  "
+              << measure(iterations, kernels->premultiply, src, dst, count, 4) << "  "
+              << measure(iterations, kernels->unpremultiply, src, dst, count, 4) << "  "
+              << vflip_mbs << "\n";
+  }
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "pixel_kernels.hpp"
+
+namespace {
+
+int g_errors = 0;
+
+typedef void (*Kernel)(const uint8_t*, uint8_t*, size_t);
+
+std::vector<uint8_t> random_pixels(size_t size)
+{
+  std::vector<uint8_t> data(size);
+  for(auto& v : data)
+  {
+    v = static_cast<uint8_t>(rand());
+  }
+  return data;
+}
+
+/** Compare \a kernel against \a reference for all pixel counts up to
+    a few vector widths, so every tail length is covered */
+void check(const std::string& name, Kernel kernel, Kernel reference,
+           int src_bpp, int dst_bpp, bool in_place)
+{
+  for(size_t count = 0; count < 100; ++count)
+  {
+    std::vector<uint8_t> src = random_pixels(count * src_bpp);
+
+    // a guard byte after the end has to stay untouched
+    std::vector<uint8_t> expected(count * dst_bpp + 1, 0xab);
+    std::vector<uint8_t> result(count * dst_bpp + 1, 0xab);
+
+    reference(src.data(), expected.data(), count);
+    kernel(src.data(), result.data(), count);
+
+    if (result != expected)
+    {
+      std::cerr << "ERROR: " << name << ": differs for " << count << " pixels" << std::endl;
+      g_errors += 1;
+      return;
+    }
+
+    if (in_place)
+    {
+      std::vector<uint8_t> buffer = src;
+      buffer.push_back(0xab);
+      kernel(buffer.data(), buffer.data(), count);
+      if (buffer != expected)
+      {
+        std::cerr << "ERROR: " << name << ": in place differs for " << count << " pixels" << std::endl;
+        g_errors += 1;
+        return;
+      }
+    }
+  }
+}
+
+void check_kernels(const PixelKernels& kernels)
+{
+  const PixelKernels& ref = PixelKernels::scalar();
+  std::string prefix = std::string(kernels.name) + ": ";
+
+  check(prefix + "swap_rb_rgb", kernels.swap_rb_rgb, ref.swap_rb_rgb, 3, 3, true);
+  check(prefix + "swap_rb_rgba", kernels.swap_rb_rgba, ref.swap_rb_rgba, 4, 4, true);
+  check(prefix + "rgb_to_rgba", kernels.rgb_to_rgba, ref.rgb_to_rgba, 3, 4, false);
+  check(prefix + "rgba_to_rgb", kernels.rgba_to_rgb, ref.rgba_to_rgb, 4, 3, false);
+  check(prefix + "premultiply", kernels.premultiply, ref.premultiply, 4, 4, true);
+  check(prefix + "unpremultiply", kernels.unpremultiply, ref.unpremultiply, 4, 4, true);
+
+  for(size_t len = 0; len < 100; ++len)
+  {
+    std::vector<uint8_t> image = random_pixels(len * 5);
+    std::vector<uint8_t> expected = image;
+    ref.vflip(expected.data(), len, 5);
+    kernels.vflip(image.data(), len, 5);
+    if (image != expected)
+    {
+      std::cerr << "ERROR: " << prefix << "vflip differs for a pitch of " << len << std::endl;
+      g_errors += 1;
+      break;
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  // the scalar versions against known values
+  const PixelKernels& scalar = PixelKernels::scalar();
+  uint8_t rgba[] = { 10, 20, 30, 40,  200, 100, 50, 0,  255, 255, 255, 255,  100, 200, 50, 128 };
+  uint8_t out[16];
+
+  scalar.premultiply(rgba, out, 4);
+  const uint8_t premultiplied[] = { 2, 3, 5, 40,  0, 0, 0, 0,  255, 255, 255, 255,  50, 100, 25, 128 };
+  if (!std::equal(out, out + 16, premultiplied))
+  {
+    std::cerr << "ERROR: scalar premultiply" << std::endl;
+    g_errors += 1;
+  }
+
+  scalar.unpremultiply(premultiplied, out, 4);
+  const uint8_t unpremultiplied[] = { 12, 19, 31, 40,  0, 0, 0, 0,  255, 255, 255, 255,  99, 199, 49, 128 };
+  if (!std::equal(out, out + 16, unpremultiplied))
+  {
+    std::cerr << "ERROR: scalar unpremultiply" << std::endl;
+    g_errors += 1;
+  }
+
+  const PixelKernels* tables[] = { &scalar, PixelKernels::sse2(), PixelKernels::avx2() };
+  for(const PixelKernels* kernels : tables)
+  {
+    if (kernels)
+    {
+      check_kernels(*kernels);
+    }
+    else
+    {
+      std::cout << "skipping an instruction set not supported here" << std::endl;
+    }
+  }
+  std::cout << "using " << PixelKernels::get().name << std::endl;
+
+  if (g_errors == 0)
+  {
+    std::cout << "all ok" << std::endl;
+    return 0;
+  }
+  else
+  {
+    return 1;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,51 @@
+#include <iostream>
+
+#include "render_queue.hpp"
+
+namespace {
+
+int g_errors = 0;
+
+void expect_less(const char* what, uint64_t lhs, uint64_t rhs)
+{
+  if (!(lhs < rhs))
+  {
+    std::cerr << "ERROR: " << what << ": " << std::hex << lhs << " >= " << rhs << std::dec << std::endl;
+    g_errors += 1;
+  }
+}
+
+} // namespace
+
+int main()
+{
+  typedef RenderQueue Q;
+
+  // the world comes before the view, opaque before blended
+  expect_less("layer", Q::make_key(Q::World, true, 9, 9, 9, 100.0f), Q::make_key(Q::View, false, 1, 1, 1, 1.0f));
+  expect_less("blended", Q::make_key(Q::World, false, 9, 9, 9, 100.0f), Q::make_key(Q::World, true, 1, 1, 1, 1.0f));
+
+  // opaque: program, texture, material, then front to back
+  expect_less("program", Q::make_key(Q::World, false, 1, 9, 9, 100.0f), Q::make_key(Q::World, false, 2, 1, 1, 1.0f));
+  expect_less("texture", Q::make_key(Q::World, false, 1, 1, 9, 100.0f), Q::make_key(Q::World, false, 1, 2, 1, 1.0f));
+  expect_less("material", Q::make_key(Q::World, false, 1, 1, 1, 100.0f), Q::make_key(Q::World, false, 1, 1, 2, 1.0f));
+  expect_less("front to back", Q::make_key(Q::World, false, 1, 1, 1, 1.0f), Q::make_key(Q::World, false, 1, 1, 1, 1.5f));
+  expect_less("behind camera", Q::make_key(Q::World, false, 1, 1, 1, -5.0f), Q::make_key(Q::World, false, 1, 1, 1, 0.01f));
+
+  // blended: back to front before anything else
+  expect_less("back to front", Q::make_key(Q::World, true, 9, 9, 9, 100.0f), Q::make_key(Q::World, true, 1, 1, 1, 10.0f));
+  expect_less("blended program", Q::make_key(Q::World, true, 1, 9, 9, 10.0f), Q::make_key(Q::World, true, 2, 1, 1, 10.0f));
+
+  if (g_errors)
+  {
+    std::cerr << g_errors << " errors" << std::endl;
+    return 1;
+  }
+  else
+  {
+    std::cout << "all ok" << std::endl;
+    return 0;
+  }
+}
+
+/* EOF */
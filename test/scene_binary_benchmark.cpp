@@ -0,0 +1,231 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "scene_binary.hpp"
+#include "scene_parser.hpp"
+
+namespace {
+
+/** Stands in for glBufferData(), every array that would be uploaded
+    is copied into one buffer, so the results of the different loaders
+    can be compared byte by byte */
+class Staging
+{
+public:
+  std::vector<char> data;
+  int objects;
+
+  Staging() : data(), objects() {}
+
+  void clear()
+  {
+    data.clear();
+    objects = 0;
+  }
+
+  template<typename T>
+  void upload(const T* ptr, size_t count)
+  {
+    const char* p = reinterpret_cast<const char*>(ptr);
+    data.insert(data.end(), p, p + sizeof(T) * count);
+  }
+
+  template<typename T>
+  void upload(const std::vector<T>& vec)
+  {
+    upload(vec.data(), vec.size());
+  }
+
+  void upload(const SceneObject& obj)
+  {
+    objects += 1;
+    upload(obj.mesh.position);
+    upload(obj.mesh.texcoord);
+    upload(obj.mesh.normal);
+    upload(obj.mesh.index);
+    if (obj.mesh.has_bones())
+    {
+      upload(obj.mesh.bone_weight);
+      upload(obj.mesh.bone_index);
+    }
+  }
+
+  void upload(const BinaryObject& obj)
+  {
+    objects += 1;
+    upload(obj.position, obj.position_count);
+    upload(obj.texcoord, obj.texcoord_count);
+    upload(obj.normal, obj.normal_count);
+    upload(obj.index, obj.index_count);
+    if (obj.bone_count != 0)
+    {
+      upload(obj.bone_weight, obj.bone_count);
+      upload(obj.bone_index, obj.bone_count);
+    }
+  }
+};
+
+void load_tokenizer(const std::string& filename, Staging& staging)
+{
+  std::ifstream in(filename);
+  if (!in)
+  {
+    throw std::runtime_error(filename + ": File not found");
+  }
+  SceneParser parser(filename, [&staging](SceneObject& obj){ staging.upload(obj); });
+  parser.parse_istream(in);
+}
+
+void load_mapped(const std::string& filename, Staging& staging)
+{
+  MappedFile file(filename);
+  SceneParser parser(filename, [&staging](SceneObject& obj){ staging.upload(obj); });
+  parser.parse(file.begin(), file.end());
+}
+
+void load_binary(const std::string& filename, Staging& staging)
+{
+  MappedFile file(filename);
+  SceneBinaryReader reader(filename, file.begin(), file.end());
+  BinaryObject obj;
+  while(reader.next(obj))
+  {
+    staging.upload(obj);
+  }
+}
+
+void convert(const std::string& input, const std::string& output)
+{
+  std::vector<SceneObject> objects;
+  MappedFile file(input);
+  SceneParser parser(input, [&objects](SceneObject& obj){ objects.push_back(obj); });
+  parser.parse(file.begin(), file.end());
+
+  std::ofstream out(output, std::ios::binary);
+  SceneBinaryWriter::write(out, objects);
+}
+
+/** data/mech.obj comes from an older exporter that starts objects
+    with 'g' instead of 'o', so the parser would see no objects at
+    all, write a copy with the 'o' lines it expects */
+std::string convert_legacy_obj(const std::string& filename, const std::string& output)
+{
+  std::ifstream in(filename);
+  if (!in)
+  {
+    throw std::runtime_error(filename + ": File not found");
+  }
+
+  std::ofstream out(output);
+  std::string line;
+  while(std::getline(in, line))
+  {
+    if (line.compare(0, 2, "g ") == 0)
+    {
+      line[0] = 'o';
+    }
+    out << line << '\n';
+  }
+  return output;
+}
+
+template<typename F>
+double measure(int iterations, F func, Staging& staging)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    staging.clear();
+    func(staging);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  int iterations = 5;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.empty())
+  {
+    files = { "data/textured_cube.mod", "data/wiimote.mod", "data/room/blender.mod", "data/mech.obj" };
+  }
+
+  // keep the per object log_debug() out of the timing
+  std::cout.setstate(std::ios::failbit);
+
+  const std::string legacy_filename = "/tmp/scene_binary_benchmark.mod";
+  for(auto& filename : files)
+  {
+    if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".obj") == 0)
+    {
+      filename = convert_legacy_obj(filename, legacy_filename);
+    }
+  }
+
+  const std::string binary_filename = "/tmp/scene_binary_benchmark.modb";
+
+  int ret = 0;
+  for(const auto& filename : files)
+  {
+    convert(filename, binary_filename);
+
+    Staging tokenizer_staging;
+    Staging mapped_staging;
+    Staging binary_staging;
+
+    double tokenizer_ms = measure(iterations, [&](Staging& s){ load_tokenizer(filename, s); }, tokenizer_staging);
+    double mapped_ms = measure(iterations, [&](Staging& s){ load_mapped(filename, s); }, mapped_staging);
+    double binary_ms = measure(iterations, [&](Staging& s){ load_binary(binary_filename, s); }, binary_staging);
+
+    std::cerr << filename << ": "
+              << binary_staging.objects << " objects, "
+              << binary_staging.data.size() << " bytes\n"
+              << "  tokenizer: " << tokenizer_ms << " ms\n"
+              << "  mmap text: " << mapped_ms << " ms (" << tokenizer_ms / mapped_ms << "x)\n"
+              << "  binary:    " << binary_ms << " ms (" << tokenizer_ms / binary_ms << "x)\n";
+
+    if (binary_staging.objects == 0)
+    {
+      std::cerr << "  ERROR: no objects loaded, nothing was measured" << std::endl;
+      ret = 1;
+    }
+
+    if (tokenizer_staging.data != binary_staging.data ||
+        mapped_staging.data != binary_staging.data ||
+        tokenizer_staging.objects != binary_staging.objects)
+    {
+      std::cerr << "  ERROR: load results differ" << std::endl;
+      ret = 1;
+    }
+  }
+
+  remove(binary_filename.c_str());
+
+  remove(legacy_filename.c_str());
+
+  return ret;
+}
+
+/* EOF */
@@ -0,0 +1,69 @@
+#include <iostream>
+
+#include "scene_node.hpp"
+
+namespace {
+
+int g_errors = 0;
+
+void check(bool cond, const char* what)
+{
+  if (!cond)
+  {
+    std::cerr << "ERROR: " << what << std::endl;
+    g_errors += 1;
+  }
+}
+
+glm::vec3 world_position(const SceneNode* node)
+{
+  return glm::vec3(node->get_transform()[3]);
+}
+
+} // namespace
+
+int main()
+{
+  SceneNode root;
+  SceneNode* a = root.create_child();
+  SceneNode* b = root.create_child();
+  SceneNode* a1 = a->create_child();
+
+  a->set_position(glm::vec3(1.0f, 0.0f, 0.0f));
+  a1->set_position(glm::vec3(0.0f, 2.0f, 0.0f));
+  b->set_position(glm::vec3(0.0f, 0.0f, 3.0f));
+
+  check(root.update_transform(), "first update recomputes");
+  check(!root.update_transform(), "second update is a no-op");
+  check(world_position(a1) == glm::vec3(1.0f, 2.0f, 0.0f), "child follows parent");
+  check(world_position(b) == glm::vec3(0.0f, 0.0f, 3.0f), "sibling position");
+
+  // moving a parent has to move the children along
+  a->set_position(glm::vec3(5.0f, 0.0f, 0.0f));
+  check(root.update_transform(), "parent move recomputes");
+  check(world_position(a1) == glm::vec3(5.0f, 2.0f, 0.0f), "child follows moved parent");
+  check(!root.update_transform(), "nothing left after parent move");
+
+  // deep changes are found from the root
+  a1->set_scale(glm::vec3(2.0f, 2.0f, 2.0f));
+  check(root.update_transform(), "leaf change recomputes");
+  check(a1->get_transform()[0][0] == 2.0f, "leaf scale applied");
+
+  // a new subtree gets computed on attach
+  SceneNode* b1 = b->create_child();
+  b1->set_position(glm::vec3(0.0f, 1.0f, 0.0f));
+  check(root.update_transform(), "attached child recomputes");
+  check(world_position(b1) == glm::vec3(0.0f, 1.0f, 3.0f), "attached child position");
+
+  if (g_errors == 0)
+  {
+    std::cout << "all ok" << std::endl;
+    return 0;
+  }
+  else
+  {
+    return 1;
+  }
+}
+
+/* EOF */
@@ -0,0 +1,157 @@
+#include <chrono>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "scene_parser.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+struct Summary
+{
+  int objects;
+  size_t vertices;
+  uint64_t checksum;
+
+  Summary() : objects(), vertices(), checksum(14695981039346656037ull) {}
+
+  void hash(const void* data, size_t len)
+  {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < len; ++i)
+    {
+      checksum = (checksum ^ p[i]) * 1099511628211ull;
+    }
+  }
+
+  template<typename T>
+  void hash(const std::vector<T>& vec)
+  {
+    hash(vec.data(), vec.size() * sizeof(T));
+  }
+
+  void add(SceneObject& obj)
+  {
+    objects += 1;
+    vertices += obj.mesh.position.size();
+
+    hash(obj.name.data(), obj.name.size());
+    hash(obj.parent.data(), obj.parent.size());
+    hash(obj.material.data(), obj.material.size());
+    hash(&obj.location, sizeof(obj.location));
+    hash(&obj.rotation, sizeof(obj.rotation));
+    hash(&obj.scale, sizeof(obj.scale));
+    hash(obj.mesh.position);
+    hash(obj.mesh.normal);
+    hash(obj.mesh.texcoord);
+    hash(obj.mesh.index);
+    hash(obj.mesh.bone_weight);
+    hash(obj.mesh.bone_index);
+  }
+
+  bool operator==(const Summary& rhs) const
+  {
+    return objects == rhs.objects && vertices == rhs.vertices && checksum == rhs.checksum;
+  }
+};
+
+template<typename F>
+double measure(int iterations, F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  int iterations = 5;
+  unsigned int max_threads = std::max(4u, ThreadPool::hardware_concurrency());
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+    {
+      max_threads = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.empty())
+  {
+    // only files with several objects can be split
+    files = { "data/wiimote.mod", "data/room/blender.mod" };
+  }
+
+  // keep the per object log_debug() out of the timing
+  std::cout.setstate(std::ios::failbit);
+
+  std::cerr << "hardware threads: " << ThreadPool::hardware_concurrency() << "\n";
+
+  int ret = 0;
+  for(const auto& filename : files)
+  {
+    MappedFile file(filename);
+
+    Summary serial_summary;
+    double serial_ms = measure(iterations, [&]{
+        serial_summary = Summary();
+        SceneParser parser(filename, [&](SceneObject& obj){ serial_summary.add(obj); });
+        parser.parse(file.begin(), file.end());
+      });
+
+    std::cerr << filename << ": "
+              << serial_summary.objects << " objects, "
+              << serial_summary.vertices << " vertices\n"
+              << "  serial:     " << serial_ms << " ms\n";
+
+    if (serial_summary.objects < 2)
+    {
+      std::cerr << "  ERROR: less than two objects, nothing to parse in parallel" << std::endl;
+      ret = 1;
+      continue;
+    }
+
+    for(unsigned int threads = 1; threads <= max_threads; threads *= 2)
+    {
+      ThreadPool pool(threads);
+      Summary summary;
+      double ms = measure(iterations, [&]{
+          summary = Summary();
+          SceneParser::parse_parallel(filename, file.begin(), file.end(), pool,
+                                      [&](SceneObject& obj){ summary.add(obj); });
+        });
+
+      std::cerr << "  " << threads << " threads: " << ms << " ms (" << serial_ms / ms << "x, "
+                << SceneParser::split(file.begin(), file.end(), pool.size() * 4).size() << " chunks)\n";
+
+      if (!(summary == serial_summary))
+      {
+        std::cerr << "  ERROR: parse results differ" << std::endl;
+        ret = 1;
+      }
+    }
+  }
+
+  return ret;
+}
+
+/* EOF */
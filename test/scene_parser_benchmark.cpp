@@ -0,0 +1,198 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "scene_parser.hpp"
+
+namespace {
+
+struct Summary
+{
+  int objects;
+  size_t vertices;
+  size_t indices;
+  uint64_t checksum;
+
+  Summary() : objects(), vertices(), indices(), checksum(14695981039346656037ull) {}
+
+  void hash(const void* data, size_t len)
+  {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < len; ++i)
+    {
+      checksum = (checksum ^ p[i]) * 1099511628211ull;
+    }
+  }
+
+  template<typename T>
+  void hash(const std::vector<T>& vec)
+  {
+    hash(vec.data(), vec.size() * sizeof(T));
+  }
+
+  void add(SceneObject& obj)
+  {
+    objects += 1;
+    vertices += obj.mesh.position.size();
+    indices += obj.mesh.index.size();
+
+    // everything Scene builds the SceneNode tree from
+    hash(obj.name.data(), obj.name.size());
+    hash(obj.parent.data(), obj.parent.size());
+    hash(obj.material.data(), obj.material.size());
+    hash(&obj.location, sizeof(obj.location));
+    hash(&obj.rotation, sizeof(obj.rotation));
+    hash(&obj.scale, sizeof(obj.scale));
+    hash(obj.mesh.position);
+    hash(obj.mesh.normal);
+    hash(obj.mesh.texcoord);
+    hash(obj.mesh.index);
+    hash(obj.mesh.bone_weight);
+    hash(obj.mesh.bone_index);
+  }
+
+  bool operator==(const Summary& rhs) const
+  {
+    return
+      objects == rhs.objects &&
+      vertices == rhs.vertices &&
+      indices == rhs.indices &&
+      checksum == rhs.checksum;
+  }
+};
+
+Summary parse_tokenizer(const std::string& filename)
+{
+  Summary summary;
+  std::ifstream in(filename);
+  if (!in)
+  {
+    throw std::runtime_error(filename + ": File not found");
+  }
+  SceneParser parser(filename, [&summary](SceneObject& obj){ summary.add(obj); });
+  parser.parse_istream(in);
+  return summary;
+}
+
+Summary parse_mapped(const std::string& filename)
+{
+  Summary summary;
+  MappedFile file(filename);
+  SceneParser parser(filename, [&summary](SceneObject& obj){ summary.add(obj); });
+  parser.parse(file.begin(), file.end());
+  return summary;
+}
+
+/** data/mech.obj comes from an older exporter that starts objects
+    with 'g' instead of 'o', so the parser would see no objects at
+    all, write a copy with the 'o' lines it expects */
+std::string convert_legacy_obj(const std::string& filename, const std::string& output)
+{
+  std::ifstream in(filename);
+  if (!in)
+  {
+    throw std::runtime_error(filename + ": File not found");
+  }
+
+  std::ofstream out(output);
+  std::string line;
+  while(std::getline(in, line))
+  {
+    if (line.compare(0, 2, "g ") == 0)
+    {
+      line[0] = 'o';
+    }
+    out << line << '\n';
+  }
+  return output;
+}
+
+template<typename F>
+double measure(int iterations, F func, Summary& summary)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    summary = func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  int iterations = 5;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.empty())
+  {
+    files = { "data/textured_cube.mod", "data/wiimote.mod", "data/room/blender.mod", "data/mech.obj" };
+  }
+
+  // keep the per object log_debug() out of the timing
+  std::cout.setstate(std::ios::failbit);
+
+  const std::string legacy_filename = "/tmp/scene_parser_benchmark.mod";
+  for(auto& filename : files)
+  {
+    if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".obj") == 0)
+    {
+      filename = convert_legacy_obj(filename, legacy_filename);
+    }
+  }
+
+  int ret = 0;
+  for(const auto& filename : files)
+  {
+    Summary tokenizer_summary;
+    Summary mapped_summary;
+
+    double tokenizer_ms = measure(iterations, [&]{ return parse_tokenizer(filename); }, tokenizer_summary);
+    double mapped_ms = measure(iterations, [&]{ return parse_mapped(filename); }, mapped_summary);
+
+    std::cerr << filename << ": "
+              << mapped_summary.objects << " objects, "
+              << mapped_summary.vertices << " vertices, "
+              << mapped_summary.indices << " indices\n"
+              << "  tokenizer: " << tokenizer_ms << " ms\n"
+              << "  mmap:      " << mapped_ms << " ms\n"
+              << "  speedup:   " << tokenizer_ms / mapped_ms << "x\n";
+
+    if (mapped_summary.objects == 0)
+    {
+      std::cerr << "  ERROR: no objects parsed, nothing was compared" << std::endl;
+      ret = 1;
+    }
+
+    if (!(tokenizer_summary == mapped_summary))
+    {
+      std::cerr << "  ERROR: parse results differ" << std::endl;
+      ret = 1;
+    }
+  }
+
+  remove(legacy_filename.c_str());
+
+  return ret;
+}
+
+/* EOF */
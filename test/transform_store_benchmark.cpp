@@ -0,0 +1,156 @@
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scene_node.hpp"
+#include "thread_pool.hpp"
+#include "transform_store.hpp"
+
+namespace {
+
+/** Three levels of groups below the root with \a count leafs */
+std::unique_ptr<SceneNode> create_scene(int count)
+{
+  srand(0);
+
+  std::unique_ptr<SceneNode> root(new SceneNode);
+  ModelPtr model = std::make_shared<Model>();
+  model->set_lod(0.5f, [](int){ return MeshPtr(); });
+
+  auto random_vec3 = []{ return glm::vec3(rand() % 100 - 50, rand() % 100 - 50, rand() % 100 - 50); };
+
+  SceneNode* group = nullptr;
+  SceneNode* subgroup = nullptr;
+  for(int i = 0; i < count; ++i)
+  {
+    if (i % 10000 == 0)
+    {
+      group = root->create_child();
+      group->set_position(random_vec3());
+    }
+    if (i % 100 == 0)
+    {
+      subgroup = group->create_child();
+      subgroup->set_position(random_vec3());
+      subgroup->set_orientation(glm::angleAxis(static_cast<float>(i), glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    SceneNode* node = subgroup->create_child();
+    node->set_position(random_vec3());
+    node->set_scale(glm::vec3(0.5f, 0.5f, 0.5f));
+    node->attach_model(model);
+  }
+
+  return root;
+}
+
+template<typename F>
+double measure(int iterations, F func)
+{
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < iterations; ++i)
+  {
+    func(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+bool compare(const SceneNode* lhs, const SceneNode* rhs)
+{
+  glm::mat4 a = lhs->get_transform();
+  glm::mat4 b = rhs->get_transform();
+  for(int i = 0; i < 4; ++i)
+  {
+    if (glm::length(a[i] - b[i]) > 1.0e-3f)
+    {
+      return false;
+    }
+  }
+
+  if (lhs->get_children().size() != rhs->get_children().size())
+  {
+    return false;
+  }
+
+  for(size_t i = 0; i < lhs->get_children().size(); ++i)
+  {
+    if (!compare(lhs->get_children()[i].get(), rhs->get_children()[i].get()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int count = 100000;
+  int iterations = 50;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      iterations = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+    {
+      count = atoi(argv[++i]);
+    }
+  }
+
+  std::unique_ptr<SceneNode> tree = create_scene(count);
+  std::unique_ptr<SceneNode> flat = create_scene(count);
+
+  TransformStore store;
+  store.build(*flat);
+
+  ThreadPool pool;
+
+  // moving the root makes every node dirty, the worst case
+  auto move_root = [](SceneNode* root, int i){
+    root->set_position(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+  };
+
+  double tree_ms = measure(iterations, [&](int i){ move_root(tree.get(), i); tree->update_transform(); });
+  double flat_ms = measure(iterations, [&](int i){ move_root(flat.get(), i); store.update(); });
+  double pool_ms = measure(iterations, [&](int i){ move_root(flat.get(), i); store.update(pool); });
+
+  std::cerr << store.size() << " nodes, " << store.get_depth() << " levels, "
+            << pool.size() << " threads\n"
+            << "  recursive:      " << tree_ms << " ms\n"
+            << "  flat:           " << flat_ms << " ms (" << tree_ms / flat_ms << "x)\n"
+            << "  flat, threaded: " << pool_ms << " ms (" << tree_ms / pool_ms << "x)\n";
+
+  int ret = 0;
+
+  move_root(tree.get(), 1234);
+  move_root(flat.get(), 1234);
+  tree->update_transform();
+  store.update(pool);
+  if (!compare(tree.get(), flat.get()))
+  {
+    std::cerr << "  ERROR: transforms differ" << std::endl;
+    ret = 1;
+  }
+
+  // a single leaf moving
+  SceneNode* tree_leaf = tree->get_children()[0]->get_children()[0]->get_children()[0].get();
+  SceneNode* flat_leaf = flat->get_children()[0]->get_children()[0]->get_children()[0].get();
+  tree_leaf->set_position(glm::vec3(1.0f, 2.0f, 3.0f));
+  flat_leaf->set_position(glm::vec3(1.0f, 2.0f, 3.0f));
+  tree->update_transform();
+  if (!store.update() || store.update() || !compare(tree.get(), flat.get()))
+  {
+    std::cerr << "  ERROR: leaf update differs" << std::endl;
+    ret = 1;
+  }
+
+  return ret;
+}
+
+/* EOF */
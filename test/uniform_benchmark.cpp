@@ -0,0 +1,208 @@
+#include <GL/glew.h>
+#include <SDL.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "program.hpp"
+#include "render_context.hpp"
+#include "scene_node.hpp"
+#include "shader.hpp"
+#include "uniform_group.hpp"
+
+namespace {
+
+// about what phong.vert/phong.frag use
+const char* g_vertex_shader =
+  "#version 330 core\n"
+  "in vec3 position;\n"
+  "in vec3 normal;\n"
+  "uniform mat4 ModelViewMatrix;\n"
+  "uniform mat3 NormalMatrix;\n"
+  "uniform mat4 MVP;\n"
+  "out vec3 frag_normal;\n"
+  "out vec3 frag_position;\n"
+  "void main() {\n"
+  "  frag_normal = NormalMatrix * normal;\n"
+  "  frag_position = vec3(ModelViewMatrix * vec4(position, 1.0));\n"
+  "  gl_Position = MVP * vec4(position, 1.0);\n"
+  "}\n";
+
+const char* g_fragment_shader =
+  "#version 330 core\n"
+  "struct LightInfo { vec3 position; vec3 diffuse; vec3 ambient; vec3 specular; };\n"
+  "struct MaterialInfo { vec3 diffuse; vec3 ambient; vec3 specular; float shininess; };\n"
+  "uniform LightInfo light;\n"
+  "uniform MaterialInfo material;\n"
+  "uniform sampler2D diffuse_texture;\n"
+  "in vec3 frag_normal;\n"
+  "in vec3 frag_position;\n"
+  "out vec4 frag_color;\n"
+  "void main() {\n"
+  "  vec3 n = normalize(frag_normal);\n"
+  "  vec3 l = normalize(light.position - frag_position);\n"
+  "  float d = max(dot(n, l), 0.0);\n"
+  "  float s = pow(max(dot(reflect(-l, n), normalize(-frag_position)), 0.0), material.shininess);\n"
+  "  vec3 c = light.ambient * material.ambient + light.diffuse * material.diffuse * d + light.specular * material.specular * s;\n"
+  "  frag_color = vec4(c, 1.0) * texture(diffuse_texture, n.xy);\n"
+  "}\n";
+
+ShaderPtr create_shader(GLenum type, const char* source)
+{
+  ShaderPtr shader = std::make_shared<Shader>(type);
+  shader->source(source);
+  shader->compile();
+  if (!shader->get_compile_status())
+  {
+    throw std::runtime_error("shader compile failed: " + shader->get_info_log());
+  }
+  return shader;
+}
+
+/** What a value uniform was before: one glGetUniformLocation() per set */
+class UncachedUniforms
+{
+private:
+  std::vector<std::pair<std::string, glm::vec3> > m_vec3s;
+  std::vector<std::pair<std::string, glm::mat4> > m_mat4s;
+  float m_shininess;
+
+public:
+  UncachedUniforms(float f) :
+    m_vec3s(),
+    m_mat4s(),
+    m_shininess(f)
+  {
+    for(const char* name : { "light.position", "light.diffuse", "light.ambient", "light.specular",
+          "material.diffuse", "material.ambient", "material.specular" })
+    {
+      m_vec3s.emplace_back(name, glm::vec3(f));
+    }
+    m_mat4s.emplace_back("ModelViewMatrix", glm::mat4(f));
+    m_mat4s.emplace_back("MVP", glm::mat4(f));
+  }
+
+  void apply(GLuint program)
+  {
+    for(const auto& it : m_vec3s)
+    {
+      GLint loc = glGetUniformLocation(program, it.first.c_str());
+      glProgramUniform3fv(program, loc, 1, glm::value_ptr(it.second));
+    }
+    for(const auto& it : m_mat4s)
+    {
+      GLint loc = glGetUniformLocation(program, it.first.c_str());
+      glProgramUniformMatrix4fv(program, loc, 1, GL_FALSE, glm::value_ptr(it.second));
+    }
+    glProgramUniformMatrix3fv(program, glGetUniformLocation(program, "NormalMatrix"), 1, GL_FALSE,
+                              glm::value_ptr(glm::mat3(m_shininess)));
+    glProgramUniform1f(program, glGetUniformLocation(program, "material.shininess"), m_shininess);
+    glProgramUniform1i(program, glGetUniformLocation(program, "diffuse_texture"), 0);
+  }
+};
+
+void fill(UniformGroup& group, float f)
+{
+  for(const char* name : { "light.position", "light.diffuse", "light.ambient", "light.specular",
+        "material.diffuse", "material.ambient", "material.specular" })
+  {
+    group.set_uniform(name, glm::vec3(f));
+  }
+  group.set_uniform("ModelViewMatrix", glm::mat4(f));
+  group.set_uniform("MVP", glm::mat4(f));
+  group.set_uniform("NormalMatrix", glm::mat3(f));
+  group.set_uniform("material.shininess", f);
+  group.set_uniform("diffuse_texture", 0);
+}
+
+template<typename F>
+double measure(int draws, F apply)
+{
+  // warm up, so the location caches get filled outside the timing
+  apply(0);
+  glFinish();
+
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < draws; ++i)
+  {
+    apply(i);
+  }
+  glFinish();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() / draws;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  int draws = 100000;
+  int materials = 200;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+    {
+      draws = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+    {
+      materials = atoi(argv[++i]);
+    }
+  }
+
+  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+  {
+    std::cerr << "Couldn't initialize SDL: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  atexit(SDL_Quit);
+
+  SDL_Window* window = SDL_CreateWindow("uniform_benchmark",
+                                        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                        256, 256, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!window || !SDL_GL_CreateContext(window))
+  {
+    std::cerr << "Couldn't create GL context: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+  glewInit();
+
+  // keep the attribute dump of Program::inspect() out of the output
+  std::cout.setstate(std::ios::failbit);
+
+  ProgramPtr program = Program::create(create_shader(GL_VERTEX_SHADER, g_vertex_shader),
+                                       create_shader(GL_FRAGMENT_SHADER, g_fragment_shader));
+  glUseProgram(program->get_id());
+
+  std::vector<std::unique_ptr<UncachedUniforms> > uncached;
+  std::vector<std::unique_ptr<UniformGroup> > cached;
+  for(int i = 0; i < materials; ++i)
+  {
+    float f = static_cast<float>(i) / materials;
+    uncached.emplace_back(new UncachedUniforms(f));
+    cached.emplace_back(new UniformGroup);
+    fill(*cached.back(), f);
+  }
+
+  SceneNode node;
+  RenderContext context(Camera(), &node);
+
+  double uncached_us = measure(draws, [&](int i){ uncached[i % materials]->apply(program->get_id()); });
+  double cached_us = measure(draws, [&](int i){ cached[i % materials]->apply(program, context); });
+
+  glUseProgram(0);
+
+  std::cerr << draws << " draws, " << materials << " materials, 12 uniforms each\n"
+            << "  glGetUniformLocation per set: " << uncached_us << " us/draw\n"
+            << "  cached locations:             " << cached_us << " us/draw ("
+            << uncached_us / cached_us << "x)" << std::endl;
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,106 @@
+//  Simple 3D Model Viewer
+//  Copyright (C) 2012-2013 Ingo Ruhnke <grumbel@gmail.com>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "mesh_optimizer.hpp"
+#include "scene_binary.hpp"
+#include "scene_parser.hpp"
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> files;
+  bool weld = false;
+  bool optimize = false;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--weld") == 0)
+    {
+      weld = true;
+    }
+    else if (strcmp(argv[i], "--optimize") == 0)
+    {
+      optimize = true;
+    }
+    else
+    {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.size() != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--weld] [--optimize] INPUT.mod OUTPUT.modb" << std::endl;
+    return 1;
+  }
+
+  const std::string& input = files[0];
+  const std::string& output = files[1];
+
+  try
+  {
+    std::vector<SceneObject> objects;
+
+    MappedFile file(input);
+    SceneParser parser(input, [&](SceneObject& obj){
+        if (weld)
+        {
+          weld_vertices(obj.mesh);
+        }
+        if (optimize)
+        {
+          optimize_vertex_cache(obj.mesh);
+          optimize_vertex_fetch(obj.mesh);
+        }
+        objects.push_back(std::move(obj));
+      });
+    parser.parse(file.begin(), file.end());
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out)
+    {
+      throw std::runtime_error(output + ": couldn't open file for writing");
+    }
+    SceneBinaryWriter::write(out, objects);
+    out.close();
+    if (!out)
+    {
+      throw std::runtime_error(output + ": write error");
+    }
+
+    size_t vertices = 0;
+    for(const auto& obj : objects)
+    {
+      vertices += obj.mesh.position.size();
+    }
+    std::cout << output << ": " << objects.size() << " objects, " << vertices << " vertices" << std::endl;
+
+    return 0;
+  }
+  catch(const std::exception& err)
+  {
+    std::cerr << "error: " << err.what() << std::endl;
+    return 1;
+  }
+}
+
+/* EOF */